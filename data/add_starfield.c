@@ -1,14 +1,24 @@
 /* Add random starfield to a PNG.
 
-   ./add_starfield {input.png} {seed} > {output.png}
+   ./add_starfield {input.png} {frame} > {output.png}
+   ./add_starfield {input.png} --frames {list} --out-pattern {output.png}
 
-   Expect input image with transparencies for where stars will be added.
-   Stars will be added as solid black pixels.
+   Expect black and white input image with transparencies for where stars
+   will be added.  Stars will be added as solid black pixels.
+
+   The second form writes multiple frames with a single run, where {list}
+   is a comma-separated list of frame numbers or ranges (e.g. "0-30,32,34")
+   and {output.png} is a printf pattern that takes the frame number (e.g.
+   "t_card_frame%02d.png").  Star placement only depends on the input
+   image, so it's computed once and shared by all frames.
+
+   Both forms also accept "--preset={preset}" to select PNG encoder
+   settings, see png_encode.h.
 */
 
+#include"star_placement.h"
 #include<assert.h>
 #include<inttypes.h>
-#include<png.h>
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
@@ -24,260 +34,230 @@
    #define RADIUS  12
 #endif
 
-typedef struct { int x, y; } XY;
-
-/* Syntactic sugar.  These may or may not be defined in standard library,
-   so we just define our own functions for it.                            */
-static int Max(int a, int b) { return a > b ? a : b; }
-static int Min(int a, int b) { return a < b ? a : b; }
-
-/* Return a random integer between [a,b]. */
-static int RandomInt(int a, int b)
+/* Draw a single opaque black pixel. */
+static void DrawPixel(Bitplane *image, int x, int y)
 {
-   return (int)(((double)rand() / (double)RAND_MAX) * (b - a) + a);
+   if( x >= 0 && x < image->width && y >= 0 && y < image->height )
+      SetBitplanePixel(image, x, y, 0, 1);
 }
 
-/* Jenkin's one-at-a-time hash.
-   https://en.wikipedia.org/wiki/Jenkins_hash_function
-*/
-static uint32_t Hash(uint8_t *bytes, size_t size)
+/* Load input image.  Returns 0 on success. */
+static int LoadImage(const char *filename, Bitplane *image)
 {
-   uint32_t hash = 0;
-   size_t i;
-
-   for(i = 0; i < size; i++)
+   if( LoadBitplane(filename, 0, image) != 0 )
+      return 1;
+   if( image->width < 10 || image->height < 10 )
    {
-      hash += bytes[i];
-      hash += hash << 10;
-      hash ^= hash >> 6;
+      fprintf(stderr, "Input too small (%d,%d)\n",
+              image->width, image->height);
+      FreeBitplane(image);
+      return 1;
    }
-   hash += hash << 3;
-   hash ^= hash >> 11;
-   hash += hash << 15;
-   return hash;
+   return 0;
 }
 
-/* Hash two numbers. */
-static uint32_t HashPair(int x, int y)
+/* Draw stars with varying glitter status. */
+static void DrawGlitter(Bitplane *image, const XY *stars, int star_count,
+                        int frame)
 {
-   uint8_t buffer[sizeof(int) * 2];
+   int i, j;
 
-   memcpy(buffer, &x, sizeof(int));
-   memcpy(buffer + sizeof(int), &y, sizeof(int));
-   return Hash(buffer, sizeof(buffer));
-}
+   for(i = 0; i < star_count; i++)
+   {
+      /* Glitter status is generated from user supplied frame number,
+         with a divisor to extend the period so that the individual
+         stars don't flicker too fast.
 
-/* Check if a coordinate is eligible for stars, returns 1 if so.  This is
-   done by hashing only the coordinate value, so the stars always appear
-   in the same positions regardless of input pixels.                      */
-static int IsStarLocation(int x, int y)
-{
-   return (HashPair(x, y) & 0x11111) == 0;
+         To maximize variety, each star gets assigned a random phase
+         based on a hash of its coordinates.  Alternatively, we could
+         just use its index as the phase (since the stars are already
+         shuffled), but because the visibility of each star could vary
+         from frame to frame, there is no guarantee that the frame
+         indices would be sufficiently stable for this purpose.        */
+      j = (((HashPair(stars[i].x, stars[i].y) >> 4) + frame) / 5) % 4;
+      if( j == 0 )
+      {
+         /* Remove black pixel. */
+         SetBitplanePixel(image, stars[i].x, stars[i].y, 0, 0);
+         continue;
+      }
+
+      if( j == 1 || j == 3 )
+         continue;
+      DrawPixel(image, stars[i].x - 1, stars[i].y);
+      DrawPixel(image, stars[i].x + 1, stars[i].y);
+      DrawPixel(image, stars[i].x, stars[i].y - 1);
+      DrawPixel(image, stars[i].x, stars[i].y + 1);
+   }
 }
 
-/* Check if a region centered around some point is completely transparent,
-   returns 1 if so.                                                        */
-static int IsEmptyRegion(png_image *image, png_bytep pixels, int x, int y)
+/* Parse frame list into an array of frame numbers.  Returns number of
+   frames, or -1 on error.                                                */
+static int ParseFrameList(const char *text, int **output)
 {
-   int ix, iy, dx2, dy2;
+   int frame_count = 0, capacity = 0, first, last, *frames = NULL, *resized;
+   const char *r = text;
+   char *end;
 
-   for(iy = Max(y - RADIUS, 0); iy <= Min(y + RADIUS, image->height); iy++)
+   for(;;)
    {
-      dy2 = (y - iy) * (y - iy);
-      for(ix = Max(x - RADIUS, 0); ix <= Min(x + RADIUS, image->width); ix++)
+      first = (int)strtol(r, &end, 10);
+      if( end == r || first < 0 )
+         break;
+      last = first;
+      r = end;
+      if( *r == '-' )
+      {
+         r++;
+         last = (int)strtol(r, &end, 10);
+         if( end == r || last < first )
+            break;
+         r = end;
+      }
+
+      for(; first <= last; first++)
       {
-         dx2 = (x - ix) * (x - ix);
-         if( dx2 + dy2 > RADIUS * RADIUS )
-            continue;
+         if( frame_count == capacity )
+         {
+            capacity = capacity * 2 + 16;
+            resized = (int*)realloc(frames, capacity * sizeof(int));
+            if( resized == NULL )
+            {
+               fputs("Out of memory\n", stderr);
+               free(frames);
+               return -1;
+            }
+            frames = resized;
+         }
+         frames[frame_count++] = first;
+      }
 
-         /* Check for alpha component not equal to zero. */
-         if( pixels[(iy * image->width + ix) * 2 + 1] != 0 )
-            return 0;
+      if( *r == '\0' )
+      {
+         *output = frames;
+         return frame_count;
       }
+      if( *r != ',' )
+         break;
+      r++;
    }
-   return 1;
+
+   fprintf(stderr, "Invalid frame list: %s\n", text);
+   free(frames);
+   return -1;
 }
 
-/* Draw a single opaque black pixel. */
-static void DrawPixel(png_image *image, png_bytep pixels, int x, int y)
+/* Write a single frame for each entry in frame list.  Returns 0 on
+   success.                                                               */
+static int WriteFrames(const Bitplane *image, const XY *stars, int star_count,
+                       const char *frame_list, const char *pattern,
+                       PngPreset preset)
 {
-   png_bytep p;
+   char filename[2][FILENAME_MAX];
+   int *frames, frame_count, i;
+   Bitplane frame_image;
+
+   frame_count = ParseFrameList(frame_list, &frames);
+   if( frame_count < 0 )
+      return 1;
 
-   if( x >= 0 && x < (int)(image->width) && y >= 0 && y < (int)(image->height) )
+   /* Make sure that the output pattern names each frame differently,
+      otherwise all frames would just overwrite each other.              */
+   if( snprintf(filename[0], FILENAME_MAX, pattern, 0) >= FILENAME_MAX ||
+       snprintf(filename[1], FILENAME_MAX, pattern, 1) >= FILENAME_MAX ||
+       strcmp(filename[0], filename[1]) == 0 )
    {
-      p = pixels + (y * image->width + x) * 2;
-      *p++ = 0;
-      *p = 0xff;
+      fprintf(stderr, "Invalid output pattern: %s\n", pattern);
+      free(frames);
+      return 1;
    }
-}
 
-int main(int argc, char **argv)
-{
-   png_image image;
-   png_bytep pixels;
-   int star_count, max_star_count, x, y, i, j, frame;
-   XY *stars;
-
-   if( argc != 3 )
-      return printf("%s {input.png} {frame} > {output.png}\n", *argv);
-   if( isatty(STDOUT_FILENO) )
+   if( AllocBitplane(&frame_image, image->width, image->height) != 0 )
    {
-      fputs("Not writing output to stdout because it's a tty\n", stderr);
+      fputs("Out of memory\n", stderr);
+      free(frames);
       return 1;
    }
-   #ifdef _WIN32
-      setmode(STDIN_FILENO, O_BINARY);
-      setmode(STDOUT_FILENO, O_BINARY);
-   #endif
 
-   /* Load input. */
-   memset(&image, 0, sizeof(image));
-   image.version = PNG_IMAGE_VERSION;
-   if( strcmp(argv[1], "-") == 0 )
+   for(i = 0; i < frame_count; i++)
    {
-      if( !png_image_begin_read_from_stdio(&image, stdin) )
+      CopyBitplane(image, &frame_image);
+      DrawGlitter(&frame_image, stars, star_count, frames[i]);
+
+      snprintf(filename[0], FILENAME_MAX, pattern, frames[i]);
+      if( SaveBitplane(filename[0], &frame_image, preset) != 0 )
       {
-         fputs("Error reading from stdin", stderr);
+         FreeBitplane(&frame_image);
+         free(frames);
          return 1;
       }
    }
-   else
-   {
-      if( !png_image_begin_read_from_file(&image, argv[1]) )
-         return printf("Error reading %s\n", argv[1]);
-   }
-   if( image.width < 10 || image.height < 10 )
-   {
-      return fprintf(stderr, "Input too small (%d,%d)\n",
-                     (int)(image.width), (int)(image.height));
-   }
 
-   image.format = PNG_FORMAT_GA;
-   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   if( pixels == NULL )
-   {
-      fputs("Out of memory\n", stderr);
-      return 1;
-   }
-   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
-   {
-      free(pixels);
-      fputs("Error loading input\n", stderr);
-      return 1;
-   }
+   FreeBitplane(&frame_image);
+   free(frames);
+   return 0;
+}
 
-   /* Initialize star positions.  This is done by visiting all eligible
-      coordinates in random order, and then drop the ones that failed
-      proximity check.
+int main(int argc, char **argv)
+{
+   Bitplane image;
+   PngPreset preset;
+   int star_count, status;
+   XY *stars;
 
-      We used to do a simpler check where we visit each coordinate in
-      YX order, but hash the coordinates to determine if a coordinate is
-      eligible.  But due to the proximity check being more strict than the
-      hash function, the end result tend to exhibit a rectangular grid-like
-      pattern.  That pattern doesn't happen when we visit in random order.  */
-   max_star_count = image.width * image.height;
-   stars = (XY*)malloc(max_star_count * sizeof(XY));
-   if( stars == NULL )
-   {
-      fputs("Out of memory\n", stderr);
-      free(pixels);
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
       return 1;
+   if( argc == 6 )
+   {
+      if( strcmp(argv[2], "--frames") != 0 ||
+          strcmp(argv[4], "--out-pattern") != 0 )
+      {
+         return printf("%s {input.png} --frames {list} --out-pattern "
+                       "{output.png}\n", *argv);
+      }
    }
-   for(i = y = 0; y < (int)(image.height); y++)
+   else if( argc == 3 )
    {
-      for(x = 0; x < (int)(image.width); x++, i++)
+      if( isatty(STDOUT_FILENO) )
       {
-         stars[i].x = x;
-         stars[i].y = y;
+         fputs("Not writing output to stdout because it's a tty\n", stderr);
+         return 1;
       }
    }
-
-   /* Fisher-Yates shuffle, with deterministic seed. */
-   srand(1);
-   for(i = max_star_count - 1; i > 0; i--)
+   else
    {
-      j = RandomInt(0, i);
-      x = stars[i].x;
-      y = stars[i].y;
-      stars[i].x = stars[j].x;
-      stars[i].y = stars[j].y;
-      stars[j].x = x;
-      stars[j].y = y;
+      return printf("%s {input.png} {frame} > {output.png}\n"
+                    "%s {input.png} --frames {list} --out-pattern "
+                    "{output.png}\n", *argv, *argv);
    }
+   #ifdef _WIN32
+      setmode(STDIN_FILENO, O_BINARY);
+      setmode(STDOUT_FILENO, O_BINARY);
+   #endif
 
-   /* Visit each coordinate. */
-   for(i = star_count = 0; i < max_star_count; i++)
+   if( LoadImage(argv[1], &image) != 0 )
+      return 1;
+   star_count = PlaceStars(&image, RADIUS, &stars);
+   if( star_count < 0 )
    {
-      x = stars[i].x;
-      y = stars[i].y;
-
-      /* Apply a hash check to see if a location is eligible, followed
-         by a proximity check.
-
-         Even though we have eliminated the grid-like pattern due to
-         randomized visit order, we would still get a ring-like pattern
-         around opaque pixels that were present in the original image.
-         This is because proximity check alone would cause the pixels
-         to be placed at the nearest available spot near the previously
-         placed pixels.
-
-         By combining both random visit order and hash eligibility check,
-         we would eliminate the ring-like patterns as well.               */
-      if( IsStarLocation(x, y) && IsEmptyRegion(&image, pixels, x, y) )
-      {
-         /* Star location is accepted.  We will write it back to the
-            array in-place.
-
-            If location is rejected, star_count will not be incremented
-            while we read ahead in "i", so stars array will end up with
-            those rejected entries skipped.                             */
-         stars[star_count].x = x;
-         stars[star_count].y = y;
-         star_count++;
-
-         /* Draw a black pixel to mark the selected star location, so
-            that we don't draw another star near it.                  */
-         DrawPixel(&image, pixels, x, y);
-      }
+      FreeBitplane(&image);
+      return 1;
    }
 
-   /* Draw stars with varying glitter status. */
-   frame = atoi(argv[2]);
-   for(i = 0; i < star_count; i++)
+   status = 0;
+   if( argc == 6 )
    {
-      /* Glitter status is generated from user supplied frame number,
-         with a divisor to extend the period so that the individual
-         stars don't flicker too fast.
-
-         To maximize variety, each star gets assigned a random phase
-         based on a hash of its coordinates.  Alternatively, we could
-         just use its index as the phase (since the stars are already
-         shuffled), but because the visibility of each star could vary
-         from frame to frame, there is no guarantee that the frame
-         indices would be sufficiently stable for this purpose.        */
-      j = (((HashPair(stars[i].x, stars[i].y) >> 4) + frame) / 5) % 4;
-      if( j == 0 )
-      {
-         /* Remove black pixel. */
-         memset(pixels + (stars[i].y * image.width + stars[i].x) * 2, 0, 2);
-         continue;
-      }
-
-      if( j == 1 || j == 3 )
-         continue;
-      DrawPixel(&image, pixels, stars[i].x - 1, stars[i].y);
-      DrawPixel(&image, pixels, stars[i].x + 1, stars[i].y);
-      DrawPixel(&image, pixels, stars[i].x, stars[i].y - 1);
-      DrawPixel(&image, pixels, stars[i].x, stars[i].y + 1);
+      status = WriteFrames(&image, stars, star_count, argv[3], argv[5],
+                           preset);
    }
-
-   /* Write output. */
-   if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
+   else
    {
-      fputs("Error writing output\n", stderr);
-      free(pixels);
-      return 1;
+      DrawGlitter(&image, stars, star_count, atoi(argv[2]));
+
+      /* Write output. */
+      status = SaveBitplane("-", &image, preset);
    }
-   free(pixels);
-   return 0;
+   free(stars);
+   FreeBitplane(&image);
+   return status;
 }
@@ -1,6 +1,6 @@
 /* Take rasterized output from world.svg and generate a tileset.
 
-   ./assemble_tiles {input.png} {output.png}
+   ./assemble_tiles [--preset={preset}] {input.png} {output.png}
 
    This tool generates an image with 96x32 tiles by copying&pasting 32x32
    cells from the input image.  The original 32x32 set of images would
@@ -12,8 +12,15 @@
    would only be able to see one step ahead if we aggressively scroll.
    Instead, we have gone with a more abstract set of targets that allows
    us to pack the targets at higher density.
+
+   Copies are collected into a list first, and then applied to horizontal
+   bands of the output in parallel.  Each band applies the copies in the
+   same order, so later copies still overwrite earlier ones, and output
+   is the same as applying the copies one at a time.
 */
 
+#include"image_ops.h"
+#include"png_encode.h"
 #include<png.h>
 #include<stdio.h>
 #include<stdlib.h>
@@ -28,29 +35,74 @@
 #define OUTPUT_WIDTH    1536
 #define OUTPUT_HEIGHT   1216
 
-/* Copy rectangular region from input to output. */
-static void CopyRegion(png_image *input_image, png_bytep input_pixels,
-                       png_image *output_image, png_bytep output_pixels,
-                       int sx, int sy, int tx, int ty, int w, int h)
+/* Upper bound on number of copies made by AssembleTiles. */
+#define MAX_REGIONS     2048
+
+/* Single rectangular copy from input to output. */
+typedef struct
+{
+   int sx, sy, tx, ty, w, h;
+} Region;
+
+/* List of copies, plus the images they apply to. */
+typedef struct
 {
-   int i;
+   const png_image *input_image;
+   png_const_bytep input_pixels;
+   const png_image *output_image;
+   png_bytep output_pixels;
+   Region regions[MAX_REGIONS];
+   int region_count;
+} RegionList;
+
+/* Append rectangular region to list of copies. */
+static void AddRegion(RegionList *list,
+                      int sx, int sy, int tx, int ty, int w, int h)
+{
+   Region *r;
 
    if( sx < 0 || sy < 0 || tx < 0 || ty < 0 ||
-       sx + w > (int)(input_image->width) ||
-       sy + h > (int)(input_image->height) ||
-       tx + w > (int)(output_image->width) ||
-       ty + h > (int)(output_image->height) )
+       sx + w > (int)(list->input_image->width) ||
+       sy + h > (int)(list->input_image->height) ||
+       tx + w > (int)(list->output_image->width) ||
+       ty + h > (int)(list->output_image->height) ||
+       list->region_count >= MAX_REGIONS )
    {
       fprintf(stderr, "Bad region (%d,%d) -> (%d,%d), width=%d, height=%d\n",
               sx, sy, tx, ty, w, h);
       exit(EXIT_FAILURE);
    }
 
-   for(i = 0; i < h; i++)
+   r = &(list->regions[list->region_count++]);
+   r->sx = sx;
+   r->sy = sy;
+   r->tx = tx;
+   r->ty = ty;
+   r->w = w;
+   r->h = h;
+}
+
+/* Apply all copies that intersect output rows [start, end). */
+static void CopyBand(void *arg, int start, int end)
+{
+   const RegionList *list = (const RegionList*)arg;
+   const int input_width = (int)(list->input_image->width);
+   const int output_width = (int)(list->output_image->width);
+   const Region *r;
+   int i, y, y0, y1;
+
+   for(i = 0; i < list->region_count; i++)
    {
-      memcpy(output_pixels + ((ty + i) * output_image->width + tx) * 2,
-             input_pixels + ((sy + i) * input_image->width + sx) * 2,
-             w * 2);
+      r = &(list->regions[i]);
+      y0 = r->ty > start ? r->ty : start;
+      y1 = r->ty + r->h < end ? r->ty + r->h : end;
+      for(y = y0; y < y1; y++)
+      {
+         memcpy(list->output_pixels + (y * output_width + r->tx) * 2,
+                list->input_pixels +
+                   ((r->sy + y - r->ty) * input_width + r->sx) * 2,
+                r->w * 2);
+      }
    }
 }
 
@@ -58,11 +110,17 @@ static void CopyRegion(png_image *input_image, png_bytep input_pixels,
 static void AssembleTiles(png_image *input_image, png_bytep input_pixels,
                           png_image *output_image, png_bytep output_pixels)
 {
+   static RegionList list;
    int x, y, i;
 
+   list.input_image = input_image;
+   list.input_pixels = input_pixels;
+   list.output_image = output_image;
+   list.output_pixels = output_pixels;
+   list.region_count = 0;
+
    #define COPY(sx, sy, tx, ty, w, h) \
-      CopyRegion(input_image, input_pixels, output_image, output_pixels, \
-                 sx, sy, tx, ty, w, h)
+      AddRegion(&list, sx, sy, tx, ty, w, h)
 
    /* Chip backgrounds. */
    for(y = 0; y < 17 * 2; y++)
@@ -114,16 +172,22 @@ static void AssembleTiles(png_image *input_image, png_bytep input_pixels,
    COPY(384, 288, 768, 1184, 96, 32);
 
    #undef COPY
+
+   ForEachRowBand((int)(output_image->height), CopyBand, &list);
 }
 
 int main(int argc, char **argv)
 {
    png_image input_image, output_image;
    png_bytep input_pixels, output_pixels;
+   PngPreset preset;
 
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
    if( argc != 3 )
    {
-      fprintf(stderr, "%s {input.png} {output.png}\n", *argv);
+      fprintf(stderr, "%s [--preset={preset}] {input.png} {output.png}\n",
+              *argv);
       return 1;
    }
    if( strcmp(argv[2], "-") == 0 && isatty(STDOUT_FILENO) )
@@ -188,25 +252,11 @@ int main(int argc, char **argv)
    free(input_pixels);
 
    /* Write output. */
-   if( strcmp(argv[2], "-") == 0 )
-   {
-      if( !png_image_write_to_stdio(
-              &output_image, stdout, 0, output_pixels, 0, NULL) )
-      {
-         fputs("Error writing to stdout\n", stderr);
-         free(output_pixels);
-         return 1;
-      }
-   }
-   else
+   if( SavePng(argv[2], OUTPUT_WIDTH, OUTPUT_HEIGHT, output_pixels,
+               preset) != 0 )
    {
-      if( !png_image_write_to_file(
-             &output_image, argv[2], 0, output_pixels, 0, NULL) )
-      {
-         fprintf(stderr, "Error writing %s\n", argv[2]);
-         free(output_pixels);
-         return 1;
-      }
+      free(output_pixels);
+      return 1;
    }
 
    /* Success. */
@@ -0,0 +1,297 @@
+/* Packed black and white images.
+
+   See bitplane.h for descriptions.
+*/
+
+#include"bitplane.h"
+#include<png.h>
+#include<setjmp.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+int AllocBitplane(Bitplane *image, int width, int height)
+{
+   image->width = width;
+   image->height = height;
+   image->stride = (width + BITPLANE_WORD_BITS - 1) / BITPLANE_WORD_BITS;
+   image->color = (uint64_t*)calloc(image->stride * height, sizeof(uint64_t));
+   image->alpha = (uint64_t*)calloc(image->stride * height, sizeof(uint64_t));
+   if( image->color == NULL || image->alpha == NULL )
+   {
+      FreeBitplane(image);
+      return 1;
+   }
+   return 0;
+}
+
+void FreeBitplane(Bitplane *image)
+{
+   free(image->color);
+   free(image->alpha);
+   image->color = image->alpha = NULL;
+}
+
+void CopyBitplane(const Bitplane *src, Bitplane *dst)
+{
+   const size_t size = src->stride * src->height * sizeof(uint64_t);
+
+   memcpy(dst->color, src->color, size);
+   memcpy(dst->alpha, src->alpha, size);
+}
+
+int LoadBitplane(const char *filename, int flags, Bitplane *image)
+{
+   png_image png;
+   png_bytep pixels, p;
+   int x, y;
+   uint64_t bit;
+
+   memset(&png, 0, sizeof(png));
+   png.version = PNG_IMAGE_VERSION;
+   if( strcmp(filename, "-") == 0 )
+   {
+      if( !png_image_begin_read_from_stdio(&png, stdin) )
+      {
+         fputs("Error reading from stdin\n", stderr);
+         return 1;
+      }
+   }
+   else
+   {
+      if( !png_image_begin_read_from_file(&png, filename) )
+      {
+         fprintf(stderr, "Error reading %s\n", filename);
+         return 1;
+      }
+   }
+
+   png.format = PNG_FORMAT_GA;
+   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(png));
+   if( pixels == NULL )
+   {
+      png_image_free(&png);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   if( !png_image_finish_read(&png, NULL, pixels, 0, NULL) )
+   {
+      free(pixels);
+      fprintf(stderr, "Error loading %s\n", filename);
+      return 1;
+   }
+   if( AllocBitplane(image, (int)png.width, (int)png.height) != 0 )
+   {
+      free(pixels);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+
+   /* Pack pixels. */
+   p = pixels;
+   for(y = 0; y < image->height; y++)
+   {
+      for(x = 0; x < image->width; x++, p += 2)
+      {
+         bit = (uint64_t)1 << (x % BITPLANE_WORD_BITS);
+         if( (flags & BITPLANE_ALPHA_ONLY) != 0 )
+         {
+            if( p[1] != 0 )
+               image->alpha[y * image->stride + x / BITPLANE_WORD_BITS] |= bit;
+            continue;
+         }
+
+         /* Reject anything that would not survive the round trip, rather
+            than silently changing the output.                           */
+         if( (p[0] != 0 && p[0] != 0xff) || (p[1] != 0 && p[1] != 0xff) )
+         {
+            fprintf(stderr,
+                    "%s: pixel (%d,%d) is not black and white: "
+                    "color=%d, alpha=%d\n",
+                    filename, x, y, p[0], p[1]);
+            free(pixels);
+            FreeBitplane(image);
+            return 1;
+         }
+         if( p[0] != 0 )
+            image->color[y * image->stride + x / BITPLANE_WORD_BITS] |= bit;
+         if( p[1] != 0 )
+            image->alpha[y * image->stride + x / BITPLANE_WORD_BITS] |= bit;
+      }
+   }
+   free(pixels);
+   return 0;
+}
+
+/* Write image to an open file.  Returns 0 on success. */
+static int WriteBitplane(FILE *outfile, const Bitplane *image)
+{
+   /* Palette index is (alpha << 1) | color.  1bit grayscale plus tRNS
+      would be more compact, but can only express 3 distinct pixel values,
+      and we want to preserve colors of transparent pixels.              */
+   static png_color palette[4] =
+   {
+      {0, 0, 0}, {0xff, 0xff, 0xff}, {0, 0, 0}, {0xff, 0xff, 0xff}
+   };
+   static png_byte transparency[4] = {0, 0, 0xff, 0xff};
+
+   /* Volatile because these are modified between setjmp and longjmp. */
+   png_structp volatile png_ptr;
+   png_infop volatile info_ptr = NULL;
+   png_bytep volatile row;
+   uint64_t c, a;
+   int x, y, i;
+
+   png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+   if( png_ptr == NULL )
+      return 1;
+   row = (png_bytep)malloc((image->width * 2 + 7) / 8);
+   info_ptr = png_create_info_struct(png_ptr);
+   if( row == NULL || info_ptr == NULL )
+   {
+      free(row);
+      png_destroy_write_struct((png_structpp)&png_ptr, (png_infopp)&info_ptr);
+      return 1;
+   }
+
+   /* libpng prints its own error messages before jumping here. */
+   if( setjmp(png_jmpbuf(png_ptr)) )
+   {
+      free(row);
+      png_destroy_write_struct((png_structpp)&png_ptr, (png_infopp)&info_ptr);
+      return 1;
+   }
+
+   png_init_io(png_ptr, outfile);
+   png_set_IHDR(png_ptr, info_ptr, image->width, image->height, 2,
+                PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE,
+                PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+   png_set_PLTE(png_ptr, info_ptr, palette, 4);
+   png_set_tRNS(png_ptr, info_ptr, transparency, 4, NULL);
+
+   ApplyPngPreset(png_ptr, PNG_PRESET_INTERMEDIATE);
+   png_write_info(png_ptr, info_ptr);
+
+   for(y = 0; y < image->height; y++)
+   {
+      memset(row, 0, (image->width * 2 + 7) / 8);
+      for(x = 0; x < image->width; x++)
+      {
+         i = y * image->stride + x / BITPLANE_WORD_BITS;
+         c = (image->color[i] >> (x % BITPLANE_WORD_BITS)) & 1;
+         a = (image->alpha[i] >> (x % BITPLANE_WORD_BITS)) & 1;
+         row[x / 4] |= (png_byte)(((a << 1) | c) << (6 - (x % 4) * 2));
+      }
+      png_write_row(png_ptr, row);
+   }
+   png_write_end(png_ptr, info_ptr);
+   free(row);
+   png_destroy_write_struct((png_structpp)&png_ptr, (png_infopp)&info_ptr);
+   return 0;
+}
+
+/* Expand image to 8bit gray plus alpha and write it with SavePng.
+   Returns 0 on success.                                                 */
+static int SaveExpandedBitplane(const char *filename, const Bitplane *image,
+                                PngPreset preset)
+{
+   png_bytep pixels, p;
+   int x, y, status;
+
+   pixels = (png_bytep)malloc((size_t)image->width * image->height * 2);
+   if( pixels == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   p = pixels;
+   for(y = 0; y < image->height; y++)
+   {
+      for(x = 0; x < image->width; x++, p += 2)
+      {
+         p[0] = (png_byte)(((image->color[y * image->stride +
+                                          x / BITPLANE_WORD_BITS] >>
+                             (x % BITPLANE_WORD_BITS)) & 1) * 0xff);
+         p[1] = (png_byte)(GetBitplaneAlpha(image, x, y) * 0xff);
+      }
+   }
+   status = SavePng(filename, image->width, image->height, pixels, preset);
+   free(pixels);
+   return status;
+}
+
+int SaveBitplane(const char *filename, const Bitplane *image,
+                 PngPreset preset)
+{
+   FILE *outfile;
+   int status;
+
+   if( preset != PNG_PRESET_INTERMEDIATE )
+      return SaveExpandedBitplane(filename, image, preset);
+
+   if( strcmp(filename, "-") == 0 )
+   {
+      if( WriteBitplane(stdout, image) != 0 )
+      {
+         fputs("Error writing to stdout\n", stderr);
+         return 1;
+      }
+      return 0;
+   }
+
+   outfile = fopen(filename, "wb");
+   if( outfile == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", filename);
+      return 1;
+   }
+   status = WriteBitplane(outfile, image);
+   if( fclose(outfile) != 0 )
+      status = 1;
+   if( status != 0 )
+   {
+      /* Remove partial output, so that make doesn't see it as being up
+         to date.                                                       */
+      remove(filename);
+      fprintf(stderr, "Error writing %s\n", filename);
+   }
+   return status;
+}
+
+void StackBitplanes(Bitplane *image, const Bitplane *const *overlays,
+                    int count)
+{
+   const int size = image->stride * image->height;
+   uint64_t c, a, overlay_alpha;
+   int i, j;
+
+   /* Apply all overlays to one word before moving on to the next, so
+      that output is only read and written once regardless of number of
+      overlays.                                                         */
+   for(i = 0; i < size; i++)
+   {
+      c = image->color[i];
+      a = image->alpha[i];
+      for(j = 0; j < count; j++)
+      {
+         overlay_alpha = overlays[j]->alpha[i];
+         c = (c & ~overlay_alpha) | (overlays[j]->color[i] & overlay_alpha);
+         a |= overlay_alpha;
+      }
+      image->color[i] = c;
+      image->alpha[i] = a;
+   }
+}
+
+void EraseOddBitplaneRows(Bitplane *image)
+{
+   int y;
+
+   for(y = 1; y < image->height; y += 2)
+   {
+      memset(image->color + y * image->stride, 0,
+             image->stride * sizeof(uint64_t));
+      memset(image->alpha + y * image->stride, 0,
+             image->stride * sizeof(uint64_t));
+   }
+}
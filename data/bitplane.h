@@ -0,0 +1,94 @@
+/* Packed black and white images.
+
+   Tools that run after dithering only ever see black or white pixels that
+   are either fully opaque or fully transparent.  Instead of spending two
+   bytes per pixel on those, Bitplane stores color and alpha as separate
+   bit planes with 64 pixels per word, so that compositing and searching
+   for nonempty pixels can be done a whole word at a time.
+
+   Pixel (x,y) is bit (x % 64) of word (y * stride + x / 64).  Unused bits
+   at the end of each row are always zero.
+*/
+
+#ifndef BITPLANE_H_
+#define BITPLANE_H_
+
+#include"png_encode.h"
+#include<stdint.h>
+
+#define BITPLANE_WORD_BITS 64
+
+/* Only load the alpha plane, treating all nonzero alpha values as opaque.
+   Color plane is left blank.  This is for tools that only care about
+   which pixels are empty, and accept input that is not black and white.  */
+#define BITPLANE_ALPHA_ONLY   1
+
+typedef struct
+{
+   int width, height;
+
+   /* Number of words per row. */
+   int stride;
+
+   /* Bit is set for white pixels. */
+   uint64_t *color;
+
+   /* Bit is set for opaque pixels. */
+   uint64_t *alpha;
+} Bitplane;
+
+/* Allocate a fully transparent black image.  Returns 0 on success,
+   nonzero if we ran out of memory.                                      */
+int AllocBitplane(Bitplane *image, int width, int height);
+
+/* Release image memory. */
+void FreeBitplane(Bitplane *image);
+
+/* Copy pixels from one image to another of the same size. */
+void CopyBitplane(const Bitplane *src, Bitplane *dst);
+
+/* Load a PNG from file, or from stdin if filename is "-".  Unless
+   BITPLANE_ALPHA_ONLY is set in flags, all color and alpha values must
+   be either 0 or 255.
+
+   Returns 0 on success.  On failure, an error message is written to
+   stderr and nonzero is returned.                                       */
+int LoadBitplane(const char *filename, int flags, Bitplane *image);
+
+/* Write image to file, or to stdout if filename is "-".  With
+   PNG_PRESET_INTERMEDIATE, output is a 2bit palette PNG that is optimized
+   for encoding speed rather than size.  With PNG_PRESET_FINAL, output is
+   the smallest encoding found by SavePng.
+
+   Returns 0 on success.  On failure, an error message is written to
+   stderr and nonzero is returned.                                       */
+int SaveBitplane(const char *filename, const Bitplane *image,
+                 PngPreset preset);
+
+/* Composite a list of overlays on top of image, in order.  Opaque overlay
+   pixels replace image pixels, transparent overlay pixels leave image
+   pixels untouched.  Images must be the same size.                      */
+void StackBitplanes(Bitplane *image, const Bitplane *const *overlays,
+                    int count);
+
+/* Erase every odd scanline. */
+void EraseOddBitplaneRows(Bitplane *image);
+
+/* Pixel accessors. */
+static inline int GetBitplaneAlpha(const Bitplane *image, int x, int y)
+{
+   return (int)((image->alpha[y * image->stride + x / BITPLANE_WORD_BITS] >>
+                 (x % BITPLANE_WORD_BITS)) & 1);
+}
+
+static inline void SetBitplanePixel(Bitplane *image, int x, int y,
+                                    int color, int alpha)
+{
+   const int i = y * image->stride + x / BITPLANE_WORD_BITS;
+   const uint64_t bit = (uint64_t)1 << (x % BITPLANE_WORD_BITS);
+
+   image->color[i] = color ? (image->color[i] | bit) : (image->color[i] & ~bit);
+   image->alpha[i] = alpha ? (image->alpha[i] | bit) : (image->alpha[i] & ~bit);
+}
+
+#endif
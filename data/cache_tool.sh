@@ -0,0 +1,134 @@
+#!/bin/bash
+# Run a tool command with cached output.
+#
+# Usage:
+#
+#   ./cache_tool.sh [--pattern {pattern}] {command} {output} [outputs...]
+#
+# This is the same idea as the output cache in svg_to_png.sh, but for the
+# C tools that run after Inkscape.  Command is a single string that is run
+# with "bash -c", and outputs are files that the command writes to.
+#
+# Cache key is the hash of the command string, plus the contents of every
+# word in the command that names an existing file.  This covers the tool
+# executable itself and all input files, as long as they appear as separate
+# words in the command.  Output files are excluded from the key, since they
+# are the things being cached.
+#
+# On cache hit, the tool is not run at all, and we just copy the cached
+# output.  On cache miss, output filenames in the command are replaced with
+# paths to cache entries, so that the tool writes directly to the cache.
+# Either way, outputs are only updated if the contents changed, which allows
+# make to skip rebuilding downstream dependants.  An edit to one layer of
+# world.svg would update timestamps of all layers, but only the outputs
+# that actually depend on the edited layer will be regenerated.
+#
+# Some tools take a printf-style pattern instead of output filenames, such
+# as "--out-pattern t_card_stars%02d.png" in add_starfield.  Passing the
+# same pattern with "--pattern" causes it to be replaced with a pattern
+# that generates cache entry paths.  All files generated from the pattern
+# still need to be listed as outputs.
+
+PATTERNS=()
+while [[ $# -ge 2 && "$1" == "--pattern" ]]; do
+   PATTERNS+=("$2")
+   shift 2
+done
+if [[ $# -lt 2 ]]; then
+   echo "$0 [--pattern {pattern}] {command} {output} [outputs...]"
+   exit 1
+fi
+COMMAND=$1
+shift
+OUTPUTS=("$@")
+
+set -euo pipefail
+
+# Check if a word is one of the outputs.
+function is_output
+{
+   local word=$1
+   local output
+   for output in "${OUTPUTS[@]}"; do
+      if [[ "$word" == "$output" ]]; then
+         return 0
+      fi
+   done
+   return 1
+}
+
+# Compute cache key.  Quotes are stripped from each word, so that files
+# inside quoted arguments are also included.
+KEY=$(
+   set -f
+   {
+      echo "$COMMAND"
+      for word in $COMMAND; do
+         word=${word//[\'\"]/}
+         if [[ -f "$word" ]] && ! is_output "$word"; then
+            echo "$word $(md5sum < "$word" | awk '{print $1}')"
+         fi
+      done
+   } | md5sum | awk '{print $1}'
+)
+PREFIX=$(dirname "$0")/t_tool_cache_$KEY
+
+# Get cache entry path for an output or pattern.  Entries are named after
+# the output basename, so that a rewritten pattern generates the same paths.
+function cache_path
+{
+   echo "${PREFIX}_$(basename "$1")"
+}
+
+# Replace whole words in a command (possibly next to quotes), so that a
+# filename that happens to be a substring of some other filename is not
+# affected.
+function replace_word
+{
+   OLD="$2" NEW="$3" \
+   perl -e '$_ = $ARGV[0];
+            s/(?<![^\s\x27"]) \Q$ENV{OLD}\E (?![^\s\x27"])/$ENV{NEW}/gx;
+            print' \
+      "$1"
+}
+
+# Outputs with the same basename would share a cache entry.
+if [[ -n "$(for output in "${OUTPUTS[@]}"; do basename "$output"; done | \
+            sort | uniq -d)" ]]; then
+   echo "$0: output basenames must be unique"
+   exit 1
+fi
+
+# Check if all cache entries exist.
+HIT=1
+for output in "${OUTPUTS[@]}"; do
+   if ! [[ -s "$(cache_path "$output")" ]]; then
+      HIT=0
+      break
+   fi
+done
+
+if [[ $HIT -eq 0 ]]; then
+   # Replace output filenames and patterns with cache entry paths.
+   CACHED_COMMAND="$COMMAND"
+   for output in "${OUTPUTS[@]}" "${PATTERNS[@]}"; do
+      CACHED_COMMAND=$(replace_word "$CACHED_COMMAND" \
+                                    "$output" "$(cache_path "$output")")
+   done
+
+   if ! bash -c "$CACHED_COMMAND"; then
+      # Remove partial cache entries, so that they are not mistaken as
+      # valid outputs on the next run.
+      for output in "${OUTPUTS[@]}"; do
+         rm -f "$(cache_path "$output")"
+      done
+      exit 1
+   fi
+fi
+
+# Copy cache entries to outputs, skipping outputs that are identical.
+for output in "${OUTPUTS[@]}"; do
+   if ! ( diff -q -N "$(cache_path "$output")" "$output" > /dev/null ); then
+      cp "$(cache_path "$output")" "$output"
+   fi
+done
@@ -7,8 +7,32 @@
       {w0} {h0} = old tile size.
       {w1} {h1} = new tile size.
       {x} {y} = offset within the old tile cells
+
+   Alternatively:
+
+      ./crop_table --atlas {w0} {h0} {boxes.txt} {name} {offsets.lua} \
+         < {old.png} > {atlas.png}
+
+      {w0} {h0} = old tile size.
+      {boxes.txt} = per-cell bounding boxes from "shrink_tiles --cells".
+      {name} = name of Lua table to be written to {offsets.lua}.
+
+   This crops each cell to its own bounding box and packs the results
+   into shelves, so that cells don't all take up the space of the largest
+   cell.  {offsets.lua} will contain one entry per cell:
+
+      [i] = {atlas_x, atlas_y, width, height, cell_x, cell_y},
+
+   where (atlas_x, atlas_y) is the position of the cropped cell in
+   {atlas.png}, and (cell_x, cell_y) is where the cropped cell was within
+   the original {w0}x{h0} cell.  Blank cells have zero width and height.
+
+   Both forms also accept "--preset={preset}" to select PNG encoder
+   settings, see png_encode.h.
 */
 
+#include"image_ops.h"
+#include"png_encode.h"
 #include<png.h>
 #include<stdio.h>
 #include<stdlib.h>
@@ -20,41 +44,343 @@
    #include<io.h>
 #endif
 
-/* Shift the pixels in-place. */
-static void CropTilesInPlace(png_image *image, png_bytep pixels,
-                             int w0, int h0, int w1, int h1, int x, int y)
+/* Placement of a single cell within atlas. */
+typedef struct
 {
-   int tile_x, tile_y, cell_y;
-   png_bytep r, w = pixels;
+   /* Bounding box within original cell. */
+   int width, height, cell_x, cell_y;
+
+   /* Position within atlas. */
+   int atlas_x, atlas_y;
+} AtlasCell;
 
-   for(tile_y = 0; tile_y < (int)(image->height) / h0; tile_y++)
+/* Set binary output, returns 0 on success. */
+static int SetBinaryOutput(void)
+{
+   if( isatty(STDOUT_FILENO) )
    {
-      for(cell_y = 0; cell_y < h1; cell_y++)
+      fputs("Not writing output to stdout because it's a tty\n", stderr);
+      return 1;
+   }
+   #ifdef _WIN32
+      setmode(STDIN_FILENO, O_BINARY);
+      setmode(STDOUT_FILENO, O_BINARY);
+   #endif
+   return 0;
+}
+
+/* Load input from stdin, checking that image dimensions are multiples of
+   tile size.  Returns pixels on success, NULL on failure.               */
+static png_bytep LoadInput(png_image *image, int w0, int h0)
+{
+   png_bytep pixels;
+
+   memset(image, 0, sizeof(png_image));
+   image->version = PNG_IMAGE_VERSION;
+   if( !png_image_begin_read_from_stdio(image, stdin) )
+   {
+      fputs("Error reading input\n", stderr);
+      return NULL;
+   }
+   if( image->width % w0 != 0 || image->height % h0 != 0 )
+   {
+      fprintf(stderr,
+              "Image dimension is not a multiple of (%d,%d): (%d,%d)\n",
+              w0, h0, (int)image->width, (int)image->height);
+      png_image_free(image);
+      return NULL;
+   }
+
+   image->format = PNG_FORMAT_GA;
+   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(*image));
+   if( pixels == NULL )
+   {
+      png_image_free(image);
+      fputs("Out of memory\n", stderr);
+      return NULL;
+   }
+   if( !png_image_finish_read(image, NULL, pixels, 0, NULL) )
+   {
+      free(pixels);
+      fputs("Error loading input\n", stderr);
+      return NULL;
+   }
+   return pixels;
+}
+
+/* Write output to stdout.  Returns 0 on success. */
+static int WriteOutput(png_image *image, png_const_bytep pixels,
+                       PngPreset preset)
+{
+   return SavePng("-", (int)image->width, (int)image->height, pixels,
+                  preset);
+}
+
+/* Load per-cell bounding boxes.  Returns 0 on success. */
+static int LoadBoxes(const char *filename, int w0, int h0,
+                     AtlasCell *cells, int cell_count)
+{
+   FILE *infile;
+   AtlasCell *c;
+   int i;
+
+   if( (infile = fopen(filename, "rb")) == NULL )
+   {
+      fprintf(stderr, "Error reading %s\n", filename);
+      return 1;
+   }
+   for(i = 0; i < cell_count; i++)
+   {
+      c = &cells[i];
+      if( fscanf(infile, "%d %d %d %d",
+                 &c->width, &c->height, &c->cell_x, &c->cell_y) != 4 )
+      {
+         fprintf(stderr, "%s: expected %d boxes, got %d\n",
+                 filename, cell_count, i);
+         fclose(infile);
+         return 1;
+      }
+      if( c->width < 0 || c->height < 0 ||
+          c->cell_x < 0 || c->cell_y < 0 ||
+          c->cell_x + c->width > w0 || c->cell_y + c->height > h0 )
+      {
+         fprintf(stderr, "%s: invalid box for cell %d: %dx%d+%d+%d\n",
+                 filename, i, c->width, c->height, c->cell_x, c->cell_y);
+         fclose(infile);
+         return 1;
+      }
+      if( c->width == 0 || c->height == 0 )
+         c->width = c->height = 0;
+   }
+   fclose(infile);
+   return 0;
+}
+
+/* Place cells in order into shelves no wider than atlas_width.  If
+   commit is set, atlas positions are written to cells.  Returns atlas
+   height.                                                               */
+static int PlaceShelves(AtlasCell *cells, const int *order, int cell_count,
+                        int atlas_width, int commit)
+{
+   int i, x = 0, y = 0, shelf_height = 0;
+   AtlasCell *c;
+
+   for(i = 0; i < cell_count; i++)
+   {
+      c = &cells[order[i]];
+      if( c->width == 0 )
+      {
+         if( commit )
+            c->atlas_x = c->atlas_y = 0;
+         continue;
+      }
+
+      /* Start a new shelf if this cell doesn't fit in the current one.
+         Because cells are sorted by decreasing height, the first cell
+         on each shelf determines the shelf height.                      */
+      if( x + c->width > atlas_width )
       {
-         for(tile_x = 0; tile_x < (int)(image->width) / w0; tile_x++)
-         {
-            r = pixels +
-                2 * ((tile_y * h0 + cell_y + y) * image->width +
-                     (tile_x * w0 + x));
-            memmove(w, r, w1 * 2);
-            w += w1 * 2;
-         }
+         y += shelf_height;
+         x = shelf_height = 0;
       }
+      if( shelf_height == 0 )
+         shelf_height = c->height;
+      if( commit )
+      {
+         c->atlas_x = x;
+         c->atlas_y = y;
+      }
+      x += c->width;
    }
+   return y + shelf_height;
+}
+
+/* Order of cells to be packed, tallest first, ties broken by cell index
+   so that output is deterministic.                                      */
+static const AtlasCell *sort_cells;
+static int CompareCellHeight(const void *a, const void *b)
+{
+   const int ia = *(const int*)a, ib = *(const int*)b;
+
+   if( sort_cells[ia].height != sort_cells[ib].height )
+      return sort_cells[ib].height - sort_cells[ia].height;
+   return ia - ib;
+}
+
+/* Choose atlas width that minimizes total atlas area, and assign cell
+   positions.  Returns 0 on success.                                     */
+static int PackCells(AtlasCell *cells, int cell_count,
+                     int *atlas_width, int *atlas_height)
+{
+   int *order;
+   int i, width, height, min_width = 1, max_width = 0;
+   long area, best_area = -1;
+
+   if( (order = (int*)malloc(cell_count * sizeof(int))) == NULL )
+      return 1;
+   for(i = 0; i < cell_count; i++)
+   {
+      order[i] = i;
+      if( min_width < cells[i].width )
+         min_width = cells[i].width;
+      max_width += cells[i].width;
+   }
+   sort_cells = cells;
+   qsort(order, cell_count, sizeof(int), CompareCellHeight);
+
+   /* Try all widths between the widest cell and all cells in a single
+      row.  Tables have few enough cells that this is cheap.             */
+   *atlas_width = min_width;
+   for(width = min_width; width <= max_width; width++)
+   {
+      height = PlaceShelves(cells, order, cell_count, width, 0);
+      area = (long)width * height;
+      if( best_area < 0 || area < best_area )
+      {
+         best_area = area;
+         *atlas_width = width;
+      }
+   }
+   *atlas_height = PlaceShelves(cells, order, cell_count, *atlas_width, 1);
+   if( *atlas_height == 0 )
+      *atlas_height = 1;
+
+   free(order);
+   return 0;
+}
+
+/* Write cell placements as a Lua table.  Returns 0 on success. */
+static int WriteOffsets(const char *filename, const char *name,
+                        const AtlasCell *cells, int cell_count)
+{
+   FILE *outfile;
+   int i;
+
+   if( (outfile = fopen(filename, "wb")) == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", filename);
+      return 1;
+   }
+   fprintf(outfile, "%s =\n{\n", name);
+   for(i = 0; i < cell_count; i++)
+   {
+      fprintf(outfile, "\t[%d] = {%d, %d, %d, %d, %d, %d},\n",
+              i + 1,
+              cells[i].atlas_x, cells[i].atlas_y,
+              cells[i].width, cells[i].height,
+              cells[i].cell_x, cells[i].cell_y);
+   }
+   fputs("}\n", outfile);
+   if( fclose(outfile) != 0 )
+   {
+      fprintf(stderr, "Error writing %s\n", filename);
+      return 1;
+   }
+   return 0;
+}
+
+/* Crop cells to per-cell bounding boxes and pack them into an atlas. */
+static int Atlas(int argc, char **argv, PngPreset preset)
+{
+   int w0, h0, tiles_x, cell_count, i, y, atlas_width, atlas_height, status;
+   png_image image, atlas;
+   png_bytep pixels, atlas_pixels;
+   AtlasCell *cells, *c;
+
+   if( argc != 7 )
+   {
+      fprintf(stderr,
+              "%s --atlas {w0} {h0} {boxes.txt} {name} {offsets.lua} "
+              "< {old.png} > {atlas.png}\n",
+              *argv);
+      return 1;
+   }
+   w0 = atoi(argv[2]);
+   h0 = atoi(argv[3]);
+   if( w0 < 1 || h0 < 1 )
+   {
+      fprintf(stderr, "Invalid tile size: %dx%d\n", w0, h0);
+      return 1;
+   }
+   if( SetBinaryOutput() != 0 ||
+       (pixels = LoadInput(&image, w0, h0)) == NULL )
+   {
+      return 1;
+   }
+
+   tiles_x = (int)image.width / w0;
+   cell_count = tiles_x * ((int)image.height / h0);
+   if( (cells = (AtlasCell*)malloc(cell_count * sizeof(AtlasCell))) == NULL )
+   {
+      free(pixels);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   if( LoadBoxes(argv[4], w0, h0, cells, cell_count) != 0 ||
+       PackCells(cells, cell_count, &atlas_width, &atlas_height) != 0 )
+   {
+      free(cells);
+      free(pixels);
+      return 1;
+   }
+
+   /* Copy cells to atlas. */
+   memset(&atlas, 0, sizeof(atlas));
+   atlas.version = PNG_IMAGE_VERSION;
+   atlas.format = PNG_FORMAT_GA;
+   atlas.width = atlas_width;
+   atlas.height = atlas_height;
+   if( (atlas_pixels = (png_bytep)calloc(PNG_IMAGE_SIZE(atlas), 1)) == NULL )
+   {
+      free(cells);
+      free(pixels);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   for(i = 0; i < cell_count; i++)
+   {
+      c = &cells[i];
+      for(y = 0; y < c->height; y++)
+      {
+         memcpy(atlas_pixels + 2 * ((c->atlas_y + y) * atlas_width +
+                                    c->atlas_x),
+                pixels + 2 * (((i / tiles_x) * h0 + c->cell_y + y) *
+                              (int)image.width +
+                              (i % tiles_x) * w0 + c->cell_x),
+                c->width * 2);
+      }
+   }
+   free(pixels);
+
+   /* Write output. */
+   status = WriteOffsets(argv[6], argv[5], cells, cell_count);
+   if( status == 0 )
+      status = WriteOutput(&atlas, atlas_pixels, preset);
+   free(atlas_pixels);
+   free(cells);
+   return status;
 }
 
 int main(int argc, char **argv)
 {
    int w0, h0, w1, h1, x, y;
    png_image image;
-   png_bytep pixels;
+   png_bytep pixels, output;
+   PngPreset preset;
+
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
+   if( argc > 1 && strcmp(argv[1], "--atlas") == 0 )
+      return Atlas(argc, argv, preset);
 
    /* Check input arguments. */
    if( argc != 7 )
    {
       fprintf(stderr,
-              "%s {w0} {h0} {w1} {h1} {x} {y} < {old.png} > {new.png}\n",
-              *argv);
+              "%s {w0} {h0} {w1} {h1} {x} {y} < {old.png} > {new.png}\n"
+              "%s --atlas {w0} {h0} {boxes.txt} {name} {offsets.lua} "
+              "< {old.png} > {atlas.png}\n",
+              *argv, *argv);
       return 1;
    }
 
@@ -74,65 +400,25 @@ int main(int argc, char **argv)
       return 1;
    }
 
-   /* Set binary output. */
-   if( isatty(STDOUT_FILENO) )
-   {
-      fputs("Not writing output to stdout because it's a tty\n", stderr);
-      return 1;
-   }
-   #ifdef _WIN32
-      setmode(STDIN_FILENO, O_BINARY);
-      setmode(STDOUT_FILENO, O_BINARY);
-   #endif
-
    /* Load input. */
-   memset(&image, 0, sizeof(image));
-   image.version = PNG_IMAGE_VERSION;
-   if( !png_image_begin_read_from_stdio(&image, stdin) )
-   {
-      fputs("Error reading input\n", stderr);
-      return 1;
-   }
-   if( image.width % w0 != 0 || image.height % h0 != 0 )
-   {
-      fprintf(stderr,
-              "Image dimension is not a multiple of (%d,%d): (%d,%d)\n",
-              w0, h0, (int)image.width, (int)image.height);
+   if( SetBinaryOutput() != 0 || (pixels = LoadInput(&image, w0, h0)) == NULL )
       return 1;
-   }
 
-   image.format = PNG_FORMAT_GA;
-   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   if( pixels == NULL )
-   {
-      fputs("Out of memory", stderr);
-      return 1;
-   }
-   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
+   /* Apply crop.  This is done out-of-place so that tile rows can be
+      processed in parallel.                                             */
+   output = (png_bytep)malloc((size_t)(image.width / w0) * w1 *
+                              (image.height / h0) * h1 * 2);
+   if( output == NULL )
    {
       free(pixels);
-      fputs("Error loading input\n", stderr);
-      return 1;
-   }
-
-   /* Apply crop. */
-   CropTilesInPlace(&image, pixels, w0, h0, w1, h1, x, y);
-   image.width = (image.width / w0) * w1;
-   image.height = (image.height / h0) * h1;
-
-   /* Write output.  Here we set the flags to optimize for encoding speed
-      rather than output size so that we can iterate faster.  This is fine
-      since the output of this tool are intermediate files that are used
-      only in the build process, and are not the final PNGs that will be
-      committed.                                                           */
-   image.flags |= PNG_IMAGE_FLAG_FAST;
-   if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
-   {
-      fputs("Error writing output\n", stderr);
-      free(pixels);
+      fputs("Out of memory\n", stderr);
       return 1;
    }
-
+   CropTiles(&image, pixels, output, w0, h0, w1, h1, x, y);
    free(pixels);
-   return 0;
+
+   /* Write output. */
+   x = WriteOutput(&image, output, preset);
+   free(output);
+   return x;
 }
@@ -2,15 +2,25 @@
 
    Usage:
 
-      ./fs_dither {input.png} {output.png}
+      ./fs_dither [--preset={preset}] {input.png} {output.png}
 
-   Use "-" for input or output to read/write from stdin/stdout.
+   Use "-" for input or output to read/write from stdin/stdout.  See
+   png_encode.h for available presets.
 
    Given a grayscale (8bit) plus alpha (8bit) PNG, output a black and
    white (1bit) plus transparency (1bit) PNG, with Floyd-Steinberg dithering.
+
+   Input is streamed one scanline at a time with the low-level libpng
+   API, so memory usage is proportional to image width instead of image
+   size.  This allows rasterizing world.svg at higher resolutions.
+   Interlaced input is the exception, since rows are not available in
+   order until the last pass, so those are loaded in full.
 */
 
+#include"image_ops.h"
+#include"png_encode.h"
 #include<png.h>
+#include<setjmp.h>
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
@@ -21,53 +31,172 @@
    #include<io.h>
 #endif
 
-/* Dither a single channel. */
-static void DitherChannel(int *row_error[2],
-                          int width,
-                          int height,
-                          png_bytep pixels)
+/* Streaming reader and writer.  Rows are converted with the same libpng
+   transforms that the simplified API uses for PNG_FORMAT_GA, and written
+   with the same settings as SavePng with PNG_PRESET_INTERMEDIATE, so
+   output is identical to the full-image path by default.                */
+typedef struct
+{
+   png_structp read_ptr;
+   png_infop read_info;
+   png_structp write_ptr;
+   png_infop write_info;
+   png_bytep pixels;
+   png_bytepp rows;
+   FloydSteinbergState state;
+   int state_allocated;
+} StreamContext;
+
+static void FreeStreamContext(StreamContext *context)
 {
-   int y0 = 0, y1 = 1, x, y, i, o, e;
-   png_bytep p = pixels;
+   if( context->read_ptr != NULL )
+      png_destroy_read_struct(&context->read_ptr, &context->read_info, NULL);
+   if( context->write_ptr != NULL )
+      png_destroy_write_struct(&context->write_ptr, &context->write_info);
+   free(context->pixels);
+   free(context->rows);
+   if( context->state_allocated )
+      FreeFloydSteinberg(&context->state);
+}
 
-   memset(row_error[0], 0, (width + 2) * sizeof(int));
-   for(y = 0; y < height; y++)
+/* Dither input to output.  Returns 0 on success. */
+static int StreamDither(FILE *infile, FILE *outfile, PngPreset preset)
+{
+   /* All state that is modified after setjmp is accessed through this
+      pointer, so that it's still valid after libpng calls longjmp.      */
+   StreamContext context;
+   StreamContext * volatile c = &context;
+   png_uint_32 width, height, y;
+   int bit_depth, color_type, interlaced;
+
+   memset(&context, 0, sizeof(context));
+   c->read_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                        NULL, NULL, NULL);
+   if( c->read_ptr == NULL )
+      return 1;
+   c->read_info = png_create_info_struct(c->read_ptr);
+   c->write_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                          NULL, NULL, NULL);
+   if( c->read_info == NULL || c->write_ptr == NULL )
+   {
+      FreeStreamContext(c);
+      return 1;
+   }
+   c->write_info = png_create_info_struct(c->write_ptr);
+   if( c->write_info == NULL )
+   {
+      FreeStreamContext(c);
+      return 1;
+   }
+
+   /* libpng prints its own error messages before jumping here. */
+   if( setjmp(png_jmpbuf(c->read_ptr)) )
+   {
+      FreeStreamContext(c);
+      return 1;
+   }
+   if( setjmp(png_jmpbuf(c->write_ptr)) )
    {
-      /* Reset error for next scanline. */
-      memset(row_error[y1], 0, (width + 2) * sizeof(int));
+      FreeStreamContext(c);
+      return 1;
+   }
+
+   png_init_io(c->read_ptr, infile);
+   png_read_info(c->read_ptr, c->read_info);
+   width = png_get_image_width(c->read_ptr, c->read_info);
+   height = png_get_image_height(c->read_ptr, c->read_info);
+   bit_depth = png_get_bit_depth(c->read_ptr, c->read_info);
+   color_type = png_get_color_type(c->read_ptr, c->read_info);
+   interlaced = png_get_interlace_type(c->read_ptr, c->read_info) !=
+                PNG_INTERLACE_NONE;
+
+   /* Convert to 8bit gray plus alpha. */
+   png_set_expand(c->read_ptr);
+   png_set_alpha_mode_fixed(c->read_ptr, PNG_ALPHA_PNG,
+                            bit_depth == 16 ? PNG_GAMMA_LINEAR
+                                            : PNG_DEFAULT_sRGB);
+   if( (color_type & PNG_COLOR_MASK_COLOR) != 0 )
+   {
+      png_set_rgb_to_gray_fixed(c->read_ptr, PNG_ERROR_ACTION_NONE,
+                                PNG_RGB_TO_GRAY_DEFAULT,
+                                PNG_RGB_TO_GRAY_DEFAULT);
+   }
+   if( bit_depth == 16 )
+      png_set_scale_16(c->read_ptr);
+   if( (color_type & PNG_COLOR_MASK_ALPHA) == 0 &&
+       !png_get_valid(c->read_ptr, c->read_info, PNG_INFO_tRNS) )
+   {
+      png_set_add_alpha(c->read_ptr, 0xff, PNG_FILLER_AFTER);
+   }
+   png_set_alpha_mode_fixed(c->read_ptr, PNG_ALPHA_PNG, PNG_DEFAULT_sRGB);
+   if( interlaced )
+      png_set_interlace_handling(c->read_ptr);
+   png_read_update_info(c->read_ptr, c->read_info);
+   if( png_get_rowbytes(c->read_ptr, c->read_info) != width * 2 )
+   {
+      FreeStreamContext(c);
+      fputs("Unexpected row size after conversion\n", stderr);
+      return 1;
+   }
+
+   /* Allocate a single row for streaming, or all rows for interlaced
+      input.                                                           */
+   c->pixels = (png_bytep)malloc(width * 2 * (interlaced ? height : 1));
+   c->rows = (png_bytepp)malloc((interlaced ? height : 1) * sizeof(png_bytep));
+   if( c->pixels == NULL || c->rows == NULL ||
+       InitFloydSteinberg(&c->state, (int)width) != 0 )
+   {
+      FreeStreamContext(c);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   c->state_allocated = 1;
+   if( interlaced )
+   {
+      for(y = 0; y < height; y++)
+         c->rows[y] = c->pixels + y * width * 2;
+      png_read_image(c->read_ptr, c->rows);
+   }
 
-      /* Dither a single scanline. */
-      for(x = 0; x < width; x++, p += 2)
+   /* Write output header. */
+   png_init_io(c->write_ptr, outfile);
+   png_set_IHDR(c->write_ptr, c->write_info, width, height, 8,
+                PNG_COLOR_TYPE_GRAY_ALPHA, PNG_INTERLACE_NONE,
+                PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+   ApplyPngPreset(c->write_ptr, preset);
+   png_write_info(c->write_ptr, c->write_info);
+
+   /* Dither one row at a time. */
+   for(y = 0; y < height; y++)
+   {
+      if( interlaced )
       {
-         /* i = intended grayscale level. */
-         i = *p + row_error[y0][x + 1] / 16;
-
-         /* o = output grayscale level. */
-         o = i > 127 ? 255 : 0;
-         *p = o;
-
-         /* Propagate error. */
-         e = i - o;
-         row_error[y0][x + 2] += e * 7;
-         row_error[y1][x    ] += e * 3;
-         row_error[y1][x + 1] += e * 5;
-         row_error[y1][x + 2] += e;
+         FloydSteinbergDitherRow(&c->state, c->rows[y]);
+         png_write_row(c->write_ptr, c->rows[y]);
+      }
+      else
+      {
+         png_read_row(c->read_ptr, c->pixels, NULL);
+         FloydSteinbergDitherRow(&c->state, c->pixels);
+         png_write_row(c->write_ptr, c->pixels);
       }
-
-      y0 ^= 1;
-      y1 ^= 1;
    }
+   png_read_end(c->read_ptr, NULL);
+   png_write_end(c->write_ptr, c->write_info);
+   FreeStreamContext(c);
+   return 0;
 }
 
 int main(int argc, char **argv)
 {
-   png_image image;
-   png_bytep pixels, p;
-   int x, y;
-   int *row_error[2];
+   FILE *infile, *outfile;
+   PngPreset preset;
+   int x;
 
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
    if( argc != 3 )
-      return printf("%s {input.png} {output.png}\n", *argv);
+      return printf("%s [--preset={preset}] {input.png} {output.png}\n", *argv);
 
    if( strcmp(argv[2], "-") == 0 && isatty(STDOUT_FILENO) )
    {
@@ -79,84 +208,45 @@ int main(int argc, char **argv)
       setmode(STDOUT_FILENO, O_BINARY);
    #endif
 
-   /* Load input. */
-   memset(&image, 0, sizeof(image));
-   image.version = PNG_IMAGE_VERSION;
    if( strcmp(argv[1], "-") == 0 )
    {
-      if( !png_image_begin_read_from_stdio(&image, stdin) )
-      {
-         puts("Error reading from stdin");
-         return 1;
-      }
+      infile = stdin;
    }
    else
    {
-      if( !png_image_begin_read_from_file(&image, argv[1]) )
+      infile = fopen(argv[1], "rb");
+      if( infile == NULL )
          return printf("Error reading %s\n", argv[1]);
    }
-
-   row_error[0] = (int*)malloc((image.width + 2) * sizeof(int));
-   row_error[1] = (int*)malloc((image.width + 2) * sizeof(int));
-   if( row_error[0] == NULL || row_error[1] == NULL )
-   {
-      puts("Out of memory");
-      return 1;
-   }
-
-   image.format = PNG_FORMAT_GA;
-   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   if( pixels == NULL )
-   {
-      puts("Out of memory");
-      return 1;
-   }
-   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
+   if( strcmp(argv[2], "-") == 0 )
    {
-      free(pixels);
-      return printf("Error loading %s\n", argv[1]);
+      outfile = stdout;
    }
-
-   /* Dither color and alpha channel independently. */
-   DitherChannel(row_error, (int)image.width, (int)image.height, pixels);
-   DitherChannel(row_error, (int)image.width, (int)image.height, pixels + 1);
-
-   /* Set color to zero if the corresponding alpha is zero. */
-   p = pixels;
-   for(y = 0; y < (int)image.height; y++)
+   else
    {
-      for(x = 0; x < (int)image.width; x++, p += 2)
+      outfile = fopen(argv[2], "wb");
+      if( outfile == NULL )
       {
-         if( *(p + 1) == 0 )
-            *p = 0;
+         if( infile != stdin )
+            fclose(infile);
+         return printf("Error writing %s\n", argv[2]);
       }
    }
 
-   /* Write output.  Here we set the flags to optimize for encoding speed
-      rather than output size so that we can iterate faster.  This is fine
-      since the output of this tool are intermediate files that are used
-      only in the build process, and are not the final PNGs that will be
-      committed.                                                           */
-   image.flags |= PNG_IMAGE_FLAG_FAST;
-   x = 0;
-   if( strcmp(argv[2], "-") == 0 )
+   x = StreamDither(infile, outfile, preset);
+   if( infile != stdin )
+      fclose(infile);
+   if( outfile != stdout )
    {
-      if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
-      {
-         fputs("Error writing to stdout\n", stderr);
+      if( fclose(outfile) != 0 )
          x = 1;
-      }
-   }
-   else
-   {
-      if( !png_image_write_to_file(&image, argv[2], 0, pixels, 0, NULL) )
-      {
-         printf("Error writing %s\n", argv[2]);
-         x = 1;
-      }
+
+      /* Remove partial output on error, so that make doesn't see it as
+         being up to date.                                               */
+      if( x != 0 )
+         remove(argv[2]);
    }
-   free(row_error[0]);
-   free(row_error[1]);
-   free(pixels);
+   if( x != 0 )
+      fprintf(stderr, "Error dithering %s\n", argv[1]);
    return x;
 }
@@ -13,9 +13,29 @@
 #
 # No conditionals, suffix rules, etc.  It's very basic, but it's good enough
 # for our Makefile.
+#
+# With --profile, this reads a log produced by profile_recipe.pl instead
+# of generating a graph, and outputs a Chrome trace JSON to stdout (load
+# it in chrome://tracing or ui.perfetto.dev).  A summary is written to
+# stderr, containing:
+#
+# - Critical path, which is the longest chain of dependent recipes.  No
+#   amount of parallelism will make the build faster than this, only
+#   making the recipes along this path faster would help.
+#
+# - Aggregate cost of each tool across all recipes.
+#
+# - Parallelism achieved, which is total recipe time divided by elapsed
+#   wall time.
+#
+# Example:
+#
+#   make -j SHELL='perl profile_recipe.pl t_profile.log $@'
+#   perl generate_build_graph.pl --profile=t_profile.log Makefile > trace.json
 
 use strict;
 use Digest::MD5 qw(md5);
+use JSON::PP;
 
 # Convert HSL in the range of [0,6),[0,1],[0,1] to RGB [0,255],[0,255],[0,255]
 sub hsl_to_rgb($$$)
@@ -288,10 +308,208 @@ sub generate_graph($$$$)
    print "}\n";
 }
 
+# Load profile log written by profile_recipe.pl.  Returns a list of
+# recipe entries, sorted by start time.
+sub load_profile($)
+{
+   my ($filename) = @_;
+
+   my @entries = ();
+   open my $infile, "< $filename" or die "Can not read $filename: $!\n";
+   while( my $line = <$infile> )
+   {
+      chomp $line;
+      my @fields = split /\t/, $line, 7;
+      next unless scalar @fields == 7;
+      push @entries,
+      {
+         target => $fields[0],
+         start => $fields[1],
+         end => $fields[2],
+         user => $fields[3],
+         system => $fields[4],
+         rss => $fields[5],
+         command => $fields[6],
+      };
+   }
+   close $infile;
+   return sort {$a->{start} <=> $b->{start}} @entries;
+}
+
+# Get the name of the tool that does most of the work for a command.
+sub classify_command($)
+{
+   my ($command) = @_;
+
+   $command =~ s/^[\s\@-]+//;
+
+   # Attribute cached commands to the tool being cached.
+   if( $command =~ /^\S*cache_tool\.sh\s+'([^']*)'/ )
+   {
+      $command = $1;
+   }
+
+   my @words = split /\s+/, $command;
+   return "(empty)" unless scalar @words;
+   my $tool = $words[0];
+   if( ($tool eq "perl" || $tool eq "bash") && scalar @words > 1 &&
+       $words[1] !~ /^-/ )
+   {
+      $tool = $words[1];
+   }
+   $tool =~ s/^.*\///;
+   return $tool eq "svg_to_png.sh" ? "inkscape" : $tool;
+}
+
+sub critical_path($$$$$);
+
+# Find the longest chain of dependent recipes ending at target, with the
+# cost of each target being the sum of its recipe times.  Returns total
+# cost, and stores the chain in $$path{$target}.
+sub critical_path($$$$$)
+{
+   my ($target, $dependency, $cost, $path, $visiting) = @_;
+
+   return $$path{$target}[0] if exists $$path{$target};
+
+   # Treat circular dependencies as if they were not there, same as make.
+   return 0 if exists $$visiting{$target};
+   $$visiting{$target} = 1;
+
+   my $best_cost = 0;
+   my $best_dependency = undef;
+   foreach my $d (sort keys %{$$dependency{$target}})
+   {
+      my $c = critical_path($d, $dependency, $cost, $path, $visiting);
+      if( $c > $best_cost )
+      {
+         $best_cost = $c;
+         $best_dependency = $d;
+      }
+   }
+   delete $$visiting{$target};
+
+   my $total = $best_cost + ($$cost{$target} // 0);
+   my @chain = defined $best_dependency ? @{$$path{$best_dependency}[1]} : ();
+   push @chain, $target if exists $$cost{$target};
+   $$path{$target} = [$total, \@chain];
+   return $total;
+}
+
+# Write Chrome trace JSON to stdout, and profile summary to stderr.
+sub generate_profile($$$)
+{
+   my ($dependency, $entries, $targets) = @_;
+
+   if( !scalar @$entries )
+   {
+      die "No recipes found in profile\n";
+   }
+
+   my $build_start = $$entries[0]{start};
+   my $build_end = $build_start;
+   my %cost = ();
+   my %tool_wall = ();
+   my %tool_cpu = ();
+   my %tool_rss = ();
+   my %tool_count = ();
+   my $total_wall = 0;
+   my $total_cpu = 0;
+
+   # Assign each recipe to the first lane that is free at its start time,
+   # so that concurrent recipes show up as separate rows in the trace.
+   my @lane_end = ();
+   my @events = ();
+   foreach my $e (@$entries)
+   {
+      my $wall = $e->{end} - $e->{start};
+      my $cpu = $e->{user} + $e->{system};
+      my $tool = classify_command($e->{command});
+      $build_end = $e->{end} if $build_end < $e->{end};
+      $cost{$e->{target}} += $wall;
+      $tool_wall{$tool} += $wall;
+      $tool_cpu{$tool} += $cpu;
+      $tool_count{$tool}++;
+      if( ($tool_rss{$tool} // 0) < $e->{rss} )
+      {
+         $tool_rss{$tool} = $e->{rss};
+      }
+      $total_wall += $wall;
+      $total_cpu += $cpu;
+
+      my $lane = 0;
+      $lane++ while $lane < scalar @lane_end && $lane_end[$lane] > $e->{start};
+      $lane_end[$lane] = $e->{end};
+
+      push @events,
+      {
+         name => $e->{target},
+         cat => $tool,
+         ph => "X",
+         pid => 1,
+         tid => $lane,
+         ts => int(($e->{start} - $build_start) * 1e6),
+         dur => int($wall * 1e6),
+         args =>
+         {
+            command => $e->{command},
+            cpu_seconds => $cpu + 0,
+            peak_rss_kb => $e->{rss} + 0,
+         },
+      };
+   }
+   print JSON::PP->new->canonical->encode({traceEvents => \@events}), "\n";
+
+   # Output critical path.  If multiple targets are selected, report the
+   # longest of their critical paths.
+   my %path = ();
+   my $critical_target = undef;
+   foreach my $t (@$targets)
+   {
+      my $c = critical_path($t, $dependency, \%cost, \%path, {});
+      if( !defined($critical_target) || $c > $path{$critical_target}[0] )
+      {
+         $critical_target = $t;
+      }
+   }
+   my $elapsed = $build_end - $build_start;
+   printf STDERR "Critical path: %.3fs\n", $path{$critical_target}[0];
+   foreach my $t (@{$path{$critical_target}[1]})
+   {
+      printf STDERR "  %10.3fs  %s\n", $cost{$t}, $t;
+   }
+
+   # Output per-tool cost, most expensive first.
+   printf STDERR "\n%-24s %6s %11s %11s %10s\n",
+                 "Tool", "Count", "Wall", "CPU", "Peak RSS";
+   foreach my $tool (sort {$tool_wall{$b} <=> $tool_wall{$a} || $a cmp $b}
+                     keys %tool_wall)
+   {
+      printf STDERR "%-24s %6d %10.3fs %10.3fs %8dkB\n",
+                    $tool, $tool_count{$tool}, $tool_wall{$tool},
+                    $tool_cpu{$tool}, $tool_rss{$tool};
+   }
+
+   # Output achieved parallelism.
+   printf STDERR "\nElapsed: %.3fs\n" .
+                 "Total recipe wall time: %.3fs\n" .
+                 "Total recipe CPU time: %.3fs\n" .
+                 "Parallelism: %.2f (peak %d)\n",
+                 $elapsed, $total_wall, $total_cpu,
+                 $elapsed > 0 ? $total_wall / $elapsed : 1,
+                 scalar @lane_end;
+}
+
 
+my $profile = undef;
+if( $#ARGV >= 0 && $ARGV[0] =~ /^--profile=(.+)$/ )
+{
+   $profile = $1;
+   shift @ARGV;
+}
 if( $#ARGV < 0 )
 {
-   die "$0 {Makefile} [target...]\n";
+   die "$0 [--profile={log}] {Makefile} [target...]\n";
 }
 
 # Mapping from target name to when it first appeared in the input.
@@ -330,4 +548,12 @@ else
    }
 }
 
-generate_graph(\%index, \%dependency, \%actions, \@build_targets);
+if( defined $profile )
+{
+   my @entries = load_profile($profile);
+   generate_profile(\%dependency, \@entries, \@build_targets);
+}
+else
+{
+   generate_graph(\%index, \%dependency, \%actions, \@build_targets);
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/perl -w
+# Generate star placement tables for init_starfield and draw_starfield.
+#
+# STAR_CELLS holds one list of cell values for each of the 4 starfield
+# layers, with 32x32 cells per layer.  See init_starfield for how each
+# cell value is decoded into star variations for each animation frame.
+#
+# Cell values are derived from the same Jenkins hash that star_placement.c
+# uses for star locations, so that the starfield is the same on every
+# launch, and doesn't cost thousands of rand() calls at startup.
+#
+# STAR_LAYER_INDEX maps (global_frames // 2) & 15 to the tilemap index
+# for each of the 4 layers, see draw_starfield.
+
+use strict;
+use constant LAYER_COUNT => 4;
+use constant CELL_COUNT => 32 * 32;
+use constant CELLS_PER_LINE => 16;
+
+# Jenkins's one-at-a-time hash, same as Hash() in star_placement.c.
+sub jenkins_hash($)
+{
+   my ($bytes) = @_;
+
+   my $hash = 0;
+   foreach my $byte (unpack "C*", $bytes)
+   {
+      $hash = ($hash + $byte) & 0xffffffff;
+      $hash = ($hash + ($hash << 10)) & 0xffffffff;
+      $hash ^= $hash >> 6;
+   }
+   $hash = ($hash + ($hash << 3)) & 0xffffffff;
+   $hash ^= $hash >> 11;
+   $hash = ($hash + ($hash << 15)) & 0xffffffff;
+   return $hash;
+}
+
+# Hash two numbers, same as HashPair() in star_placement.c on little
+# endian machines with 32bit ints.
+sub hash_pair($$)
+{
+   my ($x, $y) = @_;
+   return jenkins_hash(pack "l<l<", $x, $y);
+}
+
+
+print "STAR_CELLS =\n{\n";
+for(my $layer = 0; $layer < LAYER_COUNT; $layer++)
+{
+   print "\t{\n";
+   for(my $i = 0; $i < CELL_COUNT; $i += CELLS_PER_LINE)
+   {
+      my @cells = ($i .. $i + CELLS_PER_LINE - 1);
+      print "\t\t",
+            (join ", ", map {hash_pair($layer, $_) & 0xfff} @cells),
+            ",\n";
+   }
+   print "\t},\n";
+}
+print "}\n";
+
+# Each set of 4 tilemaps (one set per layer) is advanced on a different
+# phase, so that no two layers change on the same frame.
+my @phase = (0, 2, 3, 1);
+print "STAR_LAYER_INDEX =\n{\n";
+for(my $base_frame = 0; $base_frame < 16; $base_frame++)
+{
+   print "\t{",
+         (join ", ",
+          map {((($base_frame + $phase[$_]) >> 2) & 3) + $_ * 4 + 1}
+              (0 .. LAYER_COUNT - 1)),
+         "},\n";
+}
+print "}\n";
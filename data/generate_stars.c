@@ -1,5 +1,13 @@
-/* Generate a set of star tiles. */
+/* Generate a set of star tiles.
 
+   Usage:
+
+      ./generate_stars [--preset={preset}] {output.png}
+
+   See png_encode.h for available presets.
+*/
+
+#include"png_encode.h"
 #include<png.h>
 #include<stdio.h>
 #include<stdlib.h>
@@ -36,14 +44,16 @@ int main(int argc, char **argv)
    int i, j, t;
    png_image image;
    png_bytep pixels;
+   PngPreset preset;
 
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
    if( argc != 2 )
-      return printf("%s {output.png}\n", *argv);
+      return printf("%s [--preset={preset}] {output.png}\n", *argv);
 
    /* Allocate output image and fill it with blank pixels. */
    memset(&image, 0, sizeof(image));
    image.version = PNG_IMAGE_VERSION;
-   image.flags |= PNG_IMAGE_FLAG_FAST;
    image.format = PNG_FORMAT_GA;
    image.width = IMAGE_WIDTH;
    image.height = IMAGE_HEIGHT;
@@ -91,9 +101,8 @@ int main(int argc, char **argv)
    }
 
    /* Write output. */
-   if( !png_image_write_to_file(&image, argv[1], 0, pixels, 0, NULL) )
+   if( SavePng(argv[1], IMAGE_WIDTH, IMAGE_HEIGHT, pixels, preset) != 0 )
    {
-      printf("Error writing %s\n", argv[1]);
       free(pixels);
       return 1;
    }
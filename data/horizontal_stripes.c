@@ -2,13 +2,13 @@
 
    Usage:
 
-      ./horizontal_stripes < {input1.png} > {output.png}
+      ./horizontal_stripes [--preset={preset}] < {input1.png} > {output.png}
+
+   See png_encode.h for available presets.
 */
 
-#include<png.h>
+#include"bitplane.h"
 #include<stdio.h>
-#include<stdlib.h>
-#include<string.h>
 #include<unistd.h>
 
 #ifdef _WIN32
@@ -18,12 +18,17 @@
 
 int main(int argc, char **argv)
 {
-   png_image image;
-   png_bytep pixels;
-   int y;
+   Bitplane image;
+   PngPreset preset;
+   int status;
 
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
    if( argc != 1 )
-      return printf("%s < {input.png} > {output.png}\n", *argv);
+   {
+      return printf("%s [--preset={preset}] < {input1.png} > {output.png}\n",
+                    *argv);
+   }
 
    if( isatty(STDOUT_FILENO) )
    {
@@ -37,43 +42,14 @@ int main(int argc, char **argv)
    #endif
 
    /* Load input. */
-   memset(&image, 0, sizeof(image));
-   image.version = PNG_IMAGE_VERSION;
-   if( !png_image_begin_read_from_stdio(&image, stdin) )
-   {
-      fputs("Read error\n", stderr);
+   if( LoadBitplane("-", 0, &image) != 0 )
       return 1;
-   }
-
-   image.format = PNG_FORMAT_GA;
-   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   if( pixels == NULL )
-   {
-      fputs("Out of memory\n", stderr);
-      return 1;
-   }
-   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
-   {
-      fputs("Load error\n", stderr);
-      return 1;
-   }
 
    /* Remove every other line. */
-   for(y = 1; y < (int)(image.height); y += 2)
-      memset(pixels + y * image.width * 2, 0, image.width * 2);
-
-   /* Write output.  Here we set the flags to optimize for encoding speed
-      rather than output size so that we can iterate faster.  This is fine
-      since the output of this tool are intermediate files that are used
-      only in the build process, and are not the final PNGs that will be
-      committed.                                                           */
-   image.flags |= PNG_IMAGE_FLAG_FAST;
-   if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
-   {
-      fputs("Write error\n", stderr);
-      return 1;
-   }
+   EraseOddBitplaneRows(&image);
 
-   free(pixels);
-   return 0;
+   /* Write output. */
+   status = SaveBitplane("-", &image, preset);
+   FreeBitplane(&image);
+   return status;
 }
@@ -0,0 +1,455 @@
+/* Desktop benchmark for image kernels.
+
+   Usage:
+
+      ./image_bench.exe [{max_size}]
+
+   This runs each kernel from image_ops.h, bitplane.h, tile_occupancy.h,
+   and star_placement.h on synthetic images of a few fixed sizes, up to
+   {max_size} pixels on either side (default 8192).  Images are generated
+   from a fixed seed, so results are comparable across runs and across
+   changes to the kernels.  Only the kernels themselves are timed, there
+   is no PNG encoding or decoding involved.
+
+   Each image is divided into 8x8 blocks, and each block is opaque with
+   the probability given by density.  Opaque pixels have random gray
+   values.  This roughly approximates our sprite tables, which are mostly
+   made of empty cells.
+
+   Output is tab-separated, one line per kernel, image size, and density,
+   with a header line listing the column names.  Throughput is measured
+   in megapixels per second.  For StackBitplanes, each overlay counts as
+   a separate set of pixels processed.
+
+   PlaceStars allocates several times the image size in scratch space, so
+   it's only run on the smaller images.
+*/
+
+#include<stdint.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"bitplane.h"
+#include"image_ops.h"
+#include"star_placement.h"
+#include"tile_occupancy.h"
+
+/* Run each kernel for at least this many nanoseconds, to reduce noise
+   from the smaller images.                                              */
+#define MIN_BENCH_TIME   200000000u
+
+/* Cell size for CropTilesInPlace and InitOccupancy, matching the star
+   table.  All image sizes must be multiples of this.                    */
+#define TILE_SIZE        32
+#define CROP_SIZE        24
+
+/* Minimum distance between stars for PlaceStars, matching add_starfield. */
+#define STAR_RADIUS      12
+
+/* Largest image size for PlaceStars. */
+#define MAX_STAR_PIXELS  (4096 * 1024)
+
+/* Number of overlays for StackBitplanes. */
+#define OVERLAY_COUNT    4
+
+#define BLOCK_SIZE       8
+
+typedef struct
+{
+   /* Image header, and pristine copy of pixels. */
+   png_image image;
+   png_bytep source;
+
+   /* Scratch copy of pixels, for kernels that operate in-place. */
+   png_bytep pixels;
+
+   /* Black and white version of the same image and overlays. */
+   Bitplane bitplane;
+   Bitplane overlays[OVERLAY_COUNT];
+   png_bytep overlay_pixels;
+} Fixture;
+
+typedef struct
+{
+   const char *name;
+
+   /* Run kernel once.  Returns time spent in the kernel in nanoseconds,
+      or 0 on failure.  Setup time is not included.                      */
+   uint64_t (*run)(Fixture *fixture);
+
+   /* Number of pixels processed per run, relative to image size. */
+   int pixel_multiplier;
+
+   /* Kernel is skipped for images larger than this many pixels, or never
+      skipped if this is zero.                                           */
+   int max_pixels;
+} Kernel;
+
+static const int kSizes[][2] =
+{
+   {512, 192},
+   {1536, 640},
+   {4096, 1024},
+   {8192, 8192},
+};
+
+static const double kDensities[] = {0.01, 0.25, 1.0};
+
+/* Get time in nanoseconds. */
+static uint64_t Now(void)
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* Deterministic random number generator (xorshift32). */
+static uint32_t Random(uint32_t *state)
+{
+   *state ^= *state << 13;
+   *state ^= *state >> 17;
+   *state ^= *state << 5;
+   return *state;
+}
+
+/* Fill GA pixels with random opaque blocks. */
+static void GeneratePixels(int width, int height, double density,
+                           uint32_t seed, png_bytep pixels)
+{
+   const uint32_t threshold = (uint32_t)(density * 4294967295.0);
+   uint32_t state = seed;
+   int bx, by, x, y;
+   png_bytep p;
+
+   memset(pixels, 0, width * height * 2);
+   for(by = 0; by < height; by += BLOCK_SIZE)
+   {
+      for(bx = 0; bx < width; bx += BLOCK_SIZE)
+      {
+         if( Random(&state) > threshold )
+            continue;
+         for(y = by; y < by + BLOCK_SIZE && y < height; y++)
+         {
+            p = pixels + (y * width + bx) * 2;
+            for(x = bx; x < bx + BLOCK_SIZE && x < width; x++)
+            {
+               *p++ = (png_byte)(Random(&state) >> 24);
+               *p++ = 255;
+            }
+         }
+      }
+   }
+}
+
+/* Convert GA pixels to bitplane, treating gray values above 127 as
+   white and nonzero alpha as opaque.                                    */
+static void ConvertToBitplane(int width, int height, png_const_bytep pixels,
+                              Bitplane *image)
+{
+   int x, y;
+
+   for(y = 0; y < height; y++)
+   {
+      for(x = 0; x < width; x++, pixels += 2)
+         SetBitplanePixel(image, x, y, pixels[0] > 127, pixels[1] != 0);
+   }
+}
+
+/* Release fixture memory. */
+static void FreeFixture(Fixture *fixture)
+{
+   int i;
+
+   free(fixture->source);
+   free(fixture->pixels);
+   free(fixture->overlay_pixels);
+   FreeBitplane(&fixture->bitplane);
+   for(i = 0; i < OVERLAY_COUNT; i++)
+      FreeBitplane(&fixture->overlays[i]);
+}
+
+/* Generate all input images.  Returns 0 on success. */
+static int InitFixture(int width, int height, double density,
+                       Fixture *fixture)
+{
+   const size_t size = (size_t)width * height * 2;
+   int i, status = 0;
+
+   memset(fixture, 0, sizeof(Fixture));
+   fixture->image.version = PNG_IMAGE_VERSION;
+   fixture->image.format = PNG_FORMAT_GA;
+   fixture->image.width = width;
+   fixture->image.height = height;
+
+   fixture->source = (png_bytep)malloc(size);
+   fixture->pixels = (png_bytep)malloc(size);
+   fixture->overlay_pixels = (png_bytep)malloc(size);
+   if( fixture->source == NULL || fixture->pixels == NULL ||
+       fixture->overlay_pixels == NULL )
+   {
+      FreeFixture(fixture);
+      return 1;
+   }
+   status |= AllocBitplane(&fixture->bitplane, width, height);
+   for(i = 0; i < OVERLAY_COUNT; i++)
+      status |= AllocBitplane(&fixture->overlays[i], width, height);
+   if( status != 0 )
+   {
+      FreeFixture(fixture);
+      return 1;
+   }
+
+   GeneratePixels(width, height, density, 1, fixture->source);
+   ConvertToBitplane(width, height, fixture->source, &fixture->bitplane);
+
+   /* Overlays are black and white, so that StackPixels sees the same
+      kind of input as stack_bw.  The last overlay is kept in 8bit form
+      for StackPixels.                                                   */
+   for(i = 0; i < OVERLAY_COUNT; i++)
+   {
+      GeneratePixels(width, height, density, i + 2, fixture->overlay_pixels);
+      ConvertToBitplane(width, height, fixture->overlay_pixels,
+                        &fixture->overlays[i]);
+   }
+   OrderedDither(&fixture->image, fixture->overlay_pixels);
+   return 0;
+}
+
+/* Restore scratch pixels and image header from pristine copy. */
+static void ResetPixels(Fixture *fixture)
+{
+   fixture->image.width = fixture->bitplane.width;
+   fixture->image.height = fixture->bitplane.height;
+   memcpy(fixture->pixels, fixture->source,
+          (size_t)fixture->image.width * fixture->image.height * 2);
+}
+
+static uint64_t RunOrderedDither(Fixture *fixture)
+{
+   uint64_t start;
+
+   ResetPixels(fixture);
+   start = Now();
+   OrderedDither(&fixture->image, fixture->pixels);
+   return Now() - start;
+}
+
+static uint64_t RunFloydSteinbergDither(Fixture *fixture)
+{
+   uint64_t start, end;
+
+   ResetPixels(fixture);
+   start = Now();
+   if( FloydSteinbergDither(&fixture->image, fixture->pixels) != 0 )
+      return 0;
+   end = Now();
+   return end - start;
+}
+
+static uint64_t RunCropTilesInPlace(Fixture *fixture)
+{
+   const int offset = (TILE_SIZE - CROP_SIZE) / 2;
+   uint64_t start;
+
+   ResetPixels(fixture);
+   start = Now();
+   CropTilesInPlace(&fixture->image, fixture->pixels,
+                    TILE_SIZE, TILE_SIZE, CROP_SIZE, CROP_SIZE,
+                    offset, offset);
+   return Now() - start;
+}
+
+static uint64_t RunCropTiles(Fixture *fixture)
+{
+   const int offset = (TILE_SIZE - CROP_SIZE) / 2;
+   uint64_t start;
+
+   ResetPixels(fixture);
+   start = Now();
+   CropTiles(&fixture->image, fixture->source, fixture->pixels,
+             TILE_SIZE, TILE_SIZE, CROP_SIZE, CROP_SIZE, offset, offset);
+   return Now() - start;
+}
+
+static uint64_t RunStackPixels(Fixture *fixture)
+{
+   uint64_t start;
+
+   ResetPixels(fixture);
+   start = Now();
+   StackPixels(&fixture->image, fixture->pixels, fixture->overlay_pixels);
+   return Now() - start;
+}
+
+static uint64_t RunStackBitplanes(Fixture *fixture)
+{
+   const Bitplane *overlays[OVERLAY_COUNT];
+   Bitplane output = fixture->bitplane;
+   uint64_t start;
+   int i;
+
+   /* Stack on top of the first overlay so that the pristine bitplane is
+      left untouched.  CopyBitplane is not timed.                        */
+   for(i = 0; i < OVERLAY_COUNT; i++)
+      overlays[i] = &fixture->overlays[i];
+   output.color = (uint64_t*)fixture->pixels;
+   output.alpha = output.color + (size_t)output.stride * output.height;
+   CopyBitplane(&fixture->bitplane, &output);
+
+   start = Now();
+   StackBitplanes(&output, overlays, OVERLAY_COUNT);
+   return Now() - start;
+}
+
+static uint64_t RunEraseOddBitplaneRows(Fixture *fixture)
+{
+   Bitplane output = fixture->bitplane;
+   uint64_t start;
+
+   output.color = (uint64_t*)fixture->pixels;
+   output.alpha = output.color + (size_t)output.stride * output.height;
+   CopyBitplane(&fixture->bitplane, &output);
+
+   start = Now();
+   EraseOddBitplaneRows(&output);
+   return Now() - start;
+}
+
+static uint64_t RunShrinkTiles(Fixture *fixture)
+{
+   Occupancy occupancy;
+   Box box, cell;
+   uint64_t start, end;
+   int tile_x, tile_y;
+
+   /* Same sequence of calls as shrink_tiles, minus the output. */
+   start = Now();
+   if( InitOccupancy(&fixture->bitplane, TILE_SIZE, TILE_SIZE,
+                     &occupancy) != 0 )
+   {
+      return 0;
+   }
+   box.x0 = box.y0 = 0;
+   box.x1 = box.y1 = -1;
+   for(tile_y = 0; tile_y < occupancy.tiles_y; tile_y++)
+   {
+      for(tile_x = 0; tile_x < occupancy.tiles_x; tile_x++)
+      {
+         GetCellBox(&occupancy, tile_x, tile_y, &cell);
+         AddBox(&cell, &box);
+      }
+   }
+   end = Now();
+   FreeOccupancy(&occupancy);
+   return end - start;
+}
+
+static uint64_t RunPlaceStars(Fixture *fixture)
+{
+   Bitplane output = fixture->bitplane;
+   uint64_t start, end;
+   XY *stars;
+
+   /* PlaceStars draws to its input, so run it on a scratch copy. */
+   output.color = (uint64_t*)fixture->pixels;
+   output.alpha = output.color + (size_t)output.stride * output.height;
+   CopyBitplane(&fixture->bitplane, &output);
+
+   start = Now();
+   if( PlaceStars(&output, STAR_RADIUS, &stars) < 0 )
+      return 0;
+   end = Now();
+   free(stars);
+   return end - start;
+}
+
+static const Kernel kKernels[] =
+{
+   {"OrderedDither", RunOrderedDither, 1, 0},
+   {"FloydSteinbergDither", RunFloydSteinbergDither, 1, 0},
+   {"CropTilesInPlace", RunCropTilesInPlace, 1, 0},
+   {"CropTiles", RunCropTiles, 1, 0},
+   {"StackPixels", RunStackPixels, 1, 0},
+   {"StackBitplanes", RunStackBitplanes, OVERLAY_COUNT, 0},
+   {"EraseOddBitplaneRows", RunEraseOddBitplaneRows, 1, 0},
+   {"ShrinkTiles", RunShrinkTiles, 1, 0},
+   {"PlaceStars", RunPlaceStars, 1, MAX_STAR_PIXELS},
+};
+
+/* Run a single kernel repeatedly, and output throughput.  Returns 0 on
+   success.                                                              */
+static int RunKernel(const Kernel *kernel, Fixture *fixture, double density)
+{
+   const double pixels = (double)fixture->bitplane.width *
+                         fixture->bitplane.height *
+                         kernel->pixel_multiplier;
+   uint64_t total = 0, elapsed;
+   int iterations = 0;
+
+   if( kernel->max_pixels > 0 &&
+       (double)fixture->bitplane.width * fixture->bitplane.height >
+       kernel->max_pixels )
+   {
+      return 0;
+   }
+   do
+   {
+      elapsed = kernel->run(fixture);
+      if( elapsed == 0 )
+      {
+         fprintf(stderr, "%s: failed\n", kernel->name);
+         return 1;
+      }
+      total += elapsed;
+      iterations++;
+   } while( total < MIN_BENCH_TIME );
+
+   printf("%s\t%d\t%d\t%.2f\t%d\t%.0f\t%.1f\n",
+          kernel->name, fixture->bitplane.width, fixture->bitplane.height,
+          density, iterations, (double)total / iterations,
+          pixels * iterations / (total / 1e3));
+   return 0;
+}
+
+int main(int argc, char **argv)
+{
+   Fixture fixture;
+   int max_size, size, density, kernel, failures = 0;
+
+   max_size = argc > 1 ? atoi(argv[1]) : 8192;
+   if( argc > 2 || max_size < kSizes[0][0] )
+   {
+      printf("%s [{max_size}]\n", *argv);
+      return 1;
+   }
+
+   printf("kernel\twidth\theight\tdensity\titerations\tns_per_iteration\t"
+          "mpix_per_second\n");
+   for(size = 0; size < (int)(sizeof(kSizes) / sizeof(kSizes[0])); size++)
+   {
+      if( kSizes[size][0] > max_size || kSizes[size][1] > max_size )
+         break;
+      for(density = 0;
+          density < (int)(sizeof(kDensities) / sizeof(kDensities[0]));
+          density++)
+      {
+         if( InitFixture(kSizes[size][0], kSizes[size][1],
+                         kDensities[density], &fixture) != 0 )
+         {
+            fputs("Out of memory\n", stderr);
+            return 1;
+         }
+         for(kernel = 0;
+             kernel < (int)(sizeof(kKernels) / sizeof(kKernels[0]));
+             kernel++)
+         {
+            failures += RunKernel(&kKernels[kernel], &fixture,
+                                  kDensities[density]);
+         }
+         fflush(stdout);
+         FreeFixture(&fixture);
+      }
+   }
+   return failures > 0 ? 1 : 0;
+}
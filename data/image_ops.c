@@ -0,0 +1,604 @@
+/* Pixel operations on 8bit grayscale plus 8bit alpha images.
+
+   See image_ops.h for descriptions.
+*/
+
+#include"image_ops.h"
+#include<pthread.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+/* Upper bound on number of threads used by ForEachRowBand. */
+#define MAX_BAND_THREADS   64
+
+/* Arguments for a single thread in ForEachRowBand. */
+typedef struct
+{
+   void (*func)(void *, int, int);
+   void *context;
+   int start, end;
+} RowBand;
+
+/* Arguments for CropTiles. */
+typedef struct
+{
+   const png_image *image;
+   png_const_bytep pixels;
+   png_bytep output;
+   int w0, h0, w1, h1, x, y;
+} CropTilesContext;
+
+/* https://en.wikipedia.org/wiki/Ordered_dithering */
+#if 0
+   #define PATTERN_SIZE 4
+   static const int pattern[PATTERN_SIZE][PATTERN_SIZE] =
+   {
+      { 0,  8,  2, 10},
+      {12,  4, 14,  6},
+      { 3, 11,  1,  9},
+      {15,  7, 13,  5}
+   };
+#else
+   #define PATTERN_SIZE 8
+   static const int pattern[PATTERN_SIZE][PATTERN_SIZE] =
+   {
+      { 0, 32,  8, 40,  2, 34, 10, 42},
+      {48, 16, 56, 24, 50, 18, 58, 26},
+      {12, 44,  4, 36, 14, 46,  6, 38},
+      {60, 28, 52, 20, 62, 30, 54, 22},
+      { 3, 35, 11, 43,  1, 33,  9, 41},
+      {51, 19, 59, 27, 49, 17, 57, 25},
+      {15, 47,  7, 39, 13, 45,  5, 37},
+      {63, 31, 55, 23, 61, 29, 53, 21}
+   };
+#endif
+
+/* Reference implementation of ordered dither for a single value. */
+static unsigned char Dither(int x, int y, int v)
+{
+   v += pattern[y % PATTERN_SIZE][x % PATTERN_SIZE] * 255 /
+        (PATTERN_SIZE * PATTERN_SIZE) - 127;
+   return v > 127 ? 255 : 0;
+}
+
+/* Reference implementation of OrderedDither, one pixel at a time. */
+static void OrderedDitherReference(const png_image *image, png_bytep pixels)
+{
+   png_bytep p = pixels;
+   int x, y;
+
+   for(y = 0; y < (int)image->height; y++)
+   {
+      for(x = 0; x < (int)image->width; x++, p += 2)
+      {
+         /* Dither color and alpha independently. */
+         *p = Dither(x, y, (int)*p);
+         *(p + 1) = Dither(x, y, (int)*(p + 1));
+
+         /* Set color part to zero if alpha is zero. */
+         if( *(p + 1) == 0 )
+            *p = 0;
+      }
+   }
+}
+
+/* Precomputed thresholds, one row per scanline of the dither pattern.
+
+   Dither(x, y, v) returns 255 if and only if v is greater than
+   254 - pattern[y][x] * 255 / 64, so each input byte only needs a single
+   unsigned comparison against this table.  Each threshold is repeated
+   twice so that the table lines up with interleaved gray+alpha bytes,
+   and each row covers 16 pixels so that vector kernels can load 16 or
+   32 bytes at a time without having to handle pattern wraparound.      */
+#define THRESHOLD_ROW_SIZE 32
+static unsigned char threshold[PATTERN_SIZE][THRESHOLD_ROW_SIZE];
+static int threshold_ready = 0;
+
+static void InitThreshold(void)
+{
+   int x, y;
+
+   if( threshold_ready )
+      return;
+   for(y = 0; y < PATTERN_SIZE; y++)
+   {
+      for(x = 0; x < THRESHOLD_ROW_SIZE; x++)
+      {
+         threshold[y][x] = (unsigned char)
+            (254 - pattern[y][(x / 2) % PATTERN_SIZE] * 255 /
+                   (PATTERN_SIZE * PATTERN_SIZE));
+      }
+   }
+   threshold_ready = 1;
+}
+
+/* Dither part of a scanline, starting at a pixel offset that is a
+   multiple of THRESHOLD_ROW_SIZE/2.  Size is in bytes.                */
+static void DitherRowScalar(png_bytep p, int size, const unsigned char *t)
+{
+   int i;
+
+   for(i = 0; i + 1 < size; i += 2)
+   {
+      p[i + 1] = p[i + 1] > t[i % THRESHOLD_ROW_SIZE + 1] ? 255 : 0;
+      p[i] = p[i] > t[i % THRESHOLD_ROW_SIZE] ? p[i + 1] : 0;
+   }
+}
+
+/* Vector kernels.  These all compare whole registers of interleaved
+   gray+alpha bytes against the threshold row, then AND each gray byte
+   with the alpha byte that follows it, which implements the "color is
+   zero where alpha is zero" rule.  Leftover pixels are handled by the
+   scalar kernel.
+
+   x86 kernels are compiled with target attributes and selected at run
+   time, so that the same binary works on hosts without AVX2.           */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   #define HAVE_X86_KERNELS
+   #include<immintrin.h>
+
+   __attribute__((target("sse2")))
+   static void DitherRowSSE2(png_bytep p, int size, const unsigned char *t)
+   {
+      const __m128i bias = _mm_set1_epi8((char)0x80);
+      const __m128i alpha_lanes = _mm_set1_epi16((short)0xff00);
+      const __m128i tv = _mm_xor_si128(
+         _mm_loadu_si128((const __m128i*)t), bias);
+      __m128i v, r;
+      int i;
+
+      for(i = 0; i + 16 <= size; i += 16)
+      {
+         v = _mm_loadu_si128((const __m128i*)(p + i));
+         r = _mm_cmpgt_epi8(_mm_xor_si128(v, bias), tv);
+         r = _mm_and_si128(r, _mm_or_si128(_mm_srli_epi16(r, 8),
+                                           alpha_lanes));
+         _mm_storeu_si128((__m128i*)(p + i), r);
+      }
+      DitherRowScalar(p + i, size - i, t);
+   }
+
+   __attribute__((target("avx2")))
+   static void DitherRowAVX2(png_bytep p, int size, const unsigned char *t)
+   {
+      const __m256i bias = _mm256_set1_epi8((char)0x80);
+      const __m256i alpha_lanes = _mm256_set1_epi16((short)0xff00);
+      const __m256i tv = _mm256_xor_si256(
+         _mm256_loadu_si256((const __m256i*)t), bias);
+      __m256i v, r;
+      int i;
+
+      for(i = 0; i + 32 <= size; i += 32)
+      {
+         v = _mm256_loadu_si256((const __m256i*)(p + i));
+         r = _mm256_cmpgt_epi8(_mm256_xor_si256(v, bias), tv);
+         r = _mm256_and_si256(r, _mm256_or_si256(_mm256_srli_epi16(r, 8),
+                                                 alpha_lanes));
+         _mm256_storeu_si256((__m256i*)(p + i), r);
+      }
+      DitherRowSSE2(p + i, size - i, t);
+   }
+#endif
+
+#ifdef __ARM_NEON
+   #include<arm_neon.h>
+
+   static void DitherRowNEON(png_bytep p, int size, const unsigned char *t)
+   {
+      const uint8x16_t tv = vld1q_u8(t);
+      const uint16x8_t alpha_lanes = vdupq_n_u16(0xff00);
+      uint8x16_t r;
+      uint16x8_t r16;
+      int i;
+
+      for(i = 0; i + 16 <= size; i += 16)
+      {
+         r = vcgtq_u8(vld1q_u8(p + i), tv);
+         r16 = vreinterpretq_u16_u8(r);
+         r16 = vandq_u16(r16, vorrq_u16(vshrq_n_u16(r16, 8), alpha_lanes));
+         vst1q_u8(p + i, vreinterpretq_u8_u16(r16));
+      }
+      DitherRowScalar(p + i, size - i, t);
+   }
+#endif
+
+typedef void (*DitherRowFunc)(png_bytep, int, const unsigned char*);
+
+typedef struct
+{
+   const char *name;
+   DitherRowFunc func;
+} DitherKernel;
+
+/* Collect all kernels supported by the current host, fastest first.
+   Returns number of kernels written to output array, which must have
+   room for at least 4 entries.                                         */
+static int GetDitherKernels(DitherKernel *kernels)
+{
+   int count = 0;
+
+   #ifdef HAVE_X86_KERNELS
+      __builtin_cpu_init();
+      if( __builtin_cpu_supports("avx2") )
+      {
+         kernels[count].name = "avx2";
+         kernels[count++].func = DitherRowAVX2;
+      }
+      if( __builtin_cpu_supports("sse2") )
+      {
+         kernels[count].name = "sse2";
+         kernels[count++].func = DitherRowSSE2;
+      }
+   #endif
+   #ifdef __ARM_NEON
+      kernels[count].name = "neon";
+      kernels[count++].func = DitherRowNEON;
+   #endif
+   kernels[count].name = "scalar";
+   kernels[count++].func = DitherRowScalar;
+   return count;
+}
+
+static void OrderedDitherWithKernel(const png_image *image,
+                                    png_bytep pixels,
+                                    DitherRowFunc dither_row)
+{
+   const int row_size = (int)image->width * 2;
+   int y;
+
+   InitThreshold();
+   for(y = 0; y < (int)image->height; y++)
+      dither_row(pixels + y * row_size, row_size, threshold[y % PATTERN_SIZE]);
+}
+
+void OrderedDither(const png_image *image, png_bytep pixels)
+{
+   static DitherRowFunc dither_row = NULL;
+   DitherKernel kernels[4];
+
+   if( dither_row == NULL )
+   {
+      GetDitherKernels(kernels);
+      dither_row = kernels[0].func;
+   }
+   OrderedDitherWithKernel(image, pixels, dither_row);
+}
+
+int OrderedDitherSelfTest(void)
+{
+   DitherKernel kernels[4];
+   png_image image;
+   png_bytep input, expected, actual;
+   unsigned int seed = 1;
+   int kernel_count, k, width, height, i, size, failed = 0;
+
+   /* Widths cover everything from single pixels to a few full vector
+      registers plus leftovers, heights cover a full pattern cycle plus
+      a partial one.                                                    */
+   size = 67 * 11 * 2;
+   input = (png_bytep)malloc(size);
+   expected = (png_bytep)malloc(size);
+   actual = (png_bytep)malloc(size);
+   if( input == NULL || expected == NULL || actual == NULL )
+   {
+      free(input);
+      free(expected);
+      free(actual);
+      return 1;
+   }
+
+   kernel_count = GetDitherKernels(kernels);
+   memset(&image, 0, sizeof(image));
+   for(width = 1; width <= 67; width++)
+   {
+      for(height = 1; height <= 11; height += 5)
+      {
+         image.width = width;
+         image.height = height;
+         size = width * height * 2;
+         for(i = 0; i < size; i++)
+         {
+            /* Mix in the extreme values explicitly, since those are the
+               ones most likely to trip up signed comparisons.           */
+            seed = seed * 1103515245u + 12345u;
+            switch( (seed >> 16) & 7 )
+            {
+               case 0:  input[i] = 0;   break;
+               case 1:  input[i] = 255; break;
+               case 2:  input[i] = 127; break;
+               case 3:  input[i] = 128; break;
+               default: input[i] = (unsigned char)(seed >> 20); break;
+            }
+         }
+         memcpy(expected, input, size);
+         OrderedDitherReference(&image, expected);
+
+         for(k = 0; k < kernel_count; k++)
+         {
+            memcpy(actual, input, size);
+            OrderedDitherWithKernel(&image, actual, kernels[k].func);
+            if( memcmp(expected, actual, size) != 0 )
+            {
+               fprintf(stderr, "%s kernel mismatch at %dx%d\n",
+                       kernels[k].name, width, height);
+               failed = 1;
+            }
+         }
+      }
+   }
+
+   free(input);
+   free(expected);
+   free(actual);
+   return failed;
+}
+
+/* Dither a single channel of one scanline with Floyd-Steinberg.
+   row_error[0] holds error propagated to current scanline, and
+   row_error[1] collects error for the next scanline.                 */
+static void DitherChannelRow(int *row_error[2], int width, png_bytep p)
+{
+   int x, i, o, e;
+
+   /* Reset error for next scanline. */
+   memset(row_error[1], 0, (width + 2) * sizeof(int));
+
+   /* Dither a single scanline. */
+   for(x = 0; x < width; x++, p += 2)
+   {
+      /* i = intended grayscale level. */
+      i = *p + row_error[0][x + 1] / 16;
+
+      /* o = output grayscale level. */
+      o = i > 127 ? 255 : 0;
+      *p = o;
+
+      /* Propagate error. */
+      e = i - o;
+      row_error[0][x + 2] += e * 7;
+      row_error[1][x    ] += e * 3;
+      row_error[1][x + 1] += e * 5;
+      row_error[1][x + 2] += e;
+   }
+}
+
+int InitFloydSteinberg(FloydSteinbergState *state, int width)
+{
+   int i;
+
+   state->width = width;
+   for(i = 0; i < 4; i++)
+      state->row_error[i] = (int*)calloc(width + 2, sizeof(int));
+   for(i = 0; i < 4; i++)
+   {
+      if( state->row_error[i] == NULL )
+      {
+         FreeFloydSteinberg(state);
+         return 1;
+      }
+   }
+   return 0;
+}
+
+void FloydSteinbergDitherRow(FloydSteinbergState *state, png_bytep row)
+{
+   int *swap, x;
+
+   /* Dither color and alpha channel independently. */
+   DitherChannelRow(state->row_error, state->width, row);
+   DitherChannelRow(state->row_error + 2, state->width, row + 1);
+   swap = state->row_error[0];
+   state->row_error[0] = state->row_error[1];
+   state->row_error[1] = swap;
+   swap = state->row_error[2];
+   state->row_error[2] = state->row_error[3];
+   state->row_error[3] = swap;
+
+   /* Set color to zero if the corresponding alpha is zero. */
+   for(x = 0; x < state->width; x++, row += 2)
+   {
+      if( *(row + 1) == 0 )
+         *row = 0;
+   }
+}
+
+void FreeFloydSteinberg(FloydSteinbergState *state)
+{
+   int i;
+
+   for(i = 0; i < 4; i++)
+   {
+      free(state->row_error[i]);
+      state->row_error[i] = NULL;
+   }
+}
+
+int FloydSteinbergDither(const png_image *image, png_bytep pixels)
+{
+   FloydSteinbergState state;
+   int y;
+
+   if( InitFloydSteinberg(&state, (int)image->width) != 0 )
+      return 1;
+   for(y = 0; y < (int)image->height; y++)
+      FloydSteinbergDitherRow(&state, pixels + y * image->width * 2);
+   FreeFloydSteinberg(&state);
+   return 0;
+}
+
+void CropRegionInPlace(png_image *image, png_bytep pixels,
+                       int width, int height, int x, int y)
+{
+   int i;
+
+   for(i = 0; i < height; i++)
+   {
+      memmove(pixels + i * width * 2,
+              pixels + ((y + i) * image->width + x) * 2,
+              width * 2);
+   }
+   image->width = width;
+   image->height = height;
+}
+
+void CropTilesInPlace(png_image *image, png_bytep pixels,
+                      int w0, int h0, int w1, int h1, int x, int y)
+{
+   int tile_x, tile_y, cell_y;
+   png_bytep r, w = pixels;
+
+   for(tile_y = 0; tile_y < (int)(image->height) / h0; tile_y++)
+   {
+      for(cell_y = 0; cell_y < h1; cell_y++)
+      {
+         for(tile_x = 0; tile_x < (int)(image->width) / w0; tile_x++)
+         {
+            r = pixels +
+                2 * ((tile_y * h0 + cell_y + y) * image->width +
+                     (tile_x * w0 + x));
+            memmove(w, r, w1 * 2);
+            w += w1 * 2;
+         }
+      }
+   }
+   image->width = (image->width / w0) * w1;
+   image->height = (image->height / h0) * h1;
+}
+
+/* Crop tile rows [start, end) for CropTiles. */
+static void CropTileRows(void *arg, int start, int end)
+{
+   const CropTilesContext *c = (const CropTilesContext*)arg;
+   const int columns = (int)(c->image->width) / c->w0;
+   int tile_x, tile_y, cell_y;
+   png_const_bytep r;
+   png_bytep w;
+
+   w = c->output + (size_t)start * c->h1 * columns * c->w1 * 2;
+   for(tile_y = start; tile_y < end; tile_y++)
+   {
+      for(cell_y = 0; cell_y < c->h1; cell_y++)
+      {
+         for(tile_x = 0; tile_x < columns; tile_x++)
+         {
+            r = c->pixels +
+                2 * ((size_t)(tile_y * c->h0 + cell_y + c->y) *
+                     c->image->width +
+                     (tile_x * c->w0 + c->x));
+            memcpy(w, r, c->w1 * 2);
+            w += c->w1 * 2;
+         }
+      }
+   }
+}
+
+void CropTiles(png_image *image, png_const_bytep pixels, png_bytep output,
+               int w0, int h0, int w1, int h1, int x, int y)
+{
+   CropTilesContext context;
+
+   context.image = image;
+   context.pixels = pixels;
+   context.output = output;
+   context.w0 = w0;
+   context.h0 = h0;
+   context.w1 = w1;
+   context.h1 = h1;
+   context.x = x;
+   context.y = y;
+   ForEachRowBand((int)(image->height) / h0, CropTileRows, &context);
+
+   image->width = (image->width / w0) * w1;
+   image->height = (image->height / h0) * h1;
+}
+
+/* Thread entry point for ForEachRowBand. */
+static void *RowBandWorker(void *arg)
+{
+   const RowBand *band = (const RowBand*)arg;
+   band->func(band->context, band->start, band->end);
+   return NULL;
+}
+
+void ForEachRowBand(int height, void (*func)(void *, int, int),
+                    void *context)
+{
+   pthread_t threads[MAX_BAND_THREADS];
+   RowBand bands[MAX_BAND_THREADS];
+   long cpu_count;
+   int band_count, thread_count, i;
+
+   cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+   band_count = cpu_count < 1 ? 1 :
+                cpu_count > MAX_BAND_THREADS ? MAX_BAND_THREADS :
+                (int)cpu_count;
+   if( band_count > height )
+      band_count = height;
+   if( band_count <= 1 )
+   {
+      if( height > 0 )
+         func(context, 0, height);
+      return;
+   }
+
+   for(i = 0; i < band_count; i++)
+   {
+      bands[i].func = func;
+      bands[i].context = context;
+      bands[i].start = (int)((long long)height * i / band_count);
+      bands[i].end = (int)((long long)height * (i + 1) / band_count);
+   }
+
+   /* Start threads for all but the last band, which is processed by the
+      current thread.                                                    */
+   for(thread_count = 0; thread_count < band_count - 1; thread_count++)
+   {
+      if( pthread_create(&threads[thread_count], NULL, RowBandWorker,
+                         &bands[thread_count]) != 0 )
+      {
+         break;
+      }
+   }
+   for(i = thread_count; i < band_count; i++)
+      RowBandWorker(&bands[i]);
+   for(i = 0; i < thread_count; i++)
+      pthread_join(threads[i], NULL);
+}
+
+void StackPixels(const png_image *image,
+                 png_bytep pixels,
+                 png_const_bytep overlay)
+{
+   png_const_bytep r = overlay;
+   png_bytep w = pixels;
+   int i;
+
+   for(i = 0; i < (int)(image->width * image->height); i++)
+   {
+      if( r[1] == 0xff )
+      {
+         /* Overlay pixel is opaque, so we will take its pixel value
+            unconditionally.  This only works because we assert that
+            all input images are black and white, so we don't need to
+            do any fancy calculations with opacity.                   */
+         *w++ = *r++;
+         *w++ = *r++;
+      }
+      else
+      {
+         /* Overlay pixel is transparent.  Leave underlay pixel untouched. */
+         w += 2;
+         r += 2;
+      }
+   }
+}
+
+void EraseOddLines(const png_image *image, png_bytep pixels)
+{
+   int y;
+
+   for(y = 1; y < (int)(image->height); y += 2)
+      memset(pixels + y * image->width * 2, 0, image->width * 2);
+}
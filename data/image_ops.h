@@ -0,0 +1,98 @@
+/* Pixel operations on 8bit grayscale plus 8bit alpha images.
+
+   These are the inner loops of dither, fs_dither, and crop_table, plus
+   the 8bit versions of stack_bw and horizontal_stripes (those tools now
+   use bitplane.h).  They are kept in a separate object file so that
+   image_pipeline can apply them back to back on the same buffer, without
+   having to encode and decode intermediate PNGs between each step.
+
+   All functions operate on pixels that were loaded with PNG_FORMAT_GA.
+*/
+
+#ifndef IMAGE_OPS_H_
+#define IMAGE_OPS_H_
+
+#include<png.h>
+
+/* Convert color and alpha channels to black and white with ordered
+   dithering.  Color is set to zero where alpha is zero.
+
+   This uses the fastest vector kernel supported by the current host,
+   selected at run time on the first call.                               */
+void OrderedDither(const png_image *image, png_bytep pixels);
+
+/* Check that all vector kernels supported by the current host produce
+   the same output as the reference implementation of OrderedDither.
+   Returns 0 on success, nonzero on mismatch or out of memory.           */
+int OrderedDitherSelfTest(void);
+
+/* Convert color and alpha channels to black and white with
+   Floyd-Steinberg dithering.  Color is set to zero where alpha is zero.
+
+   Returns 0 on success, nonzero if we ran out of memory.                */
+int FloydSteinbergDither(const png_image *image, png_bytep pixels);
+
+/* Error diffusion state for dithering one scanline at a time, for callers
+   that do not want to hold the whole image in memory.  row_error holds
+   current and next scanline errors for color, followed by the same for
+   alpha.                                                                */
+typedef struct
+{
+   int width;
+   int *row_error[4];
+} FloydSteinbergState;
+
+/* Allocate error diffusion state.  Returns 0 on success, nonzero if we
+   ran out of memory.                                                    */
+int InitFloydSteinberg(FloydSteinbergState *state, int width);
+
+/* Dither the next scanline in-place, with the same output as
+   FloydSteinbergDither on the full image.                               */
+void FloydSteinbergDitherRow(FloydSteinbergState *state, png_bytep row);
+
+/* Release error diffusion state. */
+void FreeFloydSteinberg(FloydSteinbergState *state);
+
+/* Crop a rectangular region in-place, updating image dimensions.
+   Caller is responsible for making sure that the region is within
+   image bounds.                                                         */
+void CropRegionInPlace(png_image *image, png_bytep pixels,
+                       int width, int height, int x, int y);
+
+/* Crop each {w0}x{h0} cell of a tile table down to {w1}x{h1}, taking
+   pixels from offset ({x},{y}) within the old cell.  Pixels are shifted
+   in-place, and image dimensions are updated.  Caller is responsible for
+   validating crop parameters.
+
+   Tools use CropTiles instead.  This serial version is kept as the
+   baseline for image_bench.                                             */
+void CropTilesInPlace(png_image *image, png_bytep pixels,
+                      int w0, int h0, int w1, int h1, int x, int y);
+
+/* Same as CropTilesInPlace, but write cropped pixels to a separate output
+   buffer, which must be large enough to hold the cropped image.  Output
+   tile rows are split across threads with ForEachRowBand.               */
+void CropTiles(png_image *image, png_const_bytep pixels, png_bytep output,
+               int w0, int h0, int w1, int h1, int x, int y);
+
+/* Split rows [0, height) into contiguous bands, one per available CPU,
+   and call func(context, band_start, band_end) for each band in parallel.
+   Returns after all bands are done.
+
+   Bands never overlap, so as long as func only writes to rows inside its
+   own band, output is the same regardless of how many threads were used.
+   If threads could not be created, the remaining bands are processed on
+   the current thread.                                                   */
+void ForEachRowBand(int height, void (*func)(void *, int, int),
+                    void *context);
+
+/* Composite a black-and-white overlay of the same size on top of pixels.
+   Only fully opaque overlay pixels are copied.                          */
+void StackPixels(const png_image *image,
+                 png_bytep pixels,
+                 png_const_bytep overlay);
+
+/* Erase every odd scanline. */
+void EraseOddLines(const png_image *image, png_bytep pixels);
+
+#endif
@@ -0,0 +1,620 @@
+/* Apply a sequence of image operations within a single process.
+
+   Usage:
+
+      ./image_pipeline [--preset={preset}] "{stage} | {stage} | ..."
+
+   Stages:
+
+      load {input.png}        = Replace current image with {input.png}.
+      save {output.png}       = Write current image to {output.png}.
+      region {w} {h} {x} {y}  = Crop to {w}x{h} rectangle at ({x},{y}).
+      crop {w0} {h0} {w1} {h1} {x} {y}
+                              = Crop tile table cells, same parameters
+                                as crop_table.
+      append {input.png}      = Append {input.png} below current image.
+      stack {input.png}       = Composite {input.png} over current image,
+                                same as stack_bw.
+      dither                  = Ordered dithering, same as dither.
+      fs_dither               = Floyd-Steinberg dithering, same as
+                                fs_dither.
+      stripes                 = Erase odd lines, same as
+                                horizontal_stripes.
+
+   Use "-" for load/save to read/write from stdin/stdout.  All save stages
+   use the same PNG encoder preset, see png_encode.h.
+
+   Color is preserved for images that are loaded and then saved with no
+   stages in between, which is how the itch.io cover is written.  All
+   other stages convert the current image to gray plus alpha first, with
+   the same result as if it was loaded as gray.
+
+   Stages can be passed as a single argument, or spread out over multiple
+   arguments.  Either way, "|" separates stages.  Examples:
+
+      ./image_pipeline "load world.png | region 512 192 0 0 | save out.png"
+      ./image_pipeline load world.png "|" fs_dither "|" save -
+
+   All our post-rasterization steps operate on the same 8bit gray plus
+   8bit alpha buffer, so instead of encoding and decoding a PNG between
+   each step and launching a separate process for each one, we run the
+   whole chain here.  Output is the same as chaining the individual tools.
+*/
+
+#include"image_ops.h"
+#include"png_encode.h"
+#include<png.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+#ifdef _WIN32
+   #include<fcntl.h>
+   #include<io.h>
+#endif
+
+/* Maximum number of numeric arguments for any stage. */
+#define MAX_STAGE_ARGS 6
+
+typedef enum
+{
+   STAGE_LOAD,
+   STAGE_SAVE,
+   STAGE_REGION,
+   STAGE_CROP,
+   STAGE_APPEND,
+   STAGE_STACK,
+   STAGE_DITHER,
+   STAGE_FS_DITHER,
+   STAGE_STRIPES
+} StageType;
+
+/* Stage syntax. */
+typedef struct
+{
+   const char *name;
+   StageType type;
+   int has_filename;
+   int arg_count;
+} StageSyntax;
+
+static const StageSyntax stage_syntax[] =
+{
+   {"load",      STAGE_LOAD,      1, 0},
+   {"save",      STAGE_SAVE,      1, 0},
+   {"region",    STAGE_REGION,    0, 4},
+   {"crop",      STAGE_CROP,      0, 6},
+   {"append",    STAGE_APPEND,    1, 0},
+   {"stack",     STAGE_STACK,     1, 0},
+   {"dither",    STAGE_DITHER,    0, 0},
+   {"fs_dither", STAGE_FS_DITHER, 0, 0},
+   {"stripes",   STAGE_STRIPES,   0, 0},
+   {NULL,        STAGE_LOAD,      0, 0}
+};
+
+/* Parsed stage. */
+typedef struct
+{
+   StageType type;
+   const char *filename;
+   int arg[MAX_STAGE_ARGS];
+} Stage;
+
+/* Current image state.  If pixels are RGBA, encoded holds the PNG bytes
+   loaded from filename, so that it can be decoded again as gray.
+   Otherwise encoded is NULL.                                            */
+typedef struct
+{
+   png_image image;
+   png_bytep pixels;
+   png_bytep encoded;
+   size_t encoded_size;
+   const char *filename;
+} Image;
+
+/* Split command line arguments into tokens, with "|" being a token of
+   its own.  Returns token count.  Tokens point into a newly allocated
+   buffer that is returned through the first token.                      */
+static int Tokenize(int argc, char **argv, char ***tokens)
+{
+   size_t size = 0;
+   int i, count = 0;
+   char *buffer, *r, *w;
+
+   /* Each input character produces at most 2 characters in output
+      buffer: "|" expands to "|" plus a separator.                        */
+   for(i = 1; i < argc; i++)
+      size += strlen(argv[i]) * 2 + 1;
+   buffer = (char*)malloc(size + 1);
+   *tokens = (char**)malloc((size + 1) * sizeof(char*));
+   if( buffer == NULL || *tokens == NULL )
+   {
+      free(buffer);
+      free(*tokens);
+      return -1;
+   }
+
+   w = buffer;
+   for(i = 1; i < argc; i++)
+   {
+      for(r = argv[i]; *r != '\0'; r++)
+      {
+         if( *r == ' ' || *r == '\t' || *r == '\n' || *r == '\r' )
+         {
+            if( w > buffer && *(w - 1) != '\0' )
+               *w++ = '\0';
+            continue;
+         }
+         if( *r == '|' )
+         {
+            if( w > buffer && *(w - 1) != '\0' )
+               *w++ = '\0';
+            (*tokens)[count++] = w;
+            *w++ = '|';
+            *w++ = '\0';
+            continue;
+         }
+         if( w == buffer || *(w - 1) == '\0' )
+            (*tokens)[count++] = w;
+         *w++ = *r;
+      }
+      if( w > buffer && *(w - 1) != '\0' )
+         *w++ = '\0';
+   }
+   if( count == 0 )
+      free(buffer);
+   return count;
+}
+
+/* Parse tokens into stages.  Returns stage count, or -1 on error. */
+static int ParseStages(int token_count, char **tokens, Stage *stages)
+{
+   const StageSyntax *syntax;
+   int i = 0, j, stage_count = 0;
+   char *end;
+
+   while( i < token_count )
+   {
+      for(syntax = stage_syntax; syntax->name != NULL; syntax++)
+      {
+         if( strcmp(syntax->name, tokens[i]) == 0 )
+            break;
+      }
+      if( syntax->name == NULL )
+      {
+         fprintf(stderr, "Unknown stage: %s\n", tokens[i]);
+         return -1;
+      }
+      stages[stage_count].type = syntax->type;
+      stages[stage_count].filename = NULL;
+      i++;
+
+      if( syntax->has_filename )
+      {
+         if( i >= token_count || strcmp(tokens[i], "|") == 0 )
+         {
+            fprintf(stderr, "%s: missing filename\n", syntax->name);
+            return -1;
+         }
+         stages[stage_count].filename = tokens[i++];
+      }
+      for(j = 0; j < syntax->arg_count; j++)
+      {
+         if( i >= token_count || strcmp(tokens[i], "|") == 0 )
+         {
+            fprintf(stderr, "%s: expected %d arguments\n",
+                    syntax->name, syntax->arg_count);
+            return -1;
+         }
+         stages[stage_count].arg[j] = (int)strtol(tokens[i], &end, 10);
+         if( *end != '\0' )
+         {
+            fprintf(stderr, "%s: invalid argument: %s\n",
+                    syntax->name, tokens[i]);
+            return -1;
+         }
+         i++;
+      }
+      stage_count++;
+
+      if( i < token_count )
+      {
+         if( strcmp(tokens[i], "|") != 0 )
+         {
+            fprintf(stderr, "%s: unexpected argument: %s\n",
+                    syntax->name, tokens[i]);
+            return -1;
+         }
+         i++;
+      }
+   }
+   return stage_count;
+}
+
+/* Read all bytes from file or stdin.  Returns 0 on success. */
+static int ReadInput(const char *filename, png_bytep *data, size_t *size)
+{
+   FILE *infile;
+   png_bytep p;
+   size_t capacity = 0x10000, read_size;
+
+   *data = NULL;
+   *size = 0;
+   infile = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "rb");
+   if( infile == NULL )
+   {
+      fprintf(stderr, "Error reading %s\n", filename);
+      return 1;
+   }
+   do
+   {
+      capacity *= 2;
+      p = (png_bytep)realloc(*data, capacity);
+      if( p == NULL )
+      {
+         fputs("Out of memory\n", stderr);
+         free(*data);
+         *data = NULL;
+         if( infile != stdin )
+            fclose(infile);
+         return 1;
+      }
+      *data = p;
+      read_size = fread(*data + *size, 1, capacity - *size, infile);
+      *size += read_size;
+   } while( *size == capacity );
+   if( infile != stdin )
+      fclose(infile);
+   return 0;
+}
+
+/* Decode encoded bytes to pixels of a particular format.  Returns 0 on
+   success.                                                              */
+static int DecodeImage(const char *filename, png_uint_32 format,
+                       Image *output)
+{
+   memset(&(output->image), 0, sizeof(png_image));
+   output->image.version = PNG_IMAGE_VERSION;
+   output->pixels = NULL;
+   if( !png_image_begin_read_from_memory(&(output->image), output->encoded,
+                                         output->encoded_size) )
+   {
+      if( strcmp(filename, "-") == 0 )
+         fputs("Error reading from stdin\n", stderr);
+      else
+         fprintf(stderr, "Error reading %s\n", filename);
+      return 1;
+   }
+   if( (output->image.format & PNG_FORMAT_FLAG_COLOR) == 0 )
+      format = PNG_FORMAT_GA;
+
+   output->image.format = format;
+   output->pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(output->image));
+   if( output->pixels == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   if( !png_image_finish_read(&(output->image), NULL, output->pixels, 0,
+                              NULL) )
+   {
+      fprintf(stderr, "Error loading %s\n", filename);
+      free(output->pixels);
+      output->pixels = NULL;
+      return 1;
+   }
+   return 0;
+}
+
+/* Convert RGBA pixels to gray plus alpha in place, if all pixels are
+   gray.  For those pixels, this produces the same values as decoding
+   with PNG_FORMAT_GA.  Returns 1 if pixels were converted.              */
+static int PackGray(Image *image)
+{
+   const size_t size = (size_t)image->image.width * image->image.height;
+   png_bytep p = image->pixels;
+   size_t i;
+
+   for(i = 0; i < size; i++)
+   {
+      if( p[i * 4] != p[i * 4 + 1] || p[i * 4] != p[i * 4 + 2] )
+         return 0;
+   }
+   for(i = 0; i < size; i++)
+   {
+      p[i * 2] = p[i * 4];
+      p[i * 2 + 1] = p[i * 4 + 3];
+   }
+   image->image.format = PNG_FORMAT_GA;
+   return 1;
+}
+
+/* Load image from file.  If allow_color is set, color inputs are kept
+   as RGBA, otherwise all inputs are converted to gray plus alpha.
+   Returns 0 on success.                                                 */
+static int LoadImage(const char *filename, int allow_color, Image *output)
+{
+   output->pixels = NULL;
+   if( ReadInput(filename, &(output->encoded), &(output->encoded_size)) != 0 )
+      return 1;
+   if( DecodeImage(filename, allow_color ? PNG_FORMAT_RGBA : PNG_FORMAT_GA,
+                   output) != 0 ||
+       output->image.format == PNG_FORMAT_GA ||
+       PackGray(output) )
+   {
+      free(output->encoded);
+      output->encoded = NULL;
+   }
+   return output->pixels == NULL;
+}
+
+/* Convert current image to gray plus alpha, if it's in color.  Returns 0
+   on success.                                                           */
+static int ConvertToGray(Image *current)
+{
+   int status;
+
+   if( current->encoded == NULL )
+      return 0;
+   free(current->pixels);
+   status = DecodeImage(current->filename, PNG_FORMAT_GA, current);
+   free(current->encoded);
+   current->encoded = NULL;
+   return status;
+}
+
+/* Write image to file.  Returns 0 on success. */
+static int SaveImage(const char *filename, PngPreset preset, Image *input)
+{
+   if( input->encoded != NULL )
+   {
+      return SaveColorPng(filename, (int)input->image.width,
+                          (int)input->image.height, input->pixels, preset);
+   }
+   return SavePng(filename, (int)input->image.width, (int)input->image.height,
+                  input->pixels, preset);
+}
+
+/* Check crop parameters.  Returns 0 if parameters are valid. */
+static int CheckRegion(const Image *current, const int *arg)
+{
+   if( arg[0] < 1 || arg[1] < 1 || arg[2] < 0 || arg[3] < 0 ||
+       arg[2] + arg[0] > (int)(current->image.width) ||
+       arg[3] + arg[1] > (int)(current->image.height) )
+   {
+      fprintf(stderr, "Invalid region %dx%d+%d+%d for (%d,%d)\n",
+              arg[0], arg[1], arg[2], arg[3],
+              (int)(current->image.width), (int)(current->image.height));
+      return 1;
+   }
+   return 0;
+}
+
+static int CheckCrop(const Image *current, const int *arg)
+{
+   if( arg[0] < 1 || arg[1] < 1 ||
+       arg[2] < 1 || arg[3] < 1 ||
+       arg[4] < 0 || arg[5] < 0 ||
+       arg[4] + arg[2] > arg[0] || arg[5] + arg[3] > arg[1] )
+   {
+      fprintf(stderr, "Invalid crop parameters: %dx%d -> %dx%d+%d+%d\n",
+              arg[0], arg[1], arg[2], arg[3], arg[4], arg[5]);
+      return 1;
+   }
+   if( current->image.width % arg[0] != 0 ||
+       current->image.height % arg[1] != 0 )
+   {
+      fprintf(stderr,
+              "Image dimension is not a multiple of (%d,%d): (%d,%d)\n",
+              arg[0], arg[1],
+              (int)(current->image.width), (int)(current->image.height));
+      return 1;
+   }
+   return 0;
+}
+
+/* Crop tiles of current image.  This is done out-of-place so that tile
+   rows can be processed in parallel.  Returns 0 on success.              */
+static int CropImage(const Stage *stage, Image *current)
+{
+   png_bytep pixels;
+
+   if( CheckCrop(current, stage->arg) != 0 )
+      return 1;
+   pixels = (png_bytep)malloc(
+      (size_t)(current->image.width / stage->arg[0]) * stage->arg[2] *
+      (current->image.height / stage->arg[1]) * stage->arg[3] * 2);
+   if( pixels == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   CropTiles(&(current->image), current->pixels, pixels,
+             stage->arg[0], stage->arg[1],
+             stage->arg[2], stage->arg[3],
+             stage->arg[4], stage->arg[5]);
+   free(current->pixels);
+   current->pixels = pixels;
+   return 0;
+}
+
+/* Append or composite another image on current image.  Returns 0 on
+   success.                                                              */
+static int MergeImage(const Stage *stage, Image *current)
+{
+   Image add;
+   png_bytep pixels;
+   size_t size;
+
+   if( LoadImage(stage->filename, 0, &add) != 0 )
+      return 1;
+
+   if( stage->type == STAGE_STACK )
+   {
+      if( add.image.width != current->image.width ||
+          add.image.height != current->image.height )
+      {
+         fprintf(stderr, "%s: size mismatch (%d,%d), expected (%d,%d)\n",
+                 stage->filename,
+                 (int)(add.image.width), (int)(add.image.height),
+                 (int)(current->image.width), (int)(current->image.height));
+         free(add.pixels);
+         return 1;
+      }
+      StackPixels(&(current->image), current->pixels, add.pixels);
+      free(add.pixels);
+      return 0;
+   }
+
+   /* STAGE_APPEND */
+   if( add.image.width != current->image.width )
+   {
+      fprintf(stderr, "%s: width mismatch %d, expected %d\n",
+              stage->filename,
+              (int)(add.image.width), (int)(current->image.width));
+      free(add.pixels);
+      return 1;
+   }
+   size = PNG_IMAGE_SIZE(current->image);
+   pixels = (png_bytep)realloc(current->pixels,
+                               size + PNG_IMAGE_SIZE(add.image));
+   if( pixels == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      free(add.pixels);
+      return 1;
+   }
+   memcpy(pixels + size, add.pixels, PNG_IMAGE_SIZE(add.image));
+   current->pixels = pixels;
+   current->image.height += add.image.height;
+   free(add.pixels);
+   return 0;
+}
+
+/* Run a single stage.  Returns 0 on success. */
+static int RunStage(const Stage *stage, PngPreset preset, Image *current)
+{
+   if( stage->type == STAGE_LOAD )
+   {
+      free(current->pixels);
+      free(current->encoded);
+      current->pixels = NULL;
+      current->encoded = NULL;
+      current->filename = stage->filename;
+      return LoadImage(stage->filename, 1, current);
+   }
+
+   if( current->pixels == NULL )
+   {
+      fputs("No image loaded\n", stderr);
+      return 1;
+   }
+   if( stage->type != STAGE_SAVE &&
+       ConvertToGray(current) != 0 )
+   {
+      return 1;
+   }
+   switch( stage->type )
+   {
+      case STAGE_SAVE:
+         return SaveImage(stage->filename, preset, current);
+      case STAGE_REGION:
+         if( CheckRegion(current, stage->arg) != 0 )
+            return 1;
+         CropRegionInPlace(&(current->image), current->pixels,
+                           stage->arg[0], stage->arg[1],
+                           stage->arg[2], stage->arg[3]);
+         return 0;
+      case STAGE_CROP:
+         return CropImage(stage, current);
+      case STAGE_APPEND:
+      case STAGE_STACK:
+         return MergeImage(stage, current);
+      case STAGE_DITHER:
+         OrderedDither(&(current->image), current->pixels);
+         return 0;
+      case STAGE_FS_DITHER:
+         if( FloydSteinbergDither(&(current->image), current->pixels) != 0 )
+         {
+            fputs("Out of memory\n", stderr);
+            return 1;
+         }
+         return 0;
+      case STAGE_STRIPES:
+         EraseOddLines(&(current->image), current->pixels);
+         return 0;
+      default:
+         break;
+   }
+   return 1;
+}
+
+int main(int argc, char **argv)
+{
+   char **tokens;
+   Stage *stages;
+   Image current;
+   PngPreset preset;
+   int token_count, stage_count, i, status;
+
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
+   if( argc < 2 )
+   {
+      return printf("%s [--preset={preset}] \"{stage} | {stage} | ...\"\n",
+                    *argv);
+   }
+
+   token_count = Tokenize(argc, argv, &tokens);
+   if( token_count < 0 )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   if( token_count == 0 )
+   {
+      fputs("No stages specified\n", stderr);
+      free(tokens);
+      return 1;
+   }
+
+   /* Parse all stages before running any of them, so that syntax errors
+      are reported without side effects.                                 */
+   stages = (Stage*)malloc(token_count * sizeof(Stage));
+   if( stages == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   stage_count = ParseStages(token_count, tokens, stages);
+   if( stage_count < 0 )
+      return 1;
+   for(i = 0; i < stage_count; i++)
+   {
+      if( stages[i].type == STAGE_SAVE &&
+          strcmp(stages[i].filename, "-") == 0 &&
+          isatty(STDOUT_FILENO) )
+      {
+         fputs("Not writing output to stdout because it's a tty\n", stderr);
+         return 1;
+      }
+   }
+
+   #ifdef _WIN32
+      setmode(STDIN_FILENO, O_BINARY);
+      setmode(STDOUT_FILENO, O_BINARY);
+   #endif
+
+   memset(&current, 0, sizeof(current));
+   status = 0;
+   for(i = 0; i < stage_count && status == 0; i++)
+      status = RunStage(&stages[i], preset, &current);
+
+   free(current.pixels);
+   free(current.encoded);
+   free(stages);
+   free(tokens[0]);
+   free(tokens);
+   return status;
+}
@@ -0,0 +1,471 @@
+/* Desktop benchmark for grid generation.
+
+   Usage:
+
+      ./maze_bench.exe [{iterations} [{seed}]]
+
+   This simulates init_chains() from main.lua for the given number of
+   completed chains in each of the 8 game modes (default 1000000), using
+   the same SolveMaze() core as the native extension.  Each iteration:
+
+   1. Initializes a window of targets around the cursor, so that most
+      targets near the cursor already exist before init_chains, like what
+      draw_visible_targets would have done in earlier frames.
+   2. Runs init_chains: populate immediate neighbors, adjust center value,
+      and generate both solution paths.
+   3. Verifies the same invariants as debug_fuzz_init_chains: both
+      solution paths exist, they start at the cursor, consist of adjacent
+      targets, XOR to 0x0 and 0xf respectively, and there are no solutions
+      of length 1 or 2.
+   4. Follows one of the two solution paths at random, the same way as
+      autoplay mode would, and completes that chain as in
+      check_completed_chain: all targets along the chain are removed, and
+      the cursor stays at the end of the chain.
+
+   Latency of step 2 and number of search nodes are reported per mode.
+   Exit status is nonzero if any invariant failed, so this doubles as a
+   regression test.
+
+   Unlike debug_fuzz_init_chains, this isn't a black box test of the Lua
+   code.  Changes to init_chains or generate_solutions in main.lua need to
+   be mirrored here and in ../native/maze.c.
+*/
+
+#include<stdint.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"maze.h"
+
+/* Target grid is addressed in the same (dx, dy) units as maze.h, and uses
+   the same slot wrapping scheme as "target" in main.lua.  The grid only
+   needs to be large enough to hold the maze window plus the longest
+   chain, 64 is plenty.                                                  */
+#define GRID_SIZE             64
+#define GRID_MASK             (GRID_SIZE - 1)
+
+/* Visible window around the cursor, see DRAW_HALF_WIDTH and
+   DRAW_ODD_HALF_HEIGHT in main.lua.                                      */
+#define DRAW_HALF_COLUMNS     4
+#define DRAW_HALF_ROWS        7
+
+/* See generate_bit_table.pl. */
+#define ODDS_OF_ALL_ZEROES    13
+#define MAX_BIT_TABLE_SIZE    512
+
+/* Cell offsets for each direction, same order as TARGET_OFFSET. */
+static const int kOffsetX[6] = {0, 1, 1, 0, -1, -1};
+static const int kOffsetY[6] = {-2, -1, 1, 2, 1, -1};
+
+typedef struct
+{
+   int x, y;
+   int valid;
+   int value;
+   int birth_frame;
+   int maze_generation;
+} Target;
+
+typedef struct
+{
+   /* Game mode settings. */
+   int all_ones;
+   int bit_table[MAX_BIT_TABLE_SIZE];
+   int bit_table_size;
+
+   /* Game state. */
+   Target grid[GRID_SIZE * GRID_SIZE];
+   int cursor_x, cursor_y;
+   int global_frames;
+   uint32_t random_state;
+   Maze maze;
+
+   /* Solution paths in grid coordinates. */
+   int path_x[2][MAZE_MAX_CHAIN_LENGTH];
+   int path_y[2][MAZE_MAX_CHAIN_LENGTH];
+   int path_length[2];
+} Game;
+
+/* Per mode statistics. */
+typedef struct
+{
+   uint32_t *latency;
+   uint32_t *nodes;
+   double total_chain_length;
+   int failures;
+} Stats;
+
+/* Xorshift random number generator, returns a number in [0, n). */
+static int Random(Game *game, int n)
+{
+   uint32_t x = game->random_state;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   game->random_state = x;
+   return (int)(x % (uint32_t)n);
+}
+
+/* Count number of bits set. */
+static int BitCount(int x)
+{
+   int count = 0;
+   for(; x != 0; x &= x - 1)
+      count++;
+   return count;
+}
+
+/* Initialize game state for a particular game mode [1..8]. */
+static void InitGame(Game *game, int mode, uint32_t seed)
+{
+   static const int kMaxBits[8] = {1, 2, 3, 4, 1, 2, 5, 8};
+   const int width = mode <= 4 ? 4 : 8;
+   int i, padding;
+
+   memset(game, 0, sizeof(Game));
+   game->all_ones = (1 << width) - 1;
+   for(i = 0; i < (1 << width); i++)
+   {
+      if( BitCount(i) <= kMaxBits[mode - 1] )
+         game->bit_table[game->bit_table_size++] = i;
+   }
+   padding = game->bit_table_size / (ODDS_OF_ALL_ZEROES - 1);
+   for(i = 0; i < padding; i++)
+      game->bit_table[game->bit_table_size++] = 0;
+
+   game->random_state = seed;
+}
+
+/* Get target slot for a particular coordinate. */
+static Target *GetSlot(Game *game, int x, int y)
+{
+   return &game->grid[(x & GRID_MASK) * GRID_SIZE + (y & GRID_MASK)];
+}
+
+/* Get existing target, or NULL if target doesn't exist. */
+static Target *GetTarget(Game *game, int x, int y)
+{
+   Target *t = GetSlot(game, x, y);
+   return (t->valid && t->x == x && t->y == y) ? t : NULL;
+}
+
+/* Same as init_target. */
+static Target *InitTarget(Game *game, int x, int y)
+{
+   Target *t = GetSlot(game, x, y);
+
+   if( !t->valid || t->x != x || t->y != y )
+   {
+      t->x = x;
+      t->y = y;
+      t->valid = 1;
+      t->value = game->bit_table[Random(game, game->bit_table_size)];
+      t->birth_frame = game->global_frames;
+      t->maze_generation = -1;
+   }
+   return t;
+}
+
+/* Initialize all visible targets around cursor. */
+static void InitVisibleTargets(Game *game)
+{
+   int dx, dy;
+
+   for(dx = -DRAW_HALF_COLUMNS; dx <= DRAW_HALF_COLUMNS; dx++)
+   {
+      for(dy = -DRAW_HALF_ROWS; dy <= DRAW_HALF_ROWS; dy++)
+      {
+         if( ((dx + dy) & 1) == 0 )
+            InitTarget(game, game->cursor_x + dx, game->cursor_y + dy);
+      }
+   }
+}
+
+/* Same as no_trivial_solutions. */
+static int NoTrivialSolutions(Game *game)
+{
+   const Target *center = GetTarget(game, game->cursor_x, game->cursor_y);
+   const Target *neighbor;
+   int i, v;
+
+   if( center == NULL ||
+       center->value == 0 || center->value == game->all_ones )
+      return 0;
+   for(i = 0; i < 6; i++)
+   {
+      neighbor = GetTarget(game, game->cursor_x + kOffsetX[i],
+                                 game->cursor_y + kOffsetY[i]);
+      if( neighbor == NULL )
+         return 0;
+      v = center->value ^ neighbor->value;
+      if( v == 0 || v == game->all_ones )
+         return 0;
+   }
+   return 1;
+}
+
+/* Same as init_chains, using generate_solutions_native. */
+static void InitChains(Game *game)
+{
+   Target *cells[MAZE_CELLS];
+   Target *center, *t;
+   int i, j, c, v, dx, dy, index, all_good, which;
+
+   for(i = 0; i < 6; i++)
+   {
+      InitTarget(game, game->cursor_x + kOffsetX[i],
+                       game->cursor_y + kOffsetY[i]);
+   }
+   center = InitTarget(game, game->cursor_x, game->cursor_y);
+
+   /* Adjust center value. */
+   for(i = 0; i < 16; i++)
+   {
+      all_good = 1;
+      for(j = 0; j < 6; j++)
+      {
+         t = GetTarget(game, game->cursor_x + kOffsetX[j],
+                             game->cursor_y + kOffsetY[j]);
+         c = center->value ^ i;
+         v = c ^ t->value;
+         if( c == 0 || c == game->all_ones || v == 0 || v == game->all_ones )
+         {
+            all_good = 0;
+            break;
+         }
+      }
+      if( all_good )
+      {
+         center->value ^= i;
+         break;
+      }
+   }
+
+   /* Generate solutions. */
+   InitMaze(&game->maze, game->all_ones,
+            (uint32_t)Random(game, 0x7fffffff) + 1);
+   for(dx = -MAZE_HALF_COLUMNS; dx <= MAZE_HALF_COLUMNS; dx++)
+   {
+      for(dy = -MAZE_HALF_ROWS; dy <= MAZE_HALF_ROWS; dy++)
+      {
+         if( ((dx + dy) & 1) != 0 )
+            continue;
+         index = MazeIndex(dx, dy);
+         t = InitTarget(game, game->cursor_x + dx, game->cursor_y + dy);
+         game->maze.value[index] = (uint8_t)t->value;
+         game->maze.flags[index] =
+            (t->birth_frame == game->global_frames ? MAZE_NEW : 0) |
+            (t->maze_generation == game->global_frames ? MAZE_VISITED : 0);
+         cells[index] = t;
+      }
+   }
+
+   SolveMaze(&game->maze);
+
+   for(dx = -MAZE_HALF_COLUMNS; dx <= MAZE_HALF_COLUMNS; dx++)
+   {
+      for(dy = -MAZE_HALF_ROWS; dy <= MAZE_HALF_ROWS; dy++)
+      {
+         if( ((dx + dy) & 1) != 0 )
+            continue;
+         index = MazeIndex(dx, dy);
+         cells[index]->value = game->maze.value[index];
+         if( (game->maze.flags[index] & MAZE_VISITED) != 0 )
+            cells[index]->maze_generation = game->global_frames;
+      }
+   }
+
+   game->path_length[0] = game->maze.path_0_length;
+   game->path_length[1] = game->maze.path_f_length;
+   for(which = 0; which < 2; which++)
+   {
+      for(i = 0; i < game->path_length[which]; i++)
+      {
+         index = which == 0 ? game->maze.path_0[i] : game->maze.path_f[i];
+         game->path_x[which][i] =
+            game->cursor_x + index / MAZE_ROWS - MAZE_HALF_COLUMNS;
+         game->path_y[which][i] =
+            game->cursor_y + index % MAZE_ROWS - MAZE_HALF_ROWS;
+      }
+   }
+}
+
+/* Same as debug_check_solution.  Returns 0 if path is valid. */
+static int CheckSolution(Game *game, int which, int expected)
+{
+   const int length = game->path_length[which];
+   const int *px = game->path_x[which];
+   const int *py = game->path_y[which];
+   const Target *t;
+   int i, j, dx, dy, value = 0;
+
+   if( length < 3 || px[0] != game->cursor_x || py[0] != game->cursor_y )
+      return 1;
+   for(i = 0; i < length; i++)
+   {
+      if( i > 0 )
+      {
+         dx = abs(px[i] - px[i - 1]);
+         dy = abs(py[i] - py[i - 1]);
+         if( !((dx == 1 && dy == 1) || (dx == 0 && dy == 2)) )
+            return 1;
+      }
+      for(j = 0; j < i; j++)
+      {
+         if( px[i] == px[j] && py[i] == py[j] )
+            return 1;
+      }
+      t = GetTarget(game, px[i], py[i]);
+      if( t == NULL )
+         return 1;
+      value ^= t->value;
+   }
+   return value == expected ? 0 : 1;
+}
+
+/* Follow a solution path and complete that chain.  Returns chain length. */
+static int CompleteChain(Game *game, int which)
+{
+   const int length = game->path_length[which];
+   Target *t;
+   int i;
+
+   for(i = 0; i < length; i++)
+   {
+      t = GetTarget(game, game->path_x[which][i], game->path_y[which][i]);
+      t->valid = 0;
+   }
+   game->cursor_x = game->path_x[which][length - 1];
+   game->cursor_y = game->path_y[which][length - 1];
+   return length;
+}
+
+/* Get time in nanoseconds. */
+static uint64_t Now(void)
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* Comparison function for qsort. */
+static int CompareUint32(const void *a, const void *b)
+{
+   const uint32_t x = *(const uint32_t*)a;
+   const uint32_t y = *(const uint32_t*)b;
+   return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Sort list of samples and get percentile values. */
+static void GetPercentiles(uint32_t *samples, int count,
+                           uint32_t *p50, uint32_t *p99, uint32_t *max)
+{
+   qsort(samples, count, sizeof(uint32_t), CompareUint32);
+   *p50 = samples[(int)((int64_t)count * 50 / 100)];
+   *p99 = samples[(int)((int64_t)count * 99 / 100)];
+   *max = samples[count - 1];
+}
+
+/* Run benchmark for one game mode. */
+static void RunMode(Game *game, int mode, int iterations, uint32_t seed,
+                    Stats *stats)
+{
+   uint64_t start;
+   int i, which;
+
+   InitGame(game, mode, seed);
+   stats->total_chain_length = 0;
+   stats->failures = 0;
+   for(i = 0; i < iterations; i++)
+   {
+      InitVisibleTargets(game);
+      game->global_frames++;
+
+      start = Now();
+      InitChains(game);
+      stats->latency[i] = (uint32_t)(Now() - start);
+      stats->nodes[i] = (uint32_t)game->maze.node_count;
+
+      if( CheckSolution(game, 0, 0) != 0 ||
+          CheckSolution(game, 1, game->all_ones) != 0 ||
+          !NoTrivialSolutions(game) )
+      {
+         if( stats->failures == 0 )
+         {
+            fprintf(stderr, "Mode %d, iteration %d: bad solution at (%d,%d)\n",
+                    mode, i, game->cursor_x, game->cursor_y);
+         }
+         stats->failures++;
+
+         /* Start over from a clean grid, since we can't follow an invalid
+            solution path.                                                 */
+         InitGame(game, mode, game->random_state);
+         continue;
+      }
+
+      which = Random(game, 2);
+      stats->total_chain_length += CompleteChain(game, which);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   static Game game;
+   Stats stats;
+   uint32_t latency_p50, latency_p99, latency_max;
+   uint32_t nodes_p50, nodes_p99, nodes_max;
+   int iterations, mode, failures = 0;
+   uint32_t seed;
+
+   iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+   seed = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 1;
+   if( argc > 3 || iterations < 1 || seed == 0 )
+   {
+      printf("%s [{iterations} [{seed}]]\n", *argv);
+      return 1;
+   }
+
+   stats.latency = (uint32_t*)malloc(iterations * sizeof(uint32_t));
+   stats.nodes = (uint32_t*)malloc(iterations * sizeof(uint32_t));
+   if( stats.latency == NULL || stats.nodes == NULL )
+   {
+      free(stats.latency);
+      free(stats.nodes);
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+
+   printf("mode  latency_ns(p50 p99 max)  nodes(p50 p99 max)  chain\n");
+   for(mode = 1; mode <= 8; mode++)
+   {
+      RunMode(&game, mode, iterations, seed, &stats);
+      GetPercentiles(stats.latency, iterations,
+                     &latency_p50, &latency_p99, &latency_max);
+      GetPercentiles(stats.nodes, iterations,
+                     &nodes_p50, &nodes_p99, &nodes_max);
+      printf("%4d  %6u %6u %8u       %5u %5u %5u    ",
+             mode, latency_p50, latency_p99, latency_max,
+             nodes_p50, nodes_p99, nodes_max);
+      if( stats.failures < iterations )
+      {
+         printf("%5.2f\n",
+                stats.total_chain_length / (iterations - stats.failures));
+      }
+      else
+      {
+         /* All iterations failed, so no chains were completed. */
+         printf("  n/a\n");
+      }
+      failures += stats.failures;
+   }
+
+   free(stats.latency);
+   free(stats.nodes);
+   if( failures > 0 )
+   {
+      fprintf(stderr, "%d failures\n", failures);
+      return 1;
+   }
+   return 0;
+}
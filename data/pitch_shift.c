@@ -0,0 +1,487 @@
+/* Render a pitch-shifted copy of a WAV file.
+
+   Usage:
+
+      ./pitch_shift {input.wav} {seconds} {fade} {pitch} {output_rate}
+                    {output.wav}
+
+   Reads the first {seconds} of a PCM WAV file (16 or 24 bits, any number
+   of channels), mixes all channels down to mono, and resamples it such
+   that it sounds the same as playing the input at {pitch} times its
+   original rate.  Output is mono IMA ADPCM at {output_rate}.
+
+   The last {fade} seconds of input are faded out with a raised cosine,
+   so that cutting off the decay tail doesn't produce a click.
+
+   Resampling uses a Kaiser windowed sinc filter, with cutoff lowered to
+   the output Nyquist frequency when shifting up, so that high notes don't
+   alias.  Output only depends on input and parameters, so rerunning with
+   the same input produces the same output bytes.
+*/
+
+#include<math.h>
+#include<stdint.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/* Number of sinc zero crossings on each side of the filter center. */
+#define ZERO_CROSSINGS  16
+
+/* Kaiser window shape parameter.  8.6 gives roughly 80dB of stopband
+   attenuation.                                                          */
+#define KAISER_BETA     8.6
+
+/* Bytes per ADPCM block, including the 4 byte block header.  Each block
+   holds one sample in the header, plus 2 samples per remaining byte.    */
+#define BLOCK_SIZE      512
+#define BLOCK_SAMPLES   ((BLOCK_SIZE - 4) * 2 + 1)
+
+static const int kStepTable[89] =
+{
+   7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+   41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+   190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+   724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+   2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+   6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289,
+   16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int kIndexTable[16] =
+{
+   -1, -1, -1, -1, 2, 4, 6, 8,
+   -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/* ADPCM decoder state. */
+typedef struct
+{
+   int predictor;
+   int index;
+} AdpcmState;
+
+/* Read little endian integers. */
+static uint32_t Read16(const uint8_t *p)
+{
+   return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t Read32(const uint8_t *p)
+{
+   return Read16(p) | (Read16(p + 2) << 16);
+}
+
+/* Write little endian integers. */
+static void Write16(uint8_t *p, uint32_t x)
+{
+   p[0] = (uint8_t)(x & 0xff);
+   p[1] = (uint8_t)((x >> 8) & 0xff);
+}
+
+static void Write32(uint8_t *p, uint32_t x)
+{
+   Write16(p, x & 0xffff);
+   Write16(p + 2, x >> 16);
+}
+
+/* Load entire file to memory.  Returns NULL on error. */
+static uint8_t *LoadFile(const char *filename, size_t *size)
+{
+   FILE *infile;
+   uint8_t *data;
+   long length;
+
+   if( (infile = fopen(filename, "rb")) == NULL )
+   {
+      fprintf(stderr, "%s: can not open for reading\n", filename);
+      return NULL;
+   }
+   if( fseek(infile, 0, SEEK_END) != 0 ||
+       (length = ftell(infile)) < 0 ||
+       fseek(infile, 0, SEEK_SET) != 0 )
+   {
+      fprintf(stderr, "%s: can not get file size\n", filename);
+      fclose(infile);
+      return NULL;
+   }
+   if( (data = (uint8_t*)malloc(length + 1)) == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      fclose(infile);
+      return NULL;
+   }
+   if( fread(data, length, 1, infile) != 1 && length > 0 )
+   {
+      fprintf(stderr, "%s: read error\n", filename);
+      free(data);
+      fclose(infile);
+      return NULL;
+   }
+   fclose(infile);
+   *size = (size_t)length;
+   return data;
+}
+
+/* Load mono samples from the first {seconds} of a PCM WAV file, with
+   sample values in the range of [-1, 1).  Returns NULL on error.       */
+static double *LoadSamples(const char *filename, double seconds,
+                           int *sample_count, int *sample_rate)
+{
+   const uint8_t *fmt = NULL, *samples = NULL, *p;
+   size_t size, offset, chunk_size, data_size = 0;
+   int channels, bits, frame_size, i, c;
+   uint8_t *data;
+   double *output, sum;
+   int32_t value;
+
+   if( (data = LoadFile(filename, &size)) == NULL )
+      return NULL;
+   if( size < 12 || memcmp(data, "RIFF", 4) != 0 ||
+       memcmp(data + 8, "WAVE", 4) != 0 )
+   {
+      fprintf(stderr, "%s: not a WAV file\n", filename);
+      free(data);
+      return NULL;
+   }
+
+   /* Find format and data chunks.  Chunks are padded to even sizes. */
+   for(offset = 12; offset + 8 <= size;
+       offset += 8 + chunk_size + (chunk_size & 1))
+   {
+      chunk_size = Read32(data + offset + 4);
+      if( chunk_size > size - offset - 8 )
+         chunk_size = size - offset - 8;
+      if( memcmp(data + offset, "fmt ", 4) == 0 && chunk_size >= 16 )
+      {
+         fmt = data + offset + 8;
+      }
+      else if( memcmp(data + offset, "data", 4) == 0 )
+      {
+         samples = data + offset + 8;
+         data_size = chunk_size;
+      }
+   }
+   if( fmt == NULL || samples == NULL )
+   {
+      fprintf(stderr, "%s: missing fmt or data chunk\n", filename);
+      free(data);
+      return NULL;
+   }
+
+   /* Accept plain PCM (1) and WAVE_FORMAT_EXTENSIBLE (0xfffe), the latter
+      being what most tools write for 24bit files.                       */
+   channels = (int)Read16(fmt + 2);
+   *sample_rate = (int)Read32(fmt + 4);
+   bits = (int)Read16(fmt + 14);
+   if( (Read16(fmt) != 1 && Read16(fmt) != 0xfffe) ||
+       (bits != 16 && bits != 24) || channels < 1 || *sample_rate < 1 )
+   {
+      fprintf(stderr, "%s: unsupported format\n", filename);
+      free(data);
+      return NULL;
+   }
+   frame_size = channels * bits / 8;
+   *sample_count = (int)(data_size / frame_size);
+   if( seconds * *sample_rate < *sample_count )
+      *sample_count = (int)(seconds * *sample_rate + 0.5);
+   if( *sample_count < 1 )
+   {
+      fprintf(stderr, "%s: no samples\n", filename);
+      free(data);
+      return NULL;
+   }
+
+   if( (output = (double*)malloc(*sample_count * sizeof(double))) == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      free(data);
+      return NULL;
+   }
+   for(i = 0; i < *sample_count; i++)
+   {
+      p = samples + i * frame_size;
+      sum = 0;
+      for(c = 0; c < channels; c++)
+      {
+         if( bits == 16 )
+         {
+            value = (int32_t)(int16_t)Read16(p);
+            p += 2;
+            sum += value / 32768.0;
+         }
+         else
+         {
+            value = (int32_t)(p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16));
+            if( value & 0x800000 )
+               value -= 0x1000000;
+            p += 3;
+            sum += value / 8388608.0;
+         }
+      }
+      output[i] = sum / channels;
+   }
+   free(data);
+   return output;
+}
+
+/* Fade out the last fade_count samples. */
+static void FadeOut(double *samples, int sample_count, int fade_count)
+{
+   int i;
+
+   if( fade_count > sample_count )
+      fade_count = sample_count;
+   for(i = 0; i < fade_count; i++)
+   {
+      samples[sample_count - fade_count + i] *=
+         0.5 + 0.5 * cos(M_PI * (i + 1) / fade_count);
+   }
+}
+
+/* Zeroth order modified Bessel function of the first kind, for the Kaiser
+   window.                                                               */
+static double BesselI0(double x)
+{
+   double sum = 1, term = 1;
+   int k;
+
+   for(k = 1; k < 50; k++)
+   {
+      term *= (x / (2 * k)) * (x / (2 * k));
+      sum += term;
+      if( term < sum * 1e-17 )
+         break;
+   }
+   return sum;
+}
+
+/* Resample input such that output is {step} input samples apart.
+   Returns NULL if we ran out of memory.                                 */
+static double *Resample(const double *input, int input_count, double step,
+                        int *output_count)
+{
+   /* Cutoff frequency in cycles per input sample.  This is the input
+      Nyquist frequency when output has a higher effective rate, and the
+      output Nyquist frequency otherwise.                                */
+   const double cutoff = 0.5 / (step > 1 ? step : 1);
+   const double half_width = ZERO_CROSSINGS / (2 * cutoff);
+   const double window_scale = 1 / BesselI0(KAISER_BETA);
+   double *output, center, t, x, weight, sum, weight_sum;
+   int i, j, first, last;
+
+   *output_count = (int)(input_count / step);
+   if( (output = (double*)malloc(*output_count * sizeof(double))) == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return NULL;
+   }
+
+   for(j = 0; j < *output_count; j++)
+   {
+      center = j * step;
+      first = (int)ceil(center - half_width);
+      last = (int)floor(center + half_width);
+      sum = weight_sum = 0;
+      for(i = first; i <= last; i++)
+      {
+         t = i - center;
+         /* Rounding may put the outermost taps just past the edge of the
+            window, those get a weight of zero.                          */
+         x = t / half_width;
+         if( x * x >= 1 )
+            continue;
+         weight = BesselI0(KAISER_BETA * sqrt(1 - x * x)) * window_scale;
+         if( t != 0 )
+            weight *= sin(M_PI * 2 * cutoff * t) / (M_PI * 2 * cutoff * t);
+
+         /* Samples outside of input are silent, but still count toward
+            the filter gain, so that the start and end fade in and out
+            instead of being amplified.                                  */
+         weight_sum += weight;
+         if( i >= 0 && i < input_count )
+            sum += input[i] * weight;
+      }
+      output[j] = sum / weight_sum;
+   }
+   return output;
+}
+
+/* Decode a single ADPCM nibble, updating state. */
+static void DecodeNibble(int code, AdpcmState *state)
+{
+   const int step = kStepTable[state->index];
+   int delta = step >> 3;
+
+   if( code & 4 ) delta += step;
+   if( code & 2 ) delta += step >> 1;
+   if( code & 1 ) delta += step >> 2;
+   state->predictor += (code & 8) ? -delta : delta;
+   if( state->predictor > 32767 ) state->predictor = 32767;
+   if( state->predictor < -32768 ) state->predictor = -32768;
+   state->index += kIndexTable[code];
+   if( state->index < 0 ) state->index = 0;
+   if( state->index > 88 ) state->index = 88;
+}
+
+/* Encode a single sample, updating state.  This tries all 16 codes and
+   keeps the one that decodes closest to the target, which is slightly
+   more accurate than deriving code bits one at a time.                  */
+static int EncodeNibble(int target, AdpcmState *state)
+{
+   AdpcmState best_state = *state, trial;
+   int best_code = 0, best_error = -1, error, code;
+
+   for(code = 0; code < 16; code++)
+   {
+      trial = *state;
+      DecodeNibble(code, &trial);
+      error = abs(trial.predictor - target);
+      if( best_error < 0 || error < best_error )
+      {
+         best_error = error;
+         best_code = code;
+         best_state = trial;
+      }
+   }
+   *state = best_state;
+   return best_code;
+}
+
+/* Convert sample to 16bit integer. */
+static int ToInt16(double sample)
+{
+   const double x = floor(sample * 32768 + 0.5);
+   return x > 32767 ? 32767 : x < -32768 ? -32768 : (int)x;
+}
+
+/* Write mono IMA ADPCM WAV file.  Last block is padded with silence.
+   Returns 0 on success.                                                 */
+static int WriteAdpcm(const char *filename, const double *samples,
+                      int sample_count, int sample_rate)
+{
+   const int block_count = (sample_count + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES;
+   const size_t data_size = (size_t)block_count * BLOCK_SIZE;
+   const size_t header_size = 12 + 8 + 20 + 8 + 4 + 8;
+   uint8_t *output, *block, *p;
+   AdpcmState state;
+   int b, i, s, code;
+   FILE *outfile;
+
+   if( (output = (uint8_t*)calloc(header_size + data_size, 1)) == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+
+   /* RIFF header, followed by fmt and fact chunks. */
+   p = output;
+   memcpy(p, "RIFF", 4);
+   Write32(p + 4, (uint32_t)(header_size + data_size - 8));
+   memcpy(p + 8, "WAVE", 4);
+   p += 12;
+   memcpy(p, "fmt ", 4);
+   Write32(p + 4, 20);
+   Write16(p + 8, 0x11);
+   Write16(p + 10, 1);
+   Write32(p + 12, (uint32_t)sample_rate);
+   Write32(p + 16, (uint32_t)((double)sample_rate * BLOCK_SIZE /
+                              BLOCK_SAMPLES + 0.5));
+   Write16(p + 20, BLOCK_SIZE);
+   Write16(p + 22, 4);
+   Write16(p + 24, 2);
+   Write16(p + 26, BLOCK_SAMPLES);
+   p += 28;
+   memcpy(p, "fact", 4);
+   Write32(p + 4, 4);
+   Write32(p + 8, (uint32_t)sample_count);
+   p += 12;
+   memcpy(p, "data", 4);
+   Write32(p + 4, (uint32_t)data_size);
+   p += 8;
+
+   /* Each block starts with a header containing the first sample and the
+      step index carried over from the previous block.                   */
+   state.predictor = 0;
+   state.index = 0;
+   for(b = 0; b < block_count; b++)
+   {
+      block = p + (size_t)b * BLOCK_SIZE;
+      s = b * BLOCK_SAMPLES;
+      state.predictor = s < sample_count ? ToInt16(samples[s]) : 0;
+      Write16(block, (uint32_t)(state.predictor & 0xffff));
+      block[2] = (uint8_t)state.index;
+      block[3] = 0;
+
+      for(i = 1; i < BLOCK_SAMPLES; i++)
+      {
+         s = b * BLOCK_SAMPLES + i;
+         code = EncodeNibble(s < sample_count ? ToInt16(samples[s]) : 0,
+                             &state);
+         block[4 + (i - 1) / 2] |= (uint8_t)((i & 1) ? code : code << 4);
+      }
+   }
+
+   if( (outfile = fopen(filename, "wb")) == NULL )
+   {
+      fprintf(stderr, "%s: can not open for writing\n", filename);
+      free(output);
+      return 1;
+   }
+   if( fwrite(output, header_size + data_size, 1, outfile) != 1 )
+   {
+      fprintf(stderr, "%s: write error\n", filename);
+      fclose(outfile);
+      free(output);
+      return 1;
+   }
+   free(output);
+   if( fclose(outfile) != 0 )
+   {
+      fprintf(stderr, "%s: write error\n", filename);
+      return 1;
+   }
+   return 0;
+}
+
+int main(int argc, char **argv)
+{
+   double seconds, fade, pitch, *input, *output;
+   int input_count, input_rate, output_count, output_rate, status;
+
+   if( argc != 7 )
+   {
+      return printf("%s {input.wav} {seconds} {fade} {pitch} {output_rate} "
+                    "{output.wav}\n", *argv);
+   }
+   seconds = atof(argv[2]);
+   fade = atof(argv[3]);
+   pitch = atof(argv[4]);
+   output_rate = atoi(argv[5]);
+   if( seconds <= 0 || fade < 0 || pitch <= 0 || output_rate <= 0 )
+   {
+      fprintf(stderr, "Invalid parameters: %s %s %s %s\n",
+              argv[2], argv[3], argv[4], argv[5]);
+      return 1;
+   }
+
+   input = LoadSamples(argv[1], seconds, &input_count, &input_rate);
+   if( input == NULL )
+      return 1;
+   FadeOut(input, input_count, (int)(fade * input_rate + 0.5));
+   output = Resample(input, input_count,
+                     pitch * input_rate / output_rate, &output_count);
+   free(input);
+   if( output == NULL )
+      return 1;
+   if( output_count < 1 )
+   {
+      fputs("Output is empty\n", stderr);
+      free(output);
+      return 1;
+   }
+
+   status = WriteAdpcm(argv[6], output, output_count, output_rate);
+   free(output);
+   return status;
+}
@@ -0,0 +1,748 @@
+/* Shared PNG encoder.
+
+   See png_encode.h for descriptions.
+*/
+
+#include"png_encode.h"
+#include<pthread.h>
+#include<stdint.h>
+#include<setjmp.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<zlib.h>
+
+/* Maximum number of color type and bit depth combinations to try. */
+#define MAX_FORMATS 3
+
+/* Encoded PNG bytes. */
+typedef struct
+{
+   png_bytep data;
+   size_t size, capacity;
+} Buffer;
+
+/* Pixels packed for a particular color type and bit depth. */
+typedef struct
+{
+   int color_type, bit_depth;
+   png_color palette[256];
+   png_byte transparency[256];
+   int palette_size, transparency_size;
+   size_t stride;
+   png_bytep rows;
+} Format;
+
+/* Compression settings. */
+typedef struct
+{
+   int filter, level, mem_level, strategy;
+} Settings;
+
+/* Search state shared by all worker threads. */
+typedef struct
+{
+   int width, height;
+   const Format *formats;
+   int candidate_count;
+
+   pthread_mutex_t lock;
+   int next_candidate;
+   int best_candidate;
+   Buffer best;
+} Search;
+
+/* Settings for PNG_PRESET_INTERMEDIATE. */
+static const Settings intermediate_settings =
+{
+   PNG_FILTER_NONE, 1, 8, Z_DEFAULT_STRATEGY
+};
+
+/* Settings for PNG_PRESET_FINAL when there is no opportunity to search. */
+static const Settings streaming_final_settings =
+{
+   PNG_ALL_FILTERS, 9, 9, Z_FILTERED
+};
+
+static const int search_filters[] =
+{
+   PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG,
+   PNG_FILTER_PAETH, PNG_ALL_FILTERS
+};
+#define FILTER_COUNT ((int)(sizeof(search_filters) / sizeof(int)))
+
+static const int search_strategies[] =
+{
+   Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE
+};
+#define STRATEGY_COUNT ((int)(sizeof(search_strategies) / sizeof(int)))
+
+/* libpng write callback for appending to Buffer. */
+static void WriteBuffer(png_structp png_ptr, png_bytep data, png_size_t size)
+{
+   Buffer *buffer = (Buffer*)png_get_io_ptr(png_ptr);
+   png_bytep p;
+   size_t capacity;
+
+   if( buffer->size + size > buffer->capacity )
+   {
+      capacity = buffer->capacity * 2 + size + 1024;
+      p = (png_bytep)realloc(buffer->data, capacity);
+      if( p == NULL )
+         png_error(png_ptr, "Out of memory");
+      buffer->data = p;
+      buffer->capacity = capacity;
+   }
+   memcpy(buffer->data + buffer->size, data, size);
+   buffer->size += size;
+}
+
+static void FlushBuffer(png_structp png_ptr)
+{
+   (void)png_ptr;
+}
+
+/* Apply compression settings to png_ptr. */
+static void ApplySettings(png_structp png_ptr, const Settings *settings)
+{
+   png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, settings->filter);
+   png_set_compression_level(png_ptr, settings->level);
+   png_set_compression_mem_level(png_ptr, settings->mem_level);
+   png_set_compression_strategy(png_ptr, settings->strategy);
+}
+
+/* Encode pixels with a particular format and settings, writing either to
+   outfile or to buffer (when outfile is NULL).  Returns 0 on success.   */
+static int Encode(int width, int height, const Format *format,
+                  const Settings *settings, FILE *outfile, Buffer *buffer)
+{
+   /* Volatile because these are modified between setjmp and longjmp. */
+   png_structp volatile png_ptr;
+   png_infop volatile info_ptr = NULL;
+   int y;
+
+   png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+   if( png_ptr == NULL )
+      return 1;
+   info_ptr = png_create_info_struct(png_ptr);
+   if( info_ptr == NULL )
+   {
+      png_destroy_write_struct((png_structpp)&png_ptr, NULL);
+      return 1;
+   }
+
+   /* libpng prints its own error messages before jumping here. */
+   if( setjmp(png_jmpbuf(png_ptr)) )
+   {
+      png_destroy_write_struct((png_structpp)&png_ptr, (png_infopp)&info_ptr);
+      return 1;
+   }
+
+   if( outfile != NULL )
+      png_init_io(png_ptr, outfile);
+   else
+      png_set_write_fn(png_ptr, buffer, WriteBuffer, FlushBuffer);
+   png_set_IHDR(png_ptr, info_ptr, width, height, format->bit_depth,
+                format->color_type, PNG_INTERLACE_NONE,
+                PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+   if( format->palette_size > 0 )
+   {
+      png_set_PLTE(png_ptr, info_ptr, format->palette, format->palette_size);
+      if( format->transparency_size > 0 )
+      {
+         png_set_tRNS(png_ptr, info_ptr, format->transparency,
+                      format->transparency_size, NULL);
+      }
+   }
+
+   ApplySettings(png_ptr, settings);
+   png_write_info(png_ptr, info_ptr);
+   for(y = 0; y < height; y++)
+      png_write_row(png_ptr, format->rows + y * format->stride);
+   png_write_end(png_ptr, info_ptr);
+   png_destroy_write_struct((png_structpp)&png_ptr, (png_infopp)&info_ptr);
+   return 0;
+}
+
+/* Initialize format with 8bit gray plus alpha, which can represent any
+   input.  Returns 0 on success.                                         */
+static int InitGrayAlpha(int width, int height, const png_byte *pixels,
+                         Format *format)
+{
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_GRAY_ALPHA;
+   format->bit_depth = 8;
+   format->stride = (size_t)width * 2;
+   format->rows = (png_bytep)malloc(format->stride * height);
+   if( format->rows == NULL )
+      return 1;
+   memcpy(format->rows, pixels, format->stride * height);
+   return 0;
+}
+
+/* Allocate packed rows for a format with less than 8 bits per pixel.
+   Returns 0 on success.                                                 */
+static int AllocPackedRows(int width, int height, Format *format)
+{
+   format->stride = ((size_t)width * format->bit_depth + 7) / 8;
+   format->rows = (png_bytep)calloc(format->stride * height, 1);
+   return format->rows == NULL;
+}
+
+/* Store one packed pixel value. */
+static void SetPackedPixel(Format *format, int x, int y, int value)
+{
+   const int pixels_per_byte = 8 / format->bit_depth;
+   const int shift =
+      8 - format->bit_depth * (x % pixels_per_byte + 1);
+
+   format->rows[y * format->stride + x / pixels_per_byte] |=
+      (png_byte)(value << shift);
+}
+
+/* Initialize format with gray only, if all pixels are opaque.  Bit depth
+   is reduced if all gray levels can be represented exactly.  Returns 1
+   if this format is applicable, 0 if not, -1 on error.                  */
+static int InitGray(int width, int height, const png_byte *pixels,
+                    Format *format)
+{
+   const int size = width * height;
+   int i, bit_depth, step, x, y;
+
+   for(i = 0; i < size; i++)
+   {
+      if( pixels[i * 2 + 1] != 0xff )
+         return 0;
+   }
+
+   for(bit_depth = 1; bit_depth < 8; bit_depth *= 2)
+   {
+      step = 255 / ((1 << bit_depth) - 1);
+      for(i = 0; i < size && pixels[i * 2] % step == 0; i++);
+      if( i == size )
+         break;
+   }
+
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_GRAY;
+   format->bit_depth = bit_depth;
+   if( bit_depth == 8 )
+   {
+      format->stride = (size_t)width;
+      format->rows = (png_bytep)malloc(format->stride * height);
+      if( format->rows == NULL )
+         return -1;
+      for(i = 0; i < size; i++)
+         format->rows[i] = pixels[i * 2];
+      return 1;
+   }
+
+   if( AllocPackedRows(width, height, format) != 0 )
+      return -1;
+   step = 255 / ((1 << bit_depth) - 1);
+   for(y = 0; y < height; y++)
+   {
+      for(x = 0; x < width; x++)
+         SetPackedPixel(format, x, y, pixels[(y * width + x) * 2] / step);
+   }
+   return 1;
+}
+
+/* Initialize format with a palette, if there are no more than 256
+   distinct pixel values.  Returns 1 if this format is applicable, 0 if
+   not, -1 on error.                                                     */
+static int InitPalette(int width, int height, const png_byte *pixels,
+                       Format *format)
+{
+   const int size = width * height;
+   int *index;
+   int i, key, count = 0, opaque_count = 0, x, y;
+
+   /* Index is keyed by (alpha << 8) | gray.  Translucent entries are
+      assigned first, so that tRNS can omit the opaque entries that
+      follow.  This also provides a deterministic palette order.         */
+   index = (int*)malloc(0x10000 * sizeof(int));
+   if( index == NULL )
+      return -1;
+   memset(index, 0, 0x10000 * sizeof(int));
+   for(i = 0; i < size; i++)
+      index[(pixels[i * 2 + 1] << 8) | pixels[i * 2]] = 1;
+   for(key = 0; key < 0x10000; key++)
+   {
+      if( index[key] != 0 )
+      {
+         count++;
+         if( (key >> 8) == 0xff )
+            opaque_count++;
+      }
+   }
+   if( count > 256 )
+   {
+      free(index);
+      return 0;
+   }
+
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_PALETTE;
+   for(format->bit_depth = 1; (1 << format->bit_depth) < count;
+       format->bit_depth *= 2);
+   format->palette_size = count;
+   format->transparency_size = count - opaque_count;
+   count = 0;
+   for(key = 0; key < 0x10000; key++)
+   {
+      if( index[key] == 0 )
+         continue;
+      format->palette[count].red =
+      format->palette[count].green =
+      format->palette[count].blue = (png_byte)(key & 0xff);
+      if( count < format->transparency_size )
+         format->transparency[count] = (png_byte)(key >> 8);
+      index[key] = count++;
+   }
+
+   if( format->bit_depth == 8 )
+   {
+      format->stride = (size_t)width;
+      format->rows = (png_bytep)malloc(format->stride * height);
+      if( format->rows == NULL )
+      {
+         free(index);
+         return -1;
+      }
+      for(i = 0; i < size; i++)
+         format->rows[i] = (png_byte)index[(pixels[i * 2 + 1] << 8) | pixels[i * 2]];
+   }
+   else
+   {
+      if( AllocPackedRows(width, height, format) != 0 )
+      {
+         free(index);
+         return -1;
+      }
+      for(y = 0; y < height; y++)
+      {
+         for(x = 0; x < width; x++)
+         {
+            i = (y * width + x) * 2;
+            SetPackedPixel(format, x, y,
+                           index[(pixels[i + 1] << 8) | pixels[i]]);
+         }
+      }
+   }
+   free(index);
+   return 1;
+}
+
+/* Initialize format with 8bit RGB plus alpha, which can represent any
+   color input.  Returns 0 on success.                                   */
+static int InitColorAlpha(int width, int height, const png_byte *pixels,
+                          Format *format)
+{
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+   format->bit_depth = 8;
+   format->stride = (size_t)width * 4;
+   format->rows = (png_bytep)malloc(format->stride * height);
+   if( format->rows == NULL )
+      return 1;
+   memcpy(format->rows, pixels, format->stride * height);
+   return 0;
+}
+
+/* Initialize format with 8bit RGB only, if all pixels are opaque.
+   Returns 1 if this format is applicable, 0 if not, -1 on error.        */
+static int InitColor(int width, int height, const png_byte *pixels,
+                     Format *format)
+{
+   const int size = width * height;
+   int i;
+
+   for(i = 0; i < size; i++)
+   {
+      if( pixels[i * 4 + 3] != 0xff )
+         return 0;
+   }
+
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_RGB;
+   format->bit_depth = 8;
+   format->stride = (size_t)width * 3;
+   format->rows = (png_bytep)malloc(format->stride * height);
+   if( format->rows == NULL )
+      return -1;
+   for(i = 0; i < size; i++)
+      memcpy(format->rows + i * 3, pixels + i * 4, 3);
+   return 1;
+}
+
+/* Pack RGBA pixel into a key that sorts translucent colors first. */
+static uint32_t ColorKey(const png_byte *pixel)
+{
+   return ((uint32_t)pixel[3] << 24) | ((uint32_t)pixel[0] << 16) |
+          ((uint32_t)pixel[1] << 8) | (uint32_t)pixel[2];
+}
+
+static int CompareKeys(const void *a, const void *b)
+{
+   const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+   return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/* Initialize format with a palette, if there are no more than 256
+   distinct RGBA values.  Returns 1 if this format is applicable, 0 if
+   not, -1 on error.  Same palette order as InitPalette.                 */
+static int InitColorPalette(int width, int height, const png_byte *pixels,
+                            Format *format)
+{
+   const int size = width * height;
+   uint32_t *keys, key;
+   int i, count, opaque_count = 0, x, y, value;
+
+   /* Collect distinct keys by sorting a copy of all pixels. */
+   keys = (uint32_t*)malloc(size * sizeof(uint32_t));
+   if( keys == NULL )
+      return -1;
+   for(i = 0; i < size; i++)
+      keys[i] = ColorKey(pixels + i * 4);
+   qsort(keys, size, sizeof(uint32_t), CompareKeys);
+   for(i = count = 0; i < size; i++)
+   {
+      if( count > 0 && keys[count - 1] == keys[i] )
+         continue;
+      if( count == 256 )
+      {
+         free(keys);
+         return 0;
+      }
+      keys[count++] = keys[i];
+   }
+
+   memset(format, 0, sizeof(Format));
+   format->color_type = PNG_COLOR_TYPE_PALETTE;
+   for(format->bit_depth = 1; (1 << format->bit_depth) < count;
+       format->bit_depth *= 2);
+   format->palette_size = count;
+   for(i = 0; i < count; i++)
+   {
+      format->palette[i].red = (png_byte)(keys[i] >> 16);
+      format->palette[i].green = (png_byte)(keys[i] >> 8);
+      format->palette[i].blue = (png_byte)keys[i];
+      format->transparency[i] = (png_byte)(keys[i] >> 24);
+      if( (keys[i] >> 24) == 0xff )
+         opaque_count++;
+   }
+   format->transparency_size = count - opaque_count;
+
+   if( format->bit_depth == 8 )
+   {
+      format->stride = (size_t)width;
+      format->rows = (png_bytep)malloc(format->stride * height);
+   }
+   else
+   {
+      AllocPackedRows(width, height, format);
+   }
+   if( format->rows == NULL )
+   {
+      free(keys);
+      return -1;
+   }
+   for(y = 0; y < height; y++)
+   {
+      for(x = 0; x < width; x++)
+      {
+         key = ColorKey(pixels + (y * width + x) * 4);
+         value = (int)((uint32_t*)bsearch(&key, keys, count,
+                                          sizeof(uint32_t), CompareKeys) -
+                       keys);
+         if( format->bit_depth == 8 )
+            format->rows[y * format->stride + x] = (png_byte)value;
+         else
+            SetPackedPixel(format, x, y, value);
+      }
+   }
+   free(keys);
+   return 1;
+}
+
+/* Worker thread for encoding candidates. */
+static void *SearchWorker(void *arg)
+{
+   Search *search = (Search*)arg;
+   Buffer buffer;
+   Settings settings;
+   int candidate, i;
+
+   buffer.data = NULL;
+   buffer.capacity = 0;
+   for(;;)
+   {
+      pthread_mutex_lock(&(search->lock));
+      candidate = search->next_candidate++;
+      pthread_mutex_unlock(&(search->lock));
+      if( candidate >= search->candidate_count )
+         break;
+
+      i = candidate;
+      settings.strategy = search_strategies[i % STRATEGY_COUNT];
+      i /= STRATEGY_COUNT;
+      settings.filter = search_filters[i % FILTER_COUNT];
+      i /= FILTER_COUNT;
+      settings.level = 9;
+      settings.mem_level = 9;
+      buffer.size = 0;
+      if( Encode(search->width, search->height, &(search->formats[i]),
+                 &settings, NULL, &buffer) != 0 )
+      {
+         continue;
+      }
+
+      /* Keep the smallest output, breaking ties by candidate index so
+         that output does not depend on thread scheduling.               */
+      pthread_mutex_lock(&(search->lock));
+      if( search->best.data == NULL ||
+          buffer.size < search->best.size ||
+          (buffer.size == search->best.size &&
+           candidate < search->best_candidate) )
+      {
+         Buffer swap = search->best;
+         search->best = buffer;
+         search->best_candidate = candidate;
+         buffer = swap;
+      }
+      pthread_mutex_unlock(&(search->lock));
+   }
+   free(buffer.data);
+   return NULL;
+}
+
+/* Encode with all candidate settings and write the smallest output.
+   Pixels are gray plus alpha if channels is 2, RGBA if channels is 4.
+   Returns 0 on success.                                                 */
+static int SaveSmallest(FILE *outfile, int width, int height,
+                        const png_byte *pixels, int channels)
+{
+   Format formats[MAX_FORMATS];
+   pthread_t threads[64];
+   Search search;
+   long cpu_count;
+   int format_count = 0, thread_count, status = 1, i, r;
+
+   if( channels == 2 )
+   {
+      if( InitGrayAlpha(width, height, pixels, &formats[0]) != 0 )
+         return 1;
+   }
+   else
+   {
+      if( InitColorAlpha(width, height, pixels, &formats[0]) != 0 )
+         return 1;
+   }
+   format_count++;
+   for(i = 0; i < 2; i++)
+   {
+      if( channels == 2 )
+      {
+         r = i == 0
+             ? InitGray(width, height, pixels, &formats[format_count])
+             : InitPalette(width, height, pixels, &formats[format_count]);
+      }
+      else
+      {
+         r = i == 0
+             ? InitColor(width, height, pixels, &formats[format_count])
+             : InitColorPalette(width, height, pixels,
+                                &formats[format_count]);
+      }
+      if( r < 0 )
+         goto cleanup;
+      format_count += r;
+   }
+
+   search.width = width;
+   search.height = height;
+   search.formats = formats;
+   search.candidate_count = format_count * FILTER_COUNT * STRATEGY_COUNT;
+   search.next_candidate = 0;
+   search.best_candidate = 0;
+   search.best.data = NULL;
+   search.best.size = search.best.capacity = 0;
+   pthread_mutex_init(&(search.lock), NULL);
+
+   cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+   thread_count = cpu_count < 1 ? 1 :
+                  cpu_count > 64 ? 64 : (int)cpu_count;
+   for(i = 0; i < thread_count; i++)
+   {
+      if( pthread_create(&threads[i], NULL, SearchWorker, &search) != 0 )
+         break;
+   }
+   thread_count = i;
+
+   /* Current thread helps out too, which also guarantees progress in
+      case no threads could be created.                                  */
+   SearchWorker(&search);
+   for(i = 0; i < thread_count; i++)
+      pthread_join(threads[i], NULL);
+   pthread_mutex_destroy(&(search.lock));
+
+   if( search.best.data != NULL )
+   {
+      if( fwrite(search.best.data, search.best.size, 1, outfile) == 1 )
+         status = 0;
+      free(search.best.data);
+   }
+
+cleanup:
+   for(i = 0; i < format_count; i++)
+      free(formats[i].rows);
+   return status;
+}
+
+/* Write pixels to an open file.  Returns 0 on success. */
+static int WritePng(FILE *outfile, int width, int height,
+                    const png_byte *pixels, int channels, PngPreset preset)
+{
+   Format format;
+
+   if( preset == PNG_PRESET_FINAL )
+      return SaveSmallest(outfile, width, height, pixels, channels);
+
+   /* Encode directly from input pixels, without copying. */
+   memset(&format, 0, sizeof(format));
+   format.color_type = channels == 2 ? PNG_COLOR_TYPE_GRAY_ALPHA
+                                     : PNG_COLOR_TYPE_RGB_ALPHA;
+   format.bit_depth = 8;
+   format.stride = (size_t)width * channels;
+   format.rows = (png_bytep)pixels;
+   return Encode(width, height, &format, &intermediate_settings, outfile,
+                 NULL);
+}
+
+int ParsePngPreset(int *argc, char **argv, PngPreset *preset)
+{
+   const char *name;
+   int i, j, skip;
+
+   *preset = PNG_PRESET_INTERMEDIATE;
+   for(i = 1; i < *argc; i++)
+   {
+      if( strncmp(argv[i], "--preset=", 9) == 0 )
+      {
+         name = argv[i] + 9;
+         skip = 1;
+      }
+      else if( strcmp(argv[i], "--preset") == 0 && i + 1 < *argc )
+      {
+         name = argv[i + 1];
+         skip = 2;
+      }
+      else
+      {
+         continue;
+      }
+
+      if( strcmp(name, "intermediate") == 0 )
+      {
+         *preset = PNG_PRESET_INTERMEDIATE;
+      }
+      else if( strcmp(name, "final") == 0 )
+      {
+         *preset = PNG_PRESET_FINAL;
+      }
+      else
+      {
+         fprintf(stderr, "Unknown preset: %s\n", name);
+         return 1;
+      }
+
+      for(j = i; j + skip <= *argc; j++)
+         argv[j] = argv[j + skip];
+      *argc -= skip;
+      i--;
+   }
+   return 0;
+}
+
+void ApplyPngPreset(png_structp png_ptr, PngPreset preset)
+{
+   ApplySettings(png_ptr, preset == PNG_PRESET_FINAL
+                          ? &streaming_final_settings
+                          : &intermediate_settings);
+}
+
+/* Write pixels to file or stdout.  Returns 0 on success. */
+static int SaveFile(const char *filename, int width, int height,
+                    const png_byte *pixels, int channels, PngPreset preset)
+{
+   FILE *outfile;
+   int status;
+
+   if( strcmp(filename, "-") == 0 )
+   {
+      if( WritePng(stdout, width, height, pixels, channels, preset) != 0 )
+      {
+         fputs("Error writing to stdout\n", stderr);
+         return 1;
+      }
+      return 0;
+   }
+
+   outfile = fopen(filename, "wb");
+   if( outfile == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", filename);
+      return 1;
+   }
+   status = WritePng(outfile, width, height, pixels, channels, preset);
+   if( fclose(outfile) != 0 )
+      status = 1;
+   if( status != 0 )
+   {
+      /* Remove partial output, so that make doesn't see it as being up
+         to date.                                                       */
+      remove(filename);
+      fprintf(stderr, "Error writing %s\n", filename);
+   }
+   return status;
+}
+
+int SavePng(const char *filename, int width, int height,
+            const png_byte *pixels, PngPreset preset)
+{
+   return SaveFile(filename, width, height, pixels, 2, preset);
+}
+
+int SaveColorPng(const char *filename, int width, int height,
+                 const png_byte *pixels, PngPreset preset)
+{
+   const int size = width * height;
+   png_bytep gray;
+   int i, status;
+
+   for(i = 0; i < size; i++)
+   {
+      if( pixels[i * 4] != pixels[i * 4 + 1] ||
+          pixels[i * 4] != pixels[i * 4 + 2] )
+      {
+         return SaveFile(filename, width, height, pixels, 4, preset);
+      }
+   }
+
+   gray = (png_bytep)malloc((size_t)size * 2);
+   if( gray == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return 1;
+   }
+   for(i = 0; i < size; i++)
+   {
+      gray[i * 2] = pixels[i * 4];
+      gray[i * 2 + 1] = pixels[i * 4 + 3];
+   }
+   status = SaveFile(filename, width, height, gray, 2, preset);
+   free(gray);
+   return status;
+}
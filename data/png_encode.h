@@ -0,0 +1,61 @@
+/* Shared PNG encoder with named presets.
+
+   Almost all our tools operate on 8bit gray plus 8bit alpha pixels (the
+   exception being the itch.io cover, which is in color), and only differ
+   in how much effort should be spent on compression:
+
+   - Intermediate files are read once by the next build step and then
+     thrown away, so we want them written as quickly as possible.
+
+   - Final files are committed to source/images, so we want them as small
+     as possible, and don't mind spending extra CPU time to get there.
+
+   Each tool accepts a "--preset={name}" flag to select between these.
+*/
+
+#ifndef PNG_ENCODE_H_
+#define PNG_ENCODE_H_
+
+#include<png.h>
+
+typedef enum
+{
+   /* No filtering and zlib level 1.  This is the default. */
+   PNG_PRESET_INTERMEDIATE,
+
+   /* Try all lossless color type and bit depth reductions, all filters,
+      and all zlib strategies at level 9, and keep the smallest output.
+      Candidates are encoded in parallel across all available CPUs.      */
+   PNG_PRESET_FINAL
+} PngPreset;
+
+/* Remove "--preset={name}" or "--preset {name}" from command line
+   arguments, and update argc accordingly.  Preset is set to
+   PNG_PRESET_INTERMEDIATE if there is no preset flag.
+
+   Returns 0 on success.  On failure, an error message is written to
+   stderr and nonzero is returned.                                       */
+int ParsePngPreset(int *argc, char **argv, PngPreset *preset);
+
+/* Apply preset to a png_ptr that is about to write rows directly, for
+   tools that encode rows as they are produced.  These can't search for
+   the best settings, so PNG_PRESET_FINAL just uses level 9 and lets
+   libpng select filters adaptively.                                     */
+void ApplyPngPreset(png_structp png_ptr, PngPreset preset);
+
+/* Write 8bit gray plus 8bit alpha pixels to file, or to stdout if
+   filename is "-".  Rows are packed with no padding.
+
+   Returns 0 on success.  On failure, an error message is written to
+   stderr, partial output file is removed, and nonzero is returned.      */
+int SavePng(const char *filename, int width, int height,
+            const png_byte *pixels, PngPreset preset);
+
+/* Same as SavePng, but for 8bit RGBA pixels.  If all pixels are gray,
+   output is the same as SavePng on the gray plus alpha channels.  For
+   PNG_PRESET_FINAL, color images are searched over RGBA, RGB, and
+   palette formats.                                                      */
+int SaveColorPng(const char *filename, int width, int height,
+                 const png_byte *pixels, PngPreset preset);
+
+#endif
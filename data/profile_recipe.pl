@@ -0,0 +1,98 @@
+#!/usr/bin/perl -w
+# Usage:
+#
+#  make SHELL='perl profile_recipe.pl {log} $@' [targets...]
+#
+# Run each recipe line through /bin/sh, and append one line to log
+# recording how long it took.  Log can then be summarized with
+# generate_build_graph.pl --profile.
+#
+# This works because make expands SHELL separately for each recipe line,
+# so "$@" is replaced by the target being built.  Make then runs:
+#
+#   perl profile_recipe.pl {log} {target} -c {command}
+#
+# Each log line contains these tab-separated fields:
+#
+#   target, start time, end time, user CPU, system CPU, peak RSS, command
+#
+# Times are in seconds.  Start and end are wall clock times, CPU times
+# include all child processes of the recipe.  Peak RSS is in kilobytes,
+# and is the peak of the largest single process in the recipe, or 0 if
+# it's not available on this system.
+#
+# Note that make also uses SHELL for $(shell ...) functions, where $@ is
+# empty.  Those are run without logging.
+
+use strict;
+use Cwd qw(abs_path);
+use Fcntl qw(:flock);
+use Time::HiRes qw(time);
+
+use constant RUSAGE_CHILDREN => -1;
+
+# Get CPU times and peak RSS of all reaped child processes.
+sub child_usage()
+{
+   # Use getrusage if syscall numbers are available, since that's the
+   # only way to get peak RSS without extra modules.  Fall back to
+   # Perl's builtin times otherwise.
+   if( eval { require 'syscall.ph'; 1; } )
+   {
+      # struct rusage on 64bit Linux is two timevals followed by 14 longs,
+      # with ru_maxrss being the first long.
+      my $buffer = "\0" x 144;
+      if( syscall(&SYS_getrusage, RUSAGE_CHILDREN, $buffer) == 0 )
+      {
+         my @fields = unpack "q18", $buffer;
+         return $fields[0] + $fields[1] / 1e6,
+                $fields[2] + $fields[3] / 1e6,
+                $fields[4];
+      }
+   }
+   my (undef, undef, $user, $system) = times;
+   return $user, $system, 0;
+}
+
+
+if( $#ARGV < 2 )
+{
+   die "$0 {log} {target} {shell flags...} {command}\n";
+}
+my $log = shift @ARGV;
+my $target = shift @ARGV;
+my $command = $ARGV[-1];
+
+if( $target eq "" )
+{
+   exec "/bin/sh", @ARGV or die "/bin/sh: $!\n";
+}
+
+# Resolve log path before running command, in case command changes the
+# current directory.
+$log = abs_path($log) // $log;
+
+my $start = time;
+my $pid = fork;
+defined $pid or die "fork: $!\n";
+if( $pid == 0 )
+{
+   exec "/bin/sh", @ARGV or die "/bin/sh: $!\n";
+}
+waitpid($pid, 0);
+my $status = $?;
+my $end = time;
+my ($user, $system, $rss) = child_usage();
+
+# Write log entry in a single print while holding a lock, so that entries
+# from parallel recipes are not interleaved.
+$command =~ s/[\t\n]/ /gs;
+open my $outfile, ">>", $log or die "$log: $!\n";
+flock $outfile, LOCK_EX;
+printf $outfile "%s\t%.6f\t%.6f\t%.3f\t%.3f\t%d\t%s\n",
+       $target, $start, $end, $user, $system, $rss, $command;
+close $outfile;
+
+# Pass through exit status of the recipe, so that make still stops on
+# the first failure.
+exit($status & 127 ? 128 + ($status & 127) : $status >> 8);
@@ -2,15 +2,17 @@
 
    Usage:
 
-      ./random_dither {input.png} {output.png}
+      ./random_dither [--preset={preset}] {input.png} {output.png}
 
-   Use "-" for input or output to read/write from stdin/stdout.
+   Use "-" for input or output to read/write from stdin/stdout.  See
+   png_encode.h for available presets.
 
    Given a grayscale (8bit) plus alpha (8bit) PNG, output a black and
    white (1bit) plus transparency (1bit) PNG, by using input pixel level
    to probabilistically set the output bit.
 */
 
+#include"png_encode.h"
 #include<png.h>
 #include<stdio.h>
 #include<stdlib.h>
@@ -31,10 +33,13 @@ int main(int argc, char **argv)
 {
    png_image image;
    png_bytep pixels, p;
+   PngPreset preset;
    int x, y;
 
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
    if( argc != 3 )
-      return printf("%s {input.png} {output.png}\n", *argv);
+      return printf("%s [--preset={preset}] {input.png} {output.png}\n", *argv);
    if( strcmp(argv[2], "-") == 0 && isatty(STDOUT_FILENO) )
    {
       fputs("Not writing output to stdout because it's a tty\n", stderr);
@@ -93,29 +98,8 @@ int main(int argc, char **argv)
       }
    }
 
-   /* Write output.  Here we set the flags to optimize for encoding speed
-      rather than output size so that we can iterate faster.  This is fine
-      since the output of this tool are intermediate files that are used
-      only in the build process, and are not the final PNGs that will be
-      committed.                                                           */
-   image.flags |= PNG_IMAGE_FLAG_FAST;
-   x = 0;
-   if( strcmp(argv[2], "-") == 0 )
-   {
-      if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
-      {
-         fputs("Error writing to stdout\n", stderr);
-         x = 1;
-      }
-   }
-   else
-   {
-      if( !png_image_write_to_file(&image, argv[2], 0, pixels, 0, NULL) )
-      {
-         printf("Error writing %s\n", argv[2]);
-         x = 1;
-      }
-   }
+   /* Write output. */
+   x = SavePng(argv[2], (int)image.width, (int)image.height, pixels, preset);
    free(pixels);
    return x;
 }
@@ -28,12 +28,34 @@
    + Level 6: 0.00708700
    + Level 7: 0.00726962
    + Level 8: 0.00724638
+
+   Usage:
+
+      ./random_walk_experiment [{max_depth} [{width} {max_bits}]]
+
+   {max_depth} defaults to 6.  If {width} and {max_bits} are specified, a
+   single experimental level with up to 16 bits is simulated instead of
+   the levels used by the game.
+
+   Alternatively:
+
+      ./random_walk_experiment --sweep {steps} [{max_width}]
+
+   Computes exact probabilities of completing a chain within 1..{steps}
+   steps, for all bit widths from 2 to {max_width} (default 8), all
+   numbers of bits set, and all odds of getting all-zero targets from 2
+   to 64.  Each line of output is:
+
+      {width} {max_bits} {odds_of_all_zeroes} {p_1} {p_2} ... {p_steps}
+
+   Build with "g++ -O3 -pthread random_walk_experiment.cc".
 */
 
-#include<inttypes.h>
 #include<stdio.h>
+#include<stdlib.h>
 
-#include<map>
+#include<string>
+#include<thread>
 #include<utility>
 #include<vector>
 
@@ -42,6 +64,12 @@ namespace {
 // Odds of getting an all-zero target.
 static constexpr int kOddsOfAllZeroes = 13;
 
+// Maximum supported bit width.
+static constexpr int kMaxWidth = 16;
+
+// Upper bound of kOddsOfAllZeroes to try in sweep mode.
+static constexpr int kMaxOddsOfAllZeroes = 64;
+
 // Level definitions.  See generate_bit_table.pl.
 typedef struct
 {
@@ -59,22 +87,29 @@ static constexpr LevelInfo kLevels[8] =
 using ValueList = std::vector<int>;
 
 // Pair of result counts: (accepted, total).
-using SimulationResult = std::pair<uint64_t, uint64_t>;
+//
+// Counts grow exponentially with depth, and would overflow 64bit integers
+// at around depth 8 for 8bit levels.  Long double has at least as many
+// mantissa bits as uint64_t on x86, so results are still exact for all
+// depths that used to fit, and deeper results lose precision gracefully.
+using SimulationResult = std::pair<long double, long double>;
 
-// Memoized result for each (start, depth).
-using MemoizedResult = std::map<std::pair<int, int>, SimulationResult>;
+// Results for all starting values at a single depth, indexed by start.
+using DepthResult = std::vector<SimulationResult>;
 
 // Count number of bits set.
 static int BitCount(int x)
 {
-   x = (x & 0x55) + ((x >> 1) & 0x55);
-   x = (x & 0x33) + ((x >> 2) & 0x33);
-   x = (x & 0x0f) + ((x >> 4) & 0x0f);
+   x = (x & 0x5555) + ((x >> 1) & 0x5555);
+   x = (x & 0x3333) + ((x >> 2) & 0x3333);
+   x = (x & 0x0f0f) + ((x >> 4) & 0x0f0f);
+   x = (x & 0x00ff) + ((x >> 8) & 0x00ff);
    return x;
 }
 
 // Generate list of value candidates for a single level.
-static ValueList GenerateBitTable(const LevelInfo &level)
+static ValueList GenerateBitTable(const LevelInfo &level,
+                                  int odds_of_all_zeroes = kOddsOfAllZeroes)
 {
    ValueList r;
 
@@ -84,104 +119,267 @@ static ValueList GenerateBitTable(const LevelInfo &level)
          r.push_back(i);
    }
 
-   const int zero_padding = static_cast<int>(r.size() / (kOddsOfAllZeroes - 1));
+   const int zero_padding = static_cast<int>(r.size() / (odds_of_all_zeroes - 1));
    for(int i = 0; i < zero_padding; i++)
       r.push_back(0);
 
    return r;
 }
 
-// Get results for chains up to a certain depth.
+// Get results for chains up to a certain depth, for all starting values.
 //
 // This function answers the question: given a fixed starting position,
 // how many expansions from this position will result in a completed chain?
-static const SimulationResult &SimulateRecursive(const ValueList &values,
-                                                 int all_ones,
-                                                 int start,
-                                                 int depth,
-                                                 MemoizedResult *cache)
+//
+// Results for each depth only depend on results from the previous depth,
+// so the table is filled bottom-up from depth 0.
+static void SimulateDepth(const ValueList &values,
+                          int all_ones,
+                          const DepthResult *previous,
+                          DepthResult *output)
 {
-   std::pair<MemoizedResult::iterator, bool> p = cache->insert(
-      std::make_pair(std::make_pair(start, depth), SimulationResult()));
-   if( !p.second )
-      return p.first->second;
-
-   SimulationResult r = {0, 0};
-
-   for(int i : values)
+   output->assign(all_ones + 1, SimulationResult(0, 0));
+   for(int start = 0; start <= all_ones; start++)
    {
-      if( (start ^ i) == 0 || (start ^ i) == all_ones )
-      {
-         r.first++;
-         r.second++;
-      }
-      else
+      SimulationResult &r = (*output)[start];
+      for(int i : values)
       {
-         if( depth > 0 )
+         if( (start ^ i) == 0 || (start ^ i) == all_ones )
          {
-            const SimulationResult &r1 = SimulateRecursive(
-               values, all_ones, start ^ i, depth - 1, cache);
-            r.first += r1.first;
-            r.second += r1.second;
+            r.first++;
+            r.second++;
          }
          else
          {
-            r.second++;
+            if( previous != nullptr )
+            {
+               const SimulationResult &r1 = (*previous)[start ^ i];
+               r.first += r1.first;
+               r.second += r1.second;
+            }
+            else
+            {
+               r.second++;
+            }
          }
       }
    }
-   p.first->second = r;
-   return p.first->second;
 }
 
 // For all starting positions, count number acceptable outcomes when
-// traversing up to depth number of steps.
+// traversing up to the depth represented by results.
 //
 // This function answers the question: for all starting positions, how many
 // expansions from those positions will result in a completed chain?
-static SimulationResult SimulateStep(const ValueList &values,
-                                     int all_ones,
-                                     int depth,
-                                     MemoizedResult *cache)
+static SimulationResult SimulateStep(int all_ones, const DepthResult &results)
 {
    SimulationResult r = {0, 0};
 
    // Try all starting values except those with all zero or one bits.
    for(int i = 1; i < all_ones; i++)
    {
-      const SimulationResult &r1 =
-         SimulateRecursive(values, all_ones, i, depth, cache);
-      r.first += r1.first;
-      r.second += r1.second;
+      r.first += results[i].first;
+      r.second += results[i].second;
+   }
+   return r;
+}
+
+// Append formatted result to output.  Counts are printed exactly while
+// they fit in 64 bits, and in scientific notation after that.
+static void PrintResult(const SimulationResult &r, std::string *output)
+{
+   char buffer[128];
+   snprintf(buffer, sizeof(buffer),
+            r.second < 0x1p64L ? "%.0Lf / %.0Lf = %.8f\n"
+                               : "%.8Le / %.8Le = %.8f\n",
+            r.first, r.second,
+            static_cast<double>(r.first / r.second));
+   *output += buffer;
+}
+
+// Run simulation for a single level, writing results to output.
+static void SimulateLevel(int level_number,
+                          const LevelInfo &level,
+                          int max_depth,
+                          std::string *output)
+{
+   const ValueList values = GenerateBitTable(level);
+   const int all_ones = (1 << level.width) - 1;
+
+   char buffer[64];
+   snprintf(buffer, sizeof(buffer), "Level %d, %d values:\n",
+            level_number, static_cast<int>(values.size()));
+   *output = buffer;
+
+   // Only two depths need to be kept at a time.
+   DepthResult results[2];
+   for(int depth = 0; depth < max_depth; depth++)
+   {
+      SimulateDepth(values, all_ones,
+                    depth > 0 ? &results[(depth - 1) & 1] : nullptr,
+                    &results[depth & 1]);
+      snprintf(buffer, sizeof(buffer), "   Step(%d): ", depth);
+      *output += buffer;
+      PrintResult(SimulateStep(all_ones, results[depth & 1]), output);
+   }
+}
+
+// In-place fast Walsh-Hadamard transform.  Applying this twice returns
+// the original data scaled by data size.
+//
+// Inner loop operates on two contiguous ranges with no dependencies
+// between iterations, so that compiler can vectorize it.
+static void WalshHadamard(std::vector<double> *data)
+{
+   double *d = data->data();
+   const int size = static_cast<int>(data->size());
+   for(int h = 1; h < size; h <<= 1)
+   {
+      for(int i = 0; i < size; i += h << 1)
+      {
+         double *a = d + i;
+         double *b = d + i + h;
+         for(int j = 0; j < h; j++)
+         {
+            const double x = a[j];
+            const double y = b[j];
+            a[j] = x + y;
+            b[j] = x - y;
+         }
+      }
+   }
+}
+
+// Compute probability of completing a chain within each number of steps,
+// starting from a random value that is not all zeroes or all ones.
+//
+// This treats the chain as a Markov chain over XOR values, where the all
+// zero and all one values are absorbing.  Each step is an XOR convolution
+// of the current distribution with the value distribution, which is a
+// pointwise product after Walsh-Hadamard transform.  So this costs
+// O(steps * 2**width * width), as opposed to enumerating all paths.
+//
+// Note that this is a different quantity from what SimulateStep computes:
+// SimulateStep counts enumerated outcomes, whereas this weighs each
+// outcome by its probability.
+static std::vector<double> AbsorptionProbabilities(const ValueList &values,
+                                                   int width,
+                                                   int steps)
+{
+   const int size = 1 << width;
+   const int all_ones = size - 1;
+
+   // Transformed value distribution.
+   std::vector<double> p(size, 0.0);
+   for(int i : values)
+      p[i] += 1.0 / static_cast<double>(values.size());
+   WalshHadamard(&p);
+
+   // Distribution of current values over transient states.
+   std::vector<double> q(size, 1.0 / static_cast<double>(size - 2));
+   q[0] = q[all_ones] = 0;
+
+   std::vector<double> r;
+   double absorbed = 0;
+   for(int step = 0; step < steps; step++)
+   {
+      WalshHadamard(&q);
+      for(int i = 0; i < size; i++)
+         q[i] *= p[i] / size;
+      WalshHadamard(&q);
+
+      absorbed += q[0] + q[all_ones];
+      q[0] = q[all_ones] = 0;
+      r.push_back(absorbed);
    }
    return r;
 }
 
-// Print formatted result to stdout.
-static void PrintResult(const SimulationResult &r)
+// Print absorption probabilities for all combinations of bit widths up to
+// max_width and all zero odds up to kMaxOddsOfAllZeroes, one line per
+// configuration.
+static void Sweep(int steps, int max_width)
 {
-   printf("%" PRIu64 " / %" PRIu64 " = %.8f\n",
-          r.first, r.second,
-          static_cast<double>(r.first) / static_cast<double>(r.second));
+   for(int width = 2; width <= max_width; width++)
+   {
+      for(int max_bits = 1; max_bits <= width; max_bits++)
+      {
+         const LevelInfo level = {width, max_bits};
+         for(int odds = 2; odds <= kMaxOddsOfAllZeroes; odds++)
+         {
+            const std::vector<double> r =
+               AbsorptionProbabilities(GenerateBitTable(level, odds),
+                                       width, steps);
+            printf("%d %d %d", width, max_bits, odds);
+            for(double x : r)
+               printf(" %.8f", x);
+            putchar('\n');
+         }
+      }
+   }
 }
 
 }  // namespace
 
 int main(int argc, char **argv)
 {
-   for(int level = 0; level < 8; level++)
+   if( argc >= 3 && argc <= 4 && std::string(argv[1]) == "--sweep" )
+   {
+      const int steps = atoi(argv[2]);
+      const int max_width = argc > 3 ? atoi(argv[3]) : 8;
+      if( steps < 1 || max_width < 2 || max_width > kMaxWidth )
+      {
+         fprintf(stderr, "Invalid sweep: steps=%d, max_width=%d\n",
+                 steps, max_width);
+         return 1;
+      }
+      Sweep(steps, max_width);
+      return 0;
+   }
+
+   if( argc != 1 && argc != 2 && argc != 4 )
+   {
+      fprintf(stderr,
+              "%s [{max_depth} [{width} {max_bits}]]\n"
+              "%s --sweep {steps} [{max_width}]\n",
+              *argv, *argv);
+      return 1;
+   }
+
+   const int max_depth = argc > 1 ? atoi(argv[1]) : 6;
+   if( max_depth < 1 )
    {
-      const ValueList values = GenerateBitTable(kLevels[level]);
-      const int all_ones = (1 << kLevels[level].width) - 1;
-      printf("Level %d, %d values:\n",
-             level + 1, static_cast<int>(values.size()));
+      fprintf(stderr, "Invalid depth: %d\n", max_depth);
+      return 1;
+   }
 
-      MemoizedResult cache;
-      for(int depth = 0; depth < 6; depth++)
+   std::vector<LevelInfo> levels(kLevels, kLevels + 8);
+   if( argc == 4 )
+   {
+      const LevelInfo level = {atoi(argv[2]), atoi(argv[3])};
+      if( level.width < 1 || level.width > kMaxWidth ||
+          level.max_bits < 1 || level.max_bits > level.width )
       {
-         printf("   Step(%d): ", depth);
-         PrintResult(SimulateStep(values, all_ones, depth, &cache));
+         fprintf(stderr, "Invalid level: width=%d, max_bits=%d\n",
+                 level.width, level.max_bits);
+         return 1;
       }
+      levels.assign(1, level);
+   }
+
+   // Levels are independent of each other, so each one gets its own
+   // thread.  Output is buffered so that it's printed in level order.
+   std::vector<std::string> output(levels.size());
+   std::vector<std::thread> threads;
+   for(size_t i = 0; i < levels.size(); i++)
+   {
+      threads.emplace_back(SimulateLevel, static_cast<int>(i + 1),
+                           std::cref(levels[i]), max_depth, &output[i]);
+   }
+   for(size_t i = 0; i < levels.size(); i++)
+   {
+      threads[i].join();
+      fputs(output[i].c_str(), stdout);
    }
    return 0;
 }
@@ -0,0 +1,98 @@
+#!/usr/bin/perl -w
+# Usage:
+#
+#  perl render_notes.pl {rates.lua} {note_groups.lua} {input.wav}
+#
+# Render one pitch-shifted copy of the start of input for each distinct
+# note used in NOTE_GROUPS, and write them to "note-{index}.wav"
+# in the current directory, where {index} is the 0-based index into
+# RATE_MULTIPLIER.  Rendering is done by pitch_shift.exe.
+#
+# Pitch is shifted by resampling, which is the same thing that
+# sampleplayer:play does when given a rate, so notes sound the same as
+# before.  The difference is that the device no longer needs to resample
+# by a different ratio for each note.
+#
+# Outputs are mono IMA ADPCM at 44100Hz, which is the Playdate's mixing
+# rate, so notes are played back without any rate conversion.
+#
+# Only the first INPUT_SECONDS of input are used, with the last
+# FADE_SECONDS faded out.  Past that point, the celesta decay is more than
+# 30dB below the attack, which is about the noise floor of 4bit ADPCM, so
+# the longer tail mostly cost space.  With 0.6 seconds, the 18 notes come
+# to about 168KB, compared to 276KB for a full second of input and 176KB
+# for the original 16bit stereo celesta.wav.  Low notes still play for up
+# to 0.9 seconds, since pitching down makes them longer.  Output is
+# only replaced if its contents changed, and stale notes that are no
+# longer used by NOTE_GROUPS are removed.
+
+use strict;
+
+use constant INPUT_SECONDS => 0.6;
+use constant FADE_SECONDS => 0.15;
+use constant OUTPUT_RATE => 44100;
+
+if( $#ARGV != 2 )
+{
+   die "$0 {rates.lua} {note_groups.lua} {input.wav}\n";
+}
+my ($rates_file, $groups_file, $input) = @ARGV;
+
+# Load rate multipliers, same format as generate_rate_table.pl output.
+my @rates = ();
+open my $infile, "< $rates_file" or die "$rates_file: $!\n";
+while( my $line = <$infile> )
+{
+   if( $line =~ /^\s*([[:digit:].]+),/ )
+   {
+      push @rates, $1;
+   }
+}
+close $infile;
+scalar @rates or die "$rates_file: no rates found\n";
+
+# Collect distinct notes, same format as get_max_note_channels.pl input.
+my %notes = ();
+open $infile, "< $groups_file" or die "$groups_file: $!\n";
+while( my $line = <$infile> )
+{
+   next unless $line =~ /^\s*\{([[:digit:], ]+)\},/;
+   foreach my $note (split /,/, $1)
+   {
+      $note =~ s/\s+//g;
+      next if $note eq "";
+      unless( $note < scalar @rates )
+      {
+         die "$groups_file: note $note is out of range\n";
+      }
+      $notes{$note} = 1;
+   }
+}
+close $infile;
+scalar keys %notes or die "$groups_file: no notes found\n";
+
+# Render notes.
+my $temp_output = "t_render_notes.tmp.wav";
+foreach my $note (sort {$a <=> $b} keys %notes)
+{
+   my $output = sprintf 'note-%02d.wav', $note;
+   my $command = "./pitch_shift.exe '$input' " . INPUT_SECONDS .
+                 " " . FADE_SECONDS . " $rates[$note] " . OUTPUT_RATE . " '$temp_output'";
+   system($command) == 0 or die "$command: failed\n";
+
+   if( -s $output && system("cmp -s '$temp_output' '$output'") == 0 )
+   {
+      unlink $temp_output;
+   }
+   else
+   {
+      rename $temp_output, $output or die "$output: $!\n";
+   }
+}
+
+# Remove unused notes.
+foreach my $output (glob "note-*.wav")
+{
+   next unless $output =~ /^note-(\d+)\.wav$/;
+   unlink $output unless exists $notes{$1 + 0};
+}
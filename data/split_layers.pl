@@ -0,0 +1,213 @@
+#!/usr/bin/perl -w
+# Usage:
+#
+#  perl split_layers.pl [--filter={command}] {input.svg} {spec}...
+#
+# Batch version of select_layers.pl and select_obj.pl.  Each spec is a
+# colon-separated list of either 3 or 5 fields:
+#
+#  {output.svg}:{pattern}:{output.png}
+#  {output.svg}:{pattern}:{output.png}:{layer}:{id}
+#
+# The first form is equivalent to:
+#
+#  perl select_layers.pl {pattern} {output.png} {input.svg} > {output.svg}
+#
+# The second form is equivalent to:
+#
+#  perl select_layers.pl {pattern} {output.png} {input.svg} | \
+#     perl select_obj.pl {layer} {id} > {output.svg}
+#
+# If a filter command is specified, each output is piped through that
+# command before it's written.
+#
+# The point of this script is to parse input.svg just once for all specs.
+# Removed nodes are put back after each output is written, so that the
+# next spec sees the full document again.  Outputs are only written if
+# their contents changed, which allows make to skip rebuilding dependants
+# of unchanged outputs.
+
+use strict;
+use File::Temp qw(tempfile);
+use XML::LibXML;
+
+
+# Remove a node from the document, and record where it used to be.
+sub remove_node($$)
+{
+   my ($removed_nodes, $node) = @_;
+
+   push @$removed_nodes, [$node, $node->parentNode, $node->nextSibling];
+   $node->unbindNode();
+}
+
+# Put back all removed nodes, in the reverse order of their removal.
+sub restore_nodes($)
+{
+   my ($removed_nodes) = @_;
+
+   foreach my $entry (reverse @$removed_nodes)
+   {
+      my ($node, $parent, $next) = @$entry;
+      if( defined $next )
+      {
+         $parent->insertBefore($node, $next);
+      }
+      else
+      {
+         $parent->appendChild($node);
+      }
+   }
+   @$removed_nodes = ();
+}
+
+# Check if a node is a layer.
+sub is_layer($)
+{
+   my ($group) = @_;
+
+   return defined $group->{"inkscape:groupmode"} &&
+          defined $group->{"inkscape:label"} &&
+          $group->{"inkscape:groupmode"} eq "layer";
+}
+
+# Pipe text through filter command and return the filtered output.
+sub apply_filter($$)
+{
+   my ($filter, $text) = @_;
+
+   my ($handle, $filename) = tempfile();
+   print $handle $text;
+   close $handle;
+
+   open my $pipe, "$filter < '$filename' |" or die "$filter: $!\n";
+   my $output = join "", <$pipe>;
+   my $status = close $pipe;
+   unlink $filename;
+   $status or die "$filter failed\n";
+   return $output;
+}
+
+# Write text to file, unless the file already has the same contents.
+sub write_if_changed($$)
+{
+   my ($filename, $text) = @_;
+
+   if( open my $infile, "<", $filename )
+   {
+      local $/;
+      my $old_text = <$infile>;
+      close $infile;
+      return if defined $old_text && $old_text eq $text;
+   }
+   open my $outfile, ">", $filename or die "$filename: $!\n";
+   print $outfile $text;
+   close $outfile or die "$filename: $!\n";
+}
+
+
+# Read settings from command line.
+my $filter = undef;
+if( $#ARGV >= 0 && $ARGV[0] =~ /^--filter=(.*)$/ )
+{
+   $filter = $1;
+   shift @ARGV;
+}
+if( $#ARGV < 1 )
+{
+   die "$0 [--filter={command}] {input.svg} {spec}...\n";
+}
+my $input = shift @ARGV;
+my @specs = ();
+foreach my $arg (@ARGV)
+{
+   my @fields = split /:/, $arg;
+   unless( scalar @fields == 3 || scalar @fields == 5 )
+   {
+      die "Bad spec: $arg\n";
+   }
+   push @specs, \@fields;
+}
+
+# Load XML.
+my $dom = XML::LibXML->load_xml(huge => 1, location => $input);
+
+# Collect all layers, and canonicalize their attributes.  Canonicalization
+# only matters for selected layers, and unselected layers are always
+# removed, so it's safe to do this to all layers upfront.  See
+# select_layers.pl for why these attributes are needed.
+my @layers = ();
+foreach my $group ($dom->getElementsByTagName("g"))
+{
+   next unless is_layer($group);
+   if( defined $group->{"style"} )
+   {
+      $group->{"style"} =~ s/display:none/display:inline/;
+      $group->{"style"} =~ s/opacity:0\.\d+/opacity:1/;
+   }
+   $group->{"sodipodi:insensitive"} = "true";
+   push @layers, $group;
+}
+
+# Delete view settings, same as select_layers.pl.
+foreach my $view ($dom->getElementsByTagName("sodipodi:namedview"))
+{
+   $view->parentNode->removeChild($view);
+}
+
+# Generate outputs.
+my @removed_nodes = ();
+foreach my $spec (@specs)
+{
+   my ($output, $pattern, $export_filename, $object_layer, $id) = @$spec;
+   my $layer_regex = qr/$pattern/;
+
+   # Drop layers that do not match pattern.
+   foreach my $group (@layers)
+   {
+      unless( $group->{"inkscape:label"} =~ $layer_regex )
+      {
+         remove_node(\@removed_nodes, $group);
+      }
+   }
+
+   # Drop objects that do not match ID.  This searches the document again
+   # so that only layers that are still attached are visited.
+   if( defined $object_layer )
+   {
+      foreach my $group ($dom->getElementsByTagName("g"))
+      {
+         next unless is_layer($group) &&
+                     $group->{"inkscape:label"} eq $object_layer;
+
+         my @delete_nodes = ();
+         foreach my $child ($group->childNodes())
+         {
+            my $label = eval('$child->{"inkscape:label"}');
+            unless( defined $label && $label eq $id )
+            {
+               push @delete_nodes, $child;
+            }
+         }
+         foreach my $node (@delete_nodes)
+         {
+            remove_node(\@removed_nodes, $node);
+         }
+      }
+   }
+
+   # Update export filename.
+   foreach my $svg ($dom->getElementsByTagName("svg"))
+   {
+      $svg->{"inkscape:export-filename"} = $export_filename;
+   }
+
+   my $text = $dom->toString() . "\n";
+   if( defined $filter )
+   {
+      $text = apply_filter($filter, $text);
+   }
+   write_if_changed($output, $text);
+
+   restore_nodes(\@removed_nodes);
+}
@@ -3,13 +3,30 @@
    Usage:
 
       ./stack_bw {input1.png} {input2.png} ... > {output.png}
+      ./stack_bw --leave-one-out {base.png} {output.png} {input0.png} ...
 
    This can be done with ImageMagick, but the command line options for
    compositing more than two images is cumbersome, which is why we
    have this tool.
+
+   Inputs are decoded by a pool of threads into a ring of buffers, while
+   the main thread composites whatever inputs are ready in a single pass
+   over the output.  This means decoding and compositing overlap, as
+   opposed to running strictly one after another.
+
+   The second form writes one image per {inputN.png}, where output N
+   is {base.png} composited with all inputs except {inputN.png}.
+   {output.png} is a printf pattern that takes N (e.g. "out_%x.png").
+   All inputs are decoded once, and each output only takes a single
+   composite, by combining prefix composites with precomputed suffix
+   composites.
+
+   Both forms also accept "--preset={preset}" to select PNG encoder
+   settings, see png_encode.h.
 */
 
-#include<png.h>
+#include"bitplane.h"
+#include<pthread.h>
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
@@ -20,95 +37,392 @@
    #include<io.h>
 #endif
 
-int main(int argc, char **argv)
+/* Number of decoded images that can be waiting to be composited.  This
+   is also the maximum number of decoder threads.                        */
+#define RING_SIZE    16
+
+typedef struct
 {
-   png_image image, add_image;
-   png_bytep pixels, add_pixels, r, w;
-   int i, j;
+   Bitplane image;
 
-   if( argc == 1 )
-      return fprintf(stderr, "%s {input.png} ... > {output.png}\n", *argv);
-   if( isatty(STDOUT_FILENO) )
+   /* Index of the input that was decoded into this slot, or -1 if this
+      slot is not ready.                                                 */
+   int input;
+
+   /* Result of LoadBitplane. */
+   int status;
+} RingSlot;
+
+typedef struct
+{
+   pthread_mutex_t mutex;
+
+   /* Signalled when a slot becomes ready, or when a slot becomes free. */
+   pthread_cond_t slot_ready;
+   pthread_cond_t slot_free;
+
+   char **filenames;
+   int input_count;
+
+   /* Next input to be claimed by a decoder thread. */
+   int next_input;
+
+   /* Number of inputs that have been composited.  Decoder threads may
+      work up to RING_SIZE inputs ahead of this.                         */
+   int merged_count;
+
+   /* Set when main thread wants decoder threads to stop early. */
+   int abort;
+
+   RingSlot ring[RING_SIZE];
+} DecodeQueue;
+
+/* Decoder thread entry point. */
+static void *DecodeThread(void *arg)
+{
+   DecodeQueue *queue = (DecodeQueue*)arg;
+   RingSlot *slot;
+   int input, status;
+
+   pthread_mutex_lock(&queue->mutex);
+   for(;;)
    {
-      fputs("Not writing output to stdout because it's a tty\n", stderr);
-      return 1;
+      /* Claim next input. */
+      if( queue->abort || queue->next_input >= queue->input_count )
+         break;
+      input = queue->next_input++;
+
+      /* Wait for the slot to be freed by the main thread. */
+      while( !queue->abort && input - queue->merged_count >= RING_SIZE )
+         pthread_cond_wait(&queue->slot_free, &queue->mutex);
+      if( queue->abort )
+         break;
+      slot = &queue->ring[input % RING_SIZE];
+      pthread_mutex_unlock(&queue->mutex);
+
+      status = LoadBitplane(queue->filenames[input], 0, &slot->image);
+
+      pthread_mutex_lock(&queue->mutex);
+      slot->status = status;
+      slot->input = input;
+      pthread_cond_broadcast(&queue->slot_ready);
    }
+   pthread_mutex_unlock(&queue->mutex);
+   return NULL;
+}
 
-   #ifdef _WIN32
-      setmode(STDOUT_FILENO, O_BINARY);
-   #endif
+/* Release a slot that has been successfully decoded. */
+static void FreeSlot(RingSlot *slot)
+{
+   if( slot->status == 0 )
+      FreeBitplane(&slot->image);
+   slot->input = -1;
+}
 
-   /* Load first input. */
-   memset(&image, 0, sizeof(image));
-   image.version = PNG_IMAGE_VERSION;
-   if( !png_image_begin_read_from_file(&image, argv[1]) )
-      return fprintf(stderr, "%s: read error\n", argv[1]);
+/* Composite all inputs into output.  Returns 0 on success. */
+static int MergeInputs(DecodeQueue *queue, Bitplane *output)
+{
+   const Bitplane *overlays[RING_SIZE];
+   int first, end, i, overlay_count;
+   RingSlot *slot;
+
+   for(first = 0; first < queue->input_count; first = end)
+   {
+      /* Wait for the next input, then collect all consecutive inputs
+         that are ready.                                                 */
+      pthread_mutex_lock(&queue->mutex);
+      while( queue->ring[first % RING_SIZE].input != first )
+         pthread_cond_wait(&queue->slot_ready, &queue->mutex);
+      for(end = first + 1;
+          end < queue->input_count && end < first + RING_SIZE &&
+          queue->ring[end % RING_SIZE].input == end;
+          end++);
+      pthread_mutex_unlock(&queue->mutex);
+
+      /* Check loaded images. */
+      overlay_count = 0;
+      for(i = first; i < end; i++)
+      {
+         slot = &queue->ring[i % RING_SIZE];
+         if( slot->status != 0 )
+            return 1;
+         if( i == 0 )
+         {
+            if( AllocBitplane(output, slot->image.width,
+                              slot->image.height) != 0 )
+            {
+               fputs("Out of memory\n", stderr);
+               return 1;
+            }
+            CopyBitplane(&slot->image, output);
+            continue;
+         }
+         if( slot->image.width != output->width ||
+             slot->image.height != output->height )
+         {
+            fprintf(stderr, "%s: size mismatch (%d,%d), expected (%d,%d)\n",
+                    queue->filenames[i],
+                    slot->image.width, slot->image.height,
+                    output->width, output->height);
+            return 1;
+         }
+         overlays[overlay_count++] = &slot->image;
+      }
+
+      /* Composite in one pass. */
+      StackBitplanes(output, overlays, overlay_count);
+
+      /* Release slots for decoder threads. */
+      pthread_mutex_lock(&queue->mutex);
+      for(i = first; i < end; i++)
+         FreeSlot(&queue->ring[i % RING_SIZE]);
+      queue->merged_count = end;
+      pthread_cond_broadcast(&queue->slot_free);
+      pthread_mutex_unlock(&queue->mutex);
+   }
+   return 0;
+}
 
-   image.format = PNG_FORMAT_GA;
-   pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   add_pixels = (png_bytep)malloc(PNG_IMAGE_SIZE(image));
-   if( pixels == NULL || add_pixels == NULL )
+/* Images used for leave-one-out composites.  All Bitplane entries are
+   zero-initialized, so that they can be released unconditionally.      */
+typedef struct
+{
+   int input_count;
+
+   /* Composite of base image plus inputs 0..(i-1), updated after each
+      output.                                                           */
+   Bitplane prefix;
+
+   /* Inputs. */
+   Bitplane *inputs;
+
+   /* suffix[i] holds inputs i..(input_count-1) composited together, with
+      suffix[input_count] being empty.                                  */
+   Bitplane *suffix;
+
+   Bitplane output;
+} LeaveOneOutImages;
+
+static void FreeLeaveOneOutImages(LeaveOneOutImages *images)
+{
+   int i;
+
+   for(i = 0; images->inputs != NULL && i < images->input_count; i++)
+      FreeBitplane(&images->inputs[i]);
+   for(i = 0; images->suffix != NULL && i <= images->input_count; i++)
+      FreeBitplane(&images->suffix[i]);
+   FreeBitplane(&images->prefix);
+   FreeBitplane(&images->output);
+   free(images->inputs);
+   free(images->suffix);
+}
+
+/* Load base image and all inputs.  Returns 0 on success. */
+static int LoadLeaveOneOutImages(const char *base_filename, char **filenames,
+                                 LeaveOneOutImages *images)
+{
+   int i;
+
+   images->inputs = (Bitplane*)calloc(images->input_count, sizeof(Bitplane));
+   images->suffix =
+      (Bitplane*)calloc(images->input_count + 1, sizeof(Bitplane));
+   if( images->inputs == NULL || images->suffix == NULL )
    {
       fputs("Out of memory\n", stderr);
       return 1;
    }
-   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
-      return fprintf(stderr, "%s: load error\n", argv[1]);
-
-   /* Load and composite subsequent images. */
-   for(i = 2; i < argc; i++)
+   if( LoadBitplane(base_filename, 0, &images->prefix) != 0 )
+      return 1;
+   for(i = 0; i < images->input_count; i++)
    {
-      memset(&add_image, 0, sizeof(add_image));
-      add_image.version = PNG_IMAGE_VERSION;
-      if( !png_image_begin_read_from_file(&add_image, argv[i]) )
-         return fprintf(stderr, "%s: read error\n", argv[i]);
-      if( add_image.width != image.width || add_image.height != image.height )
+      if( LoadBitplane(filenames[i], 0, &images->inputs[i]) != 0 )
+         return 1;
+      if( images->inputs[i].width != images->prefix.width ||
+          images->inputs[i].height != images->prefix.height )
       {
-         return fprintf(stderr, "%s: size mismatch (%d,%d), expected (%d,%d)\n",
-                       argv[i],
-                       (int)(add_image.width), (int)(add_image.height),
-                       (int)(image.width), (int)(image.height));
+         fprintf(stderr, "%s: size mismatch (%d,%d), expected (%d,%d)\n",
+                 filenames[i],
+                 images->inputs[i].width, images->inputs[i].height,
+                 images->prefix.width, images->prefix.height);
+         return 1;
       }
+   }
+   return 0;
+}
 
-      add_image.format = PNG_FORMAT_GA;
-      if( !png_image_finish_read(&add_image, NULL, add_pixels, 0, NULL) )
-         return fprintf(stderr, "%s: load error\n", argv[i]);
+/* Build suffix composites.  Returns 0 on success. */
+static int BuildSuffixComposites(LeaveOneOutImages *images)
+{
+   const Bitplane *overlay;
+   int i;
 
-      r = add_pixels;
-      w = pixels;
-      for(j = 0; j < (int)(image.width * image.height); j++)
+   for(i = images->input_count; i >= 0; i--)
+   {
+      if( AllocBitplane(&images->suffix[i],
+                        images->prefix.width, images->prefix.height) != 0 )
       {
-         if( r[1] == 0xff )
-         {
-            /* Overlay pixel is opaque, so we will take its pixel value
-               unconditionally.  This only works because we assert that
-               all input images are black and white, so we don't need to
-               do any fancy calculations with opacity.                   */
-            *w++ = *r++;
-            *w++ = *r++;
-         }
-         else
-         {
-            /* Overlay pixel is transparent.  Leave underlay pixel untouched. */
-            w += 2;
-            r += 2;
-         }
+         fputs("Out of memory\n", stderr);
+         return 1;
+      }
+      if( i < images->input_count )
+      {
+         CopyBitplane(&images->inputs[i], &images->suffix[i]);
+         overlay = &images->suffix[i + 1];
+         StackBitplanes(&images->suffix[i], &overlay, 1);
       }
    }
+   return 0;
+}
 
-   /* Write output.  Here we set the flags to optimize for encoding speed
-      rather than output size so that we can iterate faster.  This is fine
-      since the output of this tool are intermediate files that are used
-      only in the build process, and are not the final PNGs that will be
-      committed.                                                           */
-   image.flags |= PNG_IMAGE_FLAG_FAST;
-   if( !png_image_write_to_stdio(&image, stdout, 0, pixels, 0, NULL) )
+/* Write outputs, extending the prefix composite with one input after
+   each output.  Returns 0 on success.                                   */
+static int WriteLeaveOneOutImages(const char *pattern, PngPreset preset,
+                                  LeaveOneOutImages *images)
+{
+   char filename[FILENAME_MAX];
+   const Bitplane *overlay;
+   int i;
+
+   if( AllocBitplane(&images->output,
+                     images->prefix.width, images->prefix.height) != 0 )
    {
-      fputs("Error writing to stdout\n", stderr);
+      fputs("Out of memory\n", stderr);
       return 1;
    }
+   for(i = 0; i < images->input_count; i++)
+   {
+      CopyBitplane(&images->prefix, &images->output);
+      overlay = &images->suffix[i + 1];
+      StackBitplanes(&images->output, &overlay, 1);
+      snprintf(filename, FILENAME_MAX, pattern, i);
+      if( SaveBitplane(filename, &images->output, preset) != 0 )
+         return 1;
 
-   free(pixels);
-   free(add_pixels);
+      overlay = &images->inputs[i];
+      StackBitplanes(&images->prefix, &overlay, 1);
+   }
    return 0;
 }
+
+/* Generate leave-one-out composites.  Returns 0 on success. */
+static int LeaveOneOut(const char *base_filename, const char *pattern,
+                       char **filenames, int input_count, PngPreset preset)
+{
+   char filename[2][FILENAME_MAX];
+   LeaveOneOutImages images;
+   int status;
+
+   /* Make sure that the output pattern names each output differently,
+      otherwise all outputs would just overwrite each other.             */
+   if( snprintf(filename[0], FILENAME_MAX, pattern, 0) >= FILENAME_MAX ||
+       snprintf(filename[1], FILENAME_MAX, pattern, 1) >= FILENAME_MAX ||
+       strcmp(filename[0], filename[1]) == 0 )
+   {
+      fprintf(stderr, "Invalid output pattern: %s\n", pattern);
+      return 1;
+   }
+
+   memset(&images, 0, sizeof(images));
+   images.input_count = input_count;
+   status = LoadLeaveOneOutImages(base_filename, filenames, &images);
+   if( status == 0 )
+      status = BuildSuffixComposites(&images);
+   if( status == 0 )
+      status = WriteLeaveOneOutImages(pattern, preset, &images);
+   FreeLeaveOneOutImages(&images);
+   return status;
+}
+
+int main(int argc, char **argv)
+{
+   DecodeQueue queue;
+   pthread_t threads[RING_SIZE];
+   Bitplane output;
+   PngPreset preset;
+   long cpu_count;
+   int thread_count, i, status;
+
+   if( ParsePngPreset(&argc, argv, &preset) != 0 )
+      return 1;
+   if( argc == 1 )
+   {
+      return fprintf(stderr,
+                     "%s {input.png} ... > {output.png}\n"
+                     "%s --leave-one-out {base.png} {output.png} "
+                     "{input0.png} ...\n",
+                     *argv, *argv);
+   }
+   if( strcmp(argv[1], "--leave-one-out") == 0 )
+   {
+      if( argc < 5 )
+      {
+         return fprintf(stderr, "%s --leave-one-out {base.png} {output.png} "
+                        "{input0.png} ...\n", *argv);
+      }
+      return LeaveOneOut(argv[2], argv[3], argv + 4, argc - 4, preset);
+   }
+   if( isatty(STDOUT_FILENO) )
+   {
+      fputs("Not writing output to stdout because it's a tty\n", stderr);
+      return 1;
+   }
+
+   #ifdef _WIN32
+      setmode(STDOUT_FILENO, O_BINARY);
+   #endif
+
+   /* Start decoder threads. */
+   memset(&queue, 0, sizeof(queue));
+   pthread_mutex_init(&queue.mutex, NULL);
+   pthread_cond_init(&queue.slot_ready, NULL);
+   pthread_cond_init(&queue.slot_free, NULL);
+   queue.filenames = argv + 1;
+   queue.input_count = argc - 1;
+   for(i = 0; i < RING_SIZE; i++)
+      queue.ring[i].input = -1;
+
+   cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+   thread_count = cpu_count < 1 ? 1 : (int)cpu_count;
+   if( thread_count > RING_SIZE )
+      thread_count = RING_SIZE;
+   if( thread_count > queue.input_count )
+      thread_count = queue.input_count;
+   for(i = 0; i < thread_count; i++)
+   {
+      if( pthread_create(&threads[i], NULL, DecodeThread, &queue) != 0 )
+         break;
+   }
+   thread_count = i;
+   if( thread_count == 0 )
+   {
+      fputs("Error starting threads\n", stderr);
+      return 1;
+   }
+
+   /* Composite inputs as they become available. */
+   memset(&output, 0, sizeof(output));
+   status = MergeInputs(&queue, &output);
+
+   /* Stop decoder threads and release any images that were not
+      composited due to errors.                                          */
+   pthread_mutex_lock(&queue.mutex);
+   queue.abort = 1;
+   pthread_cond_broadcast(&queue.slot_free);
+   pthread_mutex_unlock(&queue.mutex);
+   for(i = 0; i < thread_count; i++)
+      pthread_join(threads[i], NULL);
+   for(i = 0; i < RING_SIZE; i++)
+   {
+      if( queue.ring[i].input >= 0 )
+         FreeSlot(&queue.ring[i]);
+   }
+   pthread_cond_destroy(&queue.slot_free);
+   pthread_cond_destroy(&queue.slot_ready);
+   pthread_mutex_destroy(&queue.mutex);
+
+   /* Write output. */
+   if( status == 0 )
+      status = SaveBitplane("-", &output, preset);
+   FreeBitplane(&output);
+   return status;
+}
@@ -0,0 +1,352 @@
+/* Star placement for add_starfield.
+
+   See star_placement.h for descriptions.
+*/
+
+#include"star_placement.h"
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+/* Syntactic sugar.  These may or may not be defined in standard library,
+   so we just define our own functions for it.                            */
+static int Max(int a, int b) { return a > b ? a : b; }
+static int Min(int a, int b) { return a < b ? a : b; }
+
+/* Return a random integer between [a,b]. */
+static int RandomInt(int a, int b)
+{
+   return (int)(((double)rand() / (double)RAND_MAX) * (b - a) + a);
+}
+
+/* Jenkin's one-at-a-time hash.
+   https://en.wikipedia.org/wiki/Jenkins_hash_function
+*/
+static uint32_t Hash(uint8_t *bytes, size_t size)
+{
+   uint32_t hash = 0;
+   size_t i;
+
+   for(i = 0; i < size; i++)
+   {
+      hash += bytes[i];
+      hash += hash << 10;
+      hash ^= hash >> 6;
+   }
+   hash += hash << 3;
+   hash ^= hash >> 11;
+   hash += hash << 15;
+   return hash;
+}
+
+uint32_t HashPair(int x, int y)
+{
+   uint8_t buffer[sizeof(int) * 2];
+
+   memcpy(buffer, &x, sizeof(int));
+   memcpy(buffer + sizeof(int), &y, sizeof(int));
+   return Hash(buffer, sizeof(buffer));
+}
+
+/* Check if a coordinate is eligible for stars, returns 1 if so.  This is
+   done by hashing only the coordinate value, so the stars always appear
+   in the same positions regardless of input pixels.                      */
+static int IsStarLocation(int x, int y)
+{
+   return (HashPair(x, y) & 0x11111) == 0;
+}
+
+/* Squared distance used for pixels that are not near any opaque pixel.
+   This only needs to be larger than radius*radius, and small enough such
+   that adding squared image dimensions to it doesn't overflow.           */
+#define FAR_AWAY  (1 << 29)
+
+/* Distance field for proximity checks.
+
+   Each entry in dist2 is the squared distance to the nearest opaque
+   pixel, or some value greater than radius*radius if there are no opaque
+   pixels nearby.  This is initialized once from input pixels, and then
+   updated as new stars are placed, so that each proximity check is a
+   single lookup, as opposed to scanning the full area around each
+   candidate location.
+
+   The original proximity check bounded its loops with "<=" instead of
+   "<", so it scanned one extra column at x=width and one extra row at
+   y=height.  Pixels at x=width are the same as the first pixel of the
+   next row, so an opaque pixel at (0,y+1) counts as being at (width,y).
+   We preserve this behavior, and wrap_dy2 tracks those pixels
+   separately: each entry is the squared vertical distance to the nearest
+   aliased pixel.  The extra row at y=height was just past the end of the
+   pixel buffer, and is treated as transparent.  Since the original result
+   for that row depended on an out-of-bounds read, output is only the same
+   as the original except for candidates within radius of the bottom
+   edge, plus any stars that are spaced against the ones that changed
+   there.                                                                 */
+typedef struct
+{
+   int width, height, radius;
+   int *dist2;
+   int *wrap_dy2;
+} DistanceField;
+
+/* Compute one dimensional squared distance transform of f, writing
+   output to d.  f and d are accessed with the specified stride.  v and z
+   are scratch space of size n and n+1, respectively.
+
+   This is the lower envelope of parabolas algorithm from "Distance
+   Transforms of Sampled Functions" by Felzenszwalb and Huttenlocher.     */
+static void DistanceTransform1D(const int *f, int *d, int stride, int n,
+                                int *v, double *z)
+{
+   int k = 0, q;
+   double s;
+
+   v[0] = 0;
+   z[0] = -1e30;
+   z[1] = 1e30;
+   for(q = 1; q < n; q++)
+   {
+      for(;;)
+      {
+         s = ((double)f[q * stride] + (double)q * q -
+              (double)f[v[k] * stride] - (double)v[k] * v[k]) /
+             (2.0 * (q - v[k]));
+         if( s > z[k] )
+            break;
+         k--;
+      }
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = 1e30;
+   }
+
+   k = 0;
+   for(q = 0; q < n; q++)
+   {
+      while( z[k + 1] < q )
+         k++;
+      d[q * stride] = Min((q - v[k]) * (q - v[k]) + f[v[k] * stride],
+                          FAR_AWAY);
+   }
+}
+
+/* Mark a single pixel in column 0 as opaque in wrap_dy2. */
+static void MarkWrapPixel(DistanceField *field, int y)
+{
+   int iy, dy2;
+
+   /* Pixel at (0,y) aliases to (width,y-1).  This only applies to y>0,
+      since the original scan never went above the first row.             */
+   if( y == 0 )
+      return;
+   y--;
+   for(iy = Max(y - field->radius, 0);
+       iy <= Min(y + field->radius, field->height - 1);
+       iy++)
+   {
+      dy2 = (y - iy) * (y - iy);
+      if( field->wrap_dy2[iy] > dy2 )
+         field->wrap_dy2[iy] = dy2;
+   }
+}
+
+/* Initialize distance field from pixel alpha values.  Returns 0 on
+   success.                                                               */
+static int InitDistanceField(const Bitplane *image, int radius,
+                             DistanceField *field)
+{
+   int size, x, y, *f, *v;
+   double *z;
+
+   field->width = image->width;
+   field->radius = radius;
+   field->height = image->height;
+   size = field->width * field->height;
+   field->dist2 = (int*)malloc(size * sizeof(int));
+   field->wrap_dy2 = (int*)malloc(field->height * sizeof(int));
+   f = (int*)malloc(size * sizeof(int));
+   v = (int*)malloc(Max(field->width, field->height) * sizeof(int));
+   z = (double*)malloc((Max(field->width, field->height) + 1) *
+                       sizeof(double));
+   if( field->dist2 == NULL || field->wrap_dy2 == NULL ||
+       f == NULL || v == NULL || z == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      free(field->dist2);
+      free(field->wrap_dy2);
+      free(f);
+      free(v);
+      free(z);
+      return 1;
+   }
+
+   /* Check for opaque pixels. */
+   for(y = 0; y < field->height; y++)
+   {
+      for(x = 0; x < field->width; x++)
+      {
+         f[y * field->width + x] =
+            GetBitplaneAlpha(image, x, y) ? 0 : FAR_AWAY;
+      }
+   }
+
+   /* Transform rows, then columns. */
+   for(y = 0; y < field->height; y++)
+   {
+      DistanceTransform1D(f + y * field->width, field->dist2 + y * field->width,
+                          1, field->width, v, z);
+   }
+   memcpy(f, field->dist2, size * sizeof(int));
+   for(x = 0; x < field->width; x++)
+   {
+      DistanceTransform1D(f + x, field->dist2 + x, field->width,
+                          field->height, v, z);
+   }
+
+   for(y = 0; y < field->height; y++)
+      field->wrap_dy2[y] = FAR_AWAY;
+   for(y = 0; y < field->height; y++)
+   {
+      if( GetBitplaneAlpha(image, 0, y) )
+         MarkWrapPixel(field, y);
+   }
+
+   free(f);
+   free(v);
+   free(z);
+   return 0;
+}
+
+/* Update distance field after a pixel has become opaque. */
+static void MarkOpaquePixel(DistanceField *field, int x, int y)
+{
+   int ix, iy, dx2, dy2, *p;
+
+   /* Only distances within radius affect proximity checks, so we only
+      need to update those.                                              */
+   for(iy = Max(y - field->radius, 0);
+       iy <= Min(y + field->radius, field->height - 1);
+       iy++)
+   {
+      dy2 = (y - iy) * (y - iy);
+      p = field->dist2 + iy * field->width;
+      for(ix = Max(x - field->radius, 0);
+          ix <= Min(x + field->radius, field->width - 1);
+          ix++)
+      {
+         dx2 = (x - ix) * (x - ix);
+         if( p[ix] > dx2 + dy2 )
+            p[ix] = dx2 + dy2;
+      }
+   }
+
+   if( x == 0 )
+      MarkWrapPixel(field, y);
+}
+
+/* Check if a region centered around some point is completely transparent,
+   returns 1 if so.                                                        */
+static int IsEmptyRegion(const DistanceField *field, int x, int y)
+{
+   int dx;
+
+   if( field->dist2[y * field->width + x] <= field->radius * field->radius )
+      return 0;
+   dx = field->width - x;
+   return dx * dx + field->wrap_dy2[y] > field->radius * field->radius;
+}
+
+int PlaceStars(Bitplane *image, int radius, XY **output)
+{
+   int star_count, max_star_count, x, y, i, j;
+   DistanceField field;
+   XY *stars;
+
+   /* Initialize star positions.  This is done by visiting all eligible
+      coordinates in random order, and then drop the ones that failed
+      proximity check.
+
+      We used to do a simpler check where we visit each coordinate in
+      YX order, but hash the coordinates to determine if a coordinate is
+      eligible.  But due to the proximity check being more strict than the
+      hash function, the end result tend to exhibit a rectangular grid-like
+      pattern.  That pattern doesn't happen when we visit in random order.  */
+   max_star_count = image->width * image->height;
+   stars = (XY*)malloc(max_star_count * sizeof(XY));
+   if( stars == NULL )
+   {
+      fputs("Out of memory\n", stderr);
+      return -1;
+   }
+   for(i = y = 0; y < image->height; y++)
+   {
+      for(x = 0; x < image->width; x++, i++)
+      {
+         stars[i].x = x;
+         stars[i].y = y;
+      }
+   }
+
+   if( InitDistanceField(image, radius, &field) != 0 )
+   {
+      free(stars);
+      return -1;
+   }
+
+   /* Fisher-Yates shuffle, with deterministic seed. */
+   srand(1);
+   for(i = max_star_count - 1; i > 0; i--)
+   {
+      j = RandomInt(0, i);
+      x = stars[i].x;
+      y = stars[i].y;
+      stars[i].x = stars[j].x;
+      stars[i].y = stars[j].y;
+      stars[j].x = x;
+      stars[j].y = y;
+   }
+
+   /* Visit each coordinate. */
+   for(i = star_count = 0; i < max_star_count; i++)
+   {
+      x = stars[i].x;
+      y = stars[i].y;
+
+      /* Apply a hash check to see if a location is eligible, followed
+         by a proximity check.
+
+         Even though we have eliminated the grid-like pattern due to
+         randomized visit order, we would still get a ring-like pattern
+         around opaque pixels that were present in the original image.
+         This is because proximity check alone would cause the pixels
+         to be placed at the nearest available spot near the previously
+         placed pixels.
+
+         By combining both random visit order and hash eligibility check,
+         we would eliminate the ring-like patterns as well.               */
+      if( IsStarLocation(x, y) && IsEmptyRegion(&field, x, y) )
+      {
+         /* Star location is accepted.  We will write it back to the
+            array in-place.
+
+            If location is rejected, star_count will not be incremented
+            while we read ahead in "i", so stars array will end up with
+            those rejected entries skipped.                             */
+         stars[star_count].x = x;
+         stars[star_count].y = y;
+         star_count++;
+
+         /* Draw a black pixel to mark the selected star location, so
+            that we don't draw another star near it.                  */
+         SetBitplanePixel(image, x, y, 0, 1);
+         MarkOpaquePixel(&field, x, y);
+      }
+   }
+
+   free(field.dist2);
+   free(field.wrap_dy2);
+   *output = stars;
+   return star_count;
+}
+
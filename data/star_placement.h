@@ -0,0 +1,26 @@
+/* Star placement for add_starfield.
+
+   This is the inner loop of add_starfield.  It's kept in a separate
+   object file so that image_bench can measure it on the same synthetic
+   inputs as the other image kernels.
+*/
+
+#ifndef STAR_PLACEMENT_H_
+#define STAR_PLACEMENT_H_
+
+#include"bitplane.h"
+
+typedef struct { int x, y; } XY;
+
+/* Hash two numbers with Jenkin's one-at-a-time hash. */
+uint32_t HashPair(int x, int y);
+
+/* Select star locations and draw them to image as opaque black pixels.
+   Stars are at least {radius} pixels away from each other and from any
+   pixel that was opaque in the input image.  Star locations are written
+   to a newly allocated array, which caller should free.
+
+   Returns number of stars placed, or -1 on error.                       */
+int PlaceStars(Bitplane *image, int radius, XY **output);
+
+#endif
@@ -94,7 +94,30 @@ for(my $i = 0; $i < (scalar @lines); $i++)
          die "$start: could not find the end of function $name\n";
       }
       $i = $end;
-      $locals{$name} = [$start, $end];
+      $locals{$name} = [[$start, $end]];
+   }
+   elsif( $lines[$i] =~ /^function (\w+)[.:]\w+\b/ && exists $locals{$1} )
+   {
+      # Function stored in a local table.  This is treated as part of the
+      # table definition, so that the table and all its functions are
+      # removed together if the table is only referenced by assertions.
+      my $name = $1;
+      my $start = $i;
+      my $end = undef;
+      for(my $j = $i + 1; $j < (scalar @lines); $j++)
+      {
+         if( $lines[$j] =~ /^end\b/ )
+         {
+            $end = $j;
+            last;
+         }
+      }
+      unless( defined $end )
+      {
+         die "$start: could not find the end of function $name\n";
+      }
+      $i = $end;
+      push @{$locals{$name}}, [$start, $end];
    }
    elsif( $lines[$i] =~ /^local (\w+)\b.*=/ )
    {
@@ -106,7 +129,7 @@ for(my $i = 0; $i < (scalar @lines); $i++)
       my $name = $1;
       if( $lines[$i] =~ /=.*\S/ )
       {
-         $locals{$name} = [$i, $i];
+         $locals{$name} = [[$i, $i]];
       }
    }
 }
@@ -119,13 +142,21 @@ for(;;)
    my @remove_locals = ();
    foreach my $f (keys %locals)
    {
-      my ($start, $end) = @{$locals{$f}};
+      my @ranges = @{$locals{$f}};
       my $pattern = qr/\b$f\b/;
       my $unused = 1;
 
-      # Scan lines before the function or variable definition.
-      for(my $i = 0; $i < $start; $i++)
+      # Scan lines outside the function or variable definition.  Ranges
+      # are sorted by line number since they are collected in order.
+      my $r = 0;
+      for(my $i = 0; $i < (scalar @lines); $i++)
       {
+         if( $r < (scalar @ranges) && $i == $ranges[$r][0] )
+         {
+            $i = $ranges[$r][1];
+            $r++;
+            next;
+         }
          if( $lines[$i] =~ $pattern )
          {
             $unused = 0;
@@ -134,23 +165,14 @@ for(;;)
       }
       if( $unused )
       {
-         # Scan lines after the function or variable definition.
-         for(my $i = $end + 1; $i < (scalar @lines); $i++)
+         # No references found, delete this function or variable.
+         foreach my $range (@ranges)
          {
-            if( $lines[$i] =~ $pattern )
+            for(my $i = $range->[0]; $i <= $range->[1]; $i++)
             {
-               $unused = 0;
-               last;
+               $lines[$i] = "";
             }
          }
-      }
-      if( $unused )
-      {
-         # No references found, delete this function or variable.
-         for(my $i = $start; $i <= $end; $i++)
-         {
-            $lines[$i] = "";
-         }
          push @remove_locals, $f;
       }
    }
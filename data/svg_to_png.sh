@@ -1,7 +1,7 @@
 #!/bin/bash
 # Wrapper for launching Inkscape.
 #
-# This wrapper does three things:
+# This wrapper does four things:
 #
 # 1. Keep all the paths and flags in one place.
 #
@@ -36,13 +36,47 @@
 #    because Inkscape was idle while `make` is running, who knows.  Your
 #    safest bet is to always close all instances of Inkscape before running
 #    this script.
+#
+# 4. Optionally rasterize through a pool of persistent Inkscape processes.
+#
+#    Running with "--start-servers {count}" starts that many instances of
+#    "inkscape --shell" one after another, so they never start in parallel.
+#    Until "--stop-servers", all other invocations of this script send
+#    their export commands to an idle server instead of launching a new
+#    Inkscape, which avoids both the startup cost and the global lock.
+#    Without servers, each invocation launches Inkscape directly, which is
+#    the default.
+#
+#    Server mode is opt-in: top level Makefile only starts servers for
+#    "refresh_data" if inkscape_servers is set to a nonzero count.  So far
+#    it has only been tested against the fake Inkscape in
+#    test_svg_to_png.sh.  The "--shell" action syntax and reply parsing
+#    still need to be checked against a real Inkscape 1.4 or later.
+#
+#    Each server is a shell loop reading requests from a named pipe and
+#    forwarding them to Inkscape.  Clients pick a server by taking its lock
+#    file, and each request carries the name of a reply pipe where the
+#    server writes back after Inkscape has finished.  Inkscape doesn't tell
+#    us when an export is done, so every request is followed by an
+#    "inkscape-version" action, and its output line is the signal.
+#
+#    Each server holds a lock on its ready file while it's running, so that
+#    clients can skip servers that died without cleaning up.  All pipes are
+#    opened for both reading and writing, which never blocks even if the
+#    other end is gone, and clients waiting for a reply check periodically
+#    that the server is still alive.
 
-if [[ $# -ne 2 && $# -ne 6 && $# -ne 7 ]]; then
+if [[ $# -eq 2 && "$1" == "--start-servers" ]] || \
+   [[ $# -eq 1 && "$1" == "--stop-servers" ]]; then
+   :
+elif [[ $# -ne 2 && $# -ne 6 && $# -ne 7 ]]; then
    echo "$0 {input.svg} {output.png} [x1] [y1] [x2] [y2] [dpi]"
+   echo "$0 --start-servers {count}"
+   echo "$0 --stop-servers"
    exit 1
 fi
 INPUT=$1
-OUTPUT=$2
+OUTPUT=${2:-}
 
 set -euo pipefail
 
@@ -56,7 +90,121 @@ set -euo pipefail
 # The same merge request above also added "--export-png-compression".
 # The default is 6, which appears to encode at the same speed as 0 (and
 # significantly faster than 9), so we kept the default.
-INKSCAPE="c:/Program Files/Inkscape/bin/inkscape.exe"
+INKSCAPE=${INKSCAPE:-"c:/Program Files/Inkscape/bin/inkscape.exe"}
+
+# Prefix for server pipes and lock files.
+SERVER_PREFIX=$(dirname "$0")/t_inkscape_server
+
+# Check if the server that wrote a ready file is still running.  Lock is
+# released by the operating system when the server exits for any reason.
+function is_server_alive
+{
+   { ! flock -n -s 7; } 2> /dev/null 7< "$1"
+}
+
+# Read Inkscape output until we see the response to "inkscape-version".
+function wait_for_inkscape
+{
+   local line
+   while read -r line <&"${INKSCAPE_SHELL[0]}"; do
+      if [[ "$line" == *"Inkscape "[0-9]* ]]; then
+         return 0
+      fi
+   done
+   return 1
+}
+
+# Server loop for a single Inkscape instance.
+function run_server
+{
+   local index=$1
+   local request="${SERVER_PREFIX}_${index}.fifo"
+   local reply actions status
+
+   coproc INKSCAPE_SHELL { "$INKSCAPE" --shell 2>&1; }
+   echo "inkscape-version" >&"${INKSCAPE_SHELL[1]}"
+   wait_for_inkscape
+
+   # Ready file contains the process ID of this server for debugging, and
+   # stays locked until this server exits.  Lock is taken after Inkscape
+   # has started, so that it's not inherited by Inkscape.
+   echo "$BASHPID" > "${SERVER_PREFIX}_${index}.ready.tmp"
+   exec 6< "${SERVER_PREFIX}_${index}.ready.tmp"
+   flock -x 6
+   mv -f "${SERVER_PREFIX}_${index}.ready.tmp" \
+         "${SERVER_PREFIX}_${index}.ready"
+
+   # Open request pipe for both reading and writing, so that we don't get
+   # an EOF each time a client closes its end.
+   exec 3<> "$request"
+   while read -r reply actions <&3; do
+      if [[ "$actions" == "quit" ]]; then
+         break
+      fi
+      echo "$actions; inkscape-version" >&"${INKSCAPE_SHELL[1]}"
+      if wait_for_inkscape; then
+         status=ok
+      else
+         status=error
+      fi
+
+      # Reply pipe is gone if the client gave up, don't turn it into a
+      # regular file.
+      if [[ -p "$reply" ]]; then
+         echo "$status" 1<> "$reply"
+      fi
+      if [[ "$status" != "ok" ]]; then
+         break
+      fi
+   done
+
+   echo "quit" >&"${INKSCAPE_SHELL[1]}" || true
+   wait "$INKSCAPE_SHELL_PID" || true
+   rm -f "$request" "${SERVER_PREFIX}_${index}".{ready,lock}
+}
+
+if [[ "$INPUT" == "--start-servers" ]]; then
+   # Requests contain paths relative to the data directory, so servers
+   # need to run from there.
+   cd "$(dirname "$0")"
+   SERVER_PREFIX=./t_inkscape_server
+   for (( i = 0; i < $2; i++ )); do
+      rm -f "${SERVER_PREFIX}_${i}.fifo" "${SERVER_PREFIX}_${i}.ready"
+      mkfifo "${SERVER_PREFIX}_${i}.fifo"
+      run_server $i < /dev/null > /dev/null 2>&1 &
+      disown
+
+      # Wait for this server to finish starting before starting the next
+      # one, since parallel startups is the one thing Inkscape can't do.
+      for (( t = 0; t < 600; t++ )); do
+         if [[ -e "${SERVER_PREFIX}_${i}.ready" ]]; then
+            break
+         fi
+         sleep 0.1
+      done
+      if ! [[ -e "${SERVER_PREFIX}_${i}.ready" ]]; then
+         echo "Timed out waiting for Inkscape server $i"
+         exit 1
+      fi
+   done
+   exit 0
+fi
+
+if [[ "$INPUT" == "--stop-servers" ]]; then
+   for ready in "${SERVER_PREFIX}"_*.ready; do
+      server=${ready%.ready}
+      if ! [[ -e "$ready" ]]; then
+         continue
+      fi
+      if is_server_alive "$ready" && [[ -p "$server.fifo" ]]; then
+         echo "- quit" 1<> "$server.fifo"
+      else
+         # Server died without cleaning up.
+         rm -f "$server".{fifo,ready,lock}
+      fi
+   done
+   exit 0
+fi
 
 # Use cached output if available.  This works by hashing the contents of the
 # input SVG and finding an existing file named with that hash.
@@ -123,16 +271,86 @@ if [[ $# -eq 6 && -s "$FULL_PAGE_CACHE" ]]; then
    exec cp "$CACHED_OUTPUT" "$OUTPUT"
 fi
 
-flock $(dirname "$0")/t_inkscape.lock "$INKSCAPE" \
-   "$AREA" \
-   "$EXPORT_DPI" \
-   --export-type=png \
-   --export-png-color-mode=RGBA_8 \
-   --export-png-antialias=0 \
-   --export-background=black \
-   --export-background-opacity=0 \
-   --export-filename="$CACHED_OUTPUT" \
-   "$INPUT"
+# Find an idle server by trying the lock of each live server in turn,
+# sleeping briefly after each round.  Servers are only used if we are in
+# the same directory as the servers.  SERVER is left empty if there are no
+# live servers, in which case we run Inkscape directly.
+SERVER=
+if [[ "$(dirname "$0")" == "." ]]; then
+   while :; do
+      LIVE_SERVERS=0
+      for ready in "${SERVER_PREFIX}"_*.ready; do
+         if ! is_server_alive "$ready" || \
+            ! [[ -p "${ready%.ready}.fifo" ]]; then
+            continue
+         fi
+         LIVE_SERVERS=$((LIVE_SERVERS + 1))
+         exec 4> "${ready%.ready}.lock"
+         if flock -n 4; then
+            SERVER=${ready%.ready}
+            break
+         fi
+         exec 4>&-
+      done
+      if [[ -n "$SERVER" || $LIVE_SERVERS -eq 0 ]]; then
+         break
+      fi
+      sleep 0.1
+   done
+fi
+
+if [[ -n "$SERVER" ]]; then
+   # Same settings as the command line flags below, but in action syntax.
+   # Server keeps the document settings between requests, so every setting
+   # is set explicitly on each request.
+   if [[ "$AREA" == "--export-area-page" ]]; then
+      AREA_ACTION="export-area-page"
+   else
+      AREA_ACTION="export-area:$X1:$Y1:$X2:$Y2"
+   fi
+   ACTIONS="file-open:$INPUT; $AREA_ACTION"
+   ACTIONS+="; export-dpi:${EXPORT_DPI#--export-dpi=}"
+   ACTIONS+="; export-type:png"
+   ACTIONS+="; export-png-color-mode:RGBA_8"
+   ACTIONS+="; export-png-antialias:0"
+   ACTIONS+="; export-background:black"
+   ACTIONS+="; export-background-opacity:0"
+   ACTIONS+="; export-filename:$CACHED_OUTPUT"
+   ACTIONS+="; export-do; file-close"
+
+   # Keep reply pipe open before sending the request, so that the reply
+   # is not lost if the server writes it before we start reading.
+   REPLY=$(mktemp -u "${SERVER_PREFIX}_reply.XXXXXX")
+   mkfifo "$REPLY"
+   exec 5<> "$REPLY"
+   echo "$REPLY $ACTIONS" 1<> "$SERVER.fifo"
+   STATUS=
+   until read -r -t 1 STATUS <&5; do
+      if ! is_server_alive "$SERVER.ready"; then
+         STATUS="server died"
+         break
+      fi
+   done
+   exec 5>&-
+   rm -f "$REPLY"
+   exec 4>&-
+   if [[ "$STATUS" != "ok" || ! -s "$CACHED_OUTPUT" ]]; then
+      rm -f "$CACHED_OUTPUT"
+      echo "Inkscape server failed to export $INPUT"
+      exit 1
+   fi
+else
+   flock $(dirname "$0")/t_inkscape.lock "$INKSCAPE" \
+      "$AREA" \
+      "$EXPORT_DPI" \
+      --export-type=png \
+      --export-png-color-mode=RGBA_8 \
+      --export-png-antialias=0 \
+      --export-background=black \
+      --export-background-opacity=0 \
+      --export-filename="$CACHED_OUTPUT" \
+      "$INPUT"
+fi
 
 # We ran Inkscape because we didn't have a cache entry for this output image,
 # but it's still possible that the new output is identical to what already
@@ -0,0 +1,167 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {cache_tool.sh}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+TEST_DIR=$(mktemp -d)
+
+function die
+{
+   echo "$1"
+   rm -rf "$TEST_DIR"
+   exit 1
+}
+
+# Run tests from inside the temporary directory, so that cache entries
+# don't end up in the current directory.
+cp "$TOOL" "$TEST_DIR/cache_tool.sh"
+cd "$TEST_DIR"
+
+# Fake tool that counts how many times it was invoked, and writes its
+# input in uppercase to one or two outputs.
+cat <<'EOT' > tool.sh
+#!/bin/bash
+set -e
+echo x >> count.txt
+tr a-z A-Z < "$1" > "$2"
+if [[ $# -gt 2 ]]; then
+   tr a-z A-Z < "$1" | rev > "$3"
+fi
+EOT
+chmod +x tool.sh
+
+function check_count
+{
+   local test_id=$1
+   local expected=$2
+   local actual=$(wc -l < count.txt)
+   if [[ "$actual" -ne "$expected" ]]; then
+      die "$test_id: expected $expected invocations, got $actual"
+   fi
+}
+
+function check_output
+{
+   local test_id=$1
+   local file=$2
+   local expected=$3
+   if [[ "$(cat "$file")" != "$expected" ]]; then
+      die "$test_id: unexpected contents in $file: $(cat "$file")"
+   fi
+}
+
+touch count.txt
+
+
+# ................................................................
+# Cache miss.
+
+echo abc > input.txt
+./cache_tool.sh './tool.sh input.txt output.txt' output.txt
+check_count "$LINENO: miss" 1
+check_output "$LINENO: miss" output.txt ABC
+
+
+# ................................................................
+# Cache hit.
+
+rm output.txt
+./cache_tool.sh './tool.sh input.txt output.txt' output.txt
+check_count "$LINENO: hit" 1
+check_output "$LINENO: hit" output.txt ABC
+
+# Output is not touched if it's unchanged.
+touch -d '2000-01-01' output.txt
+./cache_tool.sh './tool.sh input.txt output.txt' output.txt
+check_count "$LINENO: unchanged" 1
+[[ "$(stat -c %Y output.txt)" -eq "$(date -d '2000-01-01' +%s)" ]] || \
+   die "$LINENO: output was touched"
+
+
+# ................................................................
+# Changes to input, command, or tool.
+
+echo def > input.txt
+./cache_tool.sh './tool.sh input.txt output.txt' output.txt
+check_count "$LINENO: input changed" 2
+check_output "$LINENO: input changed" output.txt DEF
+
+./cache_tool.sh "./tool.sh 'input.txt' output.txt" output.txt
+check_count "$LINENO: command changed" 3
+check_output "$LINENO: command changed" output.txt DEF
+
+echo >> tool.sh
+./cache_tool.sh './tool.sh input.txt output.txt' output.txt
+check_count "$LINENO: tool changed" 4
+check_output "$LINENO: tool changed" output.txt DEF
+
+
+# ................................................................
+# Multiple outputs.
+
+./cache_tool.sh './tool.sh input.txt output.txt output2.txt' output.txt output2.txt
+check_count "$LINENO: multiple outputs" 5
+check_output "$LINENO: multiple outputs" output2.txt FED
+
+rm output.txt output2.txt
+./cache_tool.sh './tool.sh input.txt output.txt output2.txt' output.txt output2.txt
+check_count "$LINENO: multiple outputs hit" 5
+check_output "$LINENO: multiple outputs hit" output.txt DEF
+check_output "$LINENO: multiple outputs hit" output2.txt FED
+
+
+# ................................................................
+# Output pattern.
+
+cat <<'EOT' > pattern_tool.sh
+#!/bin/bash
+set -e
+echo x >> count.txt
+for i in 0 1 2; do
+   tr a-z A-Z < "$1" | sed -e "s/$/$i/" > "$(printf "$2" $i)"
+done
+EOT
+chmod +x pattern_tool.sh
+
+./cache_tool.sh --pattern 'frame%d.txt' \
+   "./pattern_tool.sh input.txt 'frame%d.txt'" \
+   frame0.txt frame1.txt frame2.txt
+check_count "$LINENO: pattern" 6
+check_output "$LINENO: pattern" frame0.txt DEF0
+check_output "$LINENO: pattern" frame2.txt DEF2
+(ls frame*.txt | grep -qv 'frame[012].txt') && \
+   die "$LINENO: unexpected pattern output"
+
+rm frame0.txt frame1.txt frame2.txt
+./cache_tool.sh --pattern 'frame%d.txt' \
+   "./pattern_tool.sh input.txt 'frame%d.txt'" \
+   frame0.txt frame1.txt frame2.txt
+check_count "$LINENO: pattern hit" 6
+check_output "$LINENO: pattern hit" frame1.txt DEF1
+
+./cache_tool.sh './tool.sh input.txt output.txt sub/output.txt' \
+   output.txt sub/output.txt > /dev/null 2>&1 \
+   && die "$LINENO: duplicate basenames"
+
+
+# ................................................................
+# Failed commands.
+
+./cache_tool.sh './tool.sh missing.txt output3.txt' output3.txt \
+   > /dev/null 2>&1 && die "$LINENO: failed command"
+[[ -e output3.txt ]] && die "$LINENO: output created by failed command"
+(ls t_tool_cache_*output3.txt > /dev/null 2>&1) && \
+   die "$LINENO: cache entry left by failed command"
+
+"./cache_tool.sh" > /dev/null 2>&1 && die "$LINENO: missing arguments"
+
+
+# ................................................................
+# Cleanup.
+cd /
+rm -rf "$TEST_DIR"
+exit 0
@@ -208,6 +208,56 @@ if ! ( grep -qF "Invalid crop parameters" "$TEST_DIR/error.txt" ); then
    die "$LINENO: missing error message"
 fi
 
+# Pack cells with per-cell bounding boxes into an atlas.  All nonblank
+# cells have the same size, so they are expected to be stacked in a
+# single column in cell order.
+for i in $(seq 0 24); do
+   case $i in
+      0|1|22|23|24) echo "3 2 1 1" ;;
+      *) echo "0 0 0 0" ;;
+   esac
+done > "$TEST_DIR/boxes.txt"
+
+convert \
+   "(" "$TEST_DIR/blank.png" -crop "3x10+0+0" ")" \
+   -fill "xc:#010101" -draw "rectangle 0,0 2,1" \
+   -fill "xc:#020202" -draw "rectangle 0,2 2,3" \
+   -fill "xc:#030303" -draw "rectangle 0,4 2,5" \
+   -fill "xc:#040404" -draw "rectangle 0,6 2,7" \
+   -fill "xc:#050505" -draw "rectangle 0,8 2,9" \
+   "$TEST_DIR/expected.png"
+"./$TOOL" --atlas 5 4 "$TEST_DIR/boxes.txt" ATLAS "$TEST_DIR/actual.lua" \
+   < "$TEST_DIR/input.png" > "$TEST_DIR/actual.png"
+check_output "$LINENO: atlas"
+
+cat <<EOT > "$TEST_DIR/expected.lua"
+ATLAS =
+{
+EOT
+for i in $(seq 1 25); do
+   case $i in
+      1) echo "[$i] = {0, 0, 3, 2, 1, 1}," ;;
+      2) echo "[$i] = {0, 2, 3, 2, 1, 1}," ;;
+      23) echo "[$i] = {0, 4, 3, 2, 1, 1}," ;;
+      24) echo "[$i] = {0, 6, 3, 2, 1, 1}," ;;
+      25) echo "[$i] = {0, 8, 3, 2, 1, 1}," ;;
+      *) echo "[$i] = {0, 0, 0, 0, 0, 0}," ;;
+   esac
+done | sed -e 's/^/\t/' >> "$TEST_DIR/expected.lua"
+echo "}" >> "$TEST_DIR/expected.lua"
+if ! ( diff "$TEST_DIR/expected.lua" "$TEST_DIR/actual.lua" ); then
+   die "$LINENO: atlas offsets mismatched"
+fi
+
+echo "3 2 1 1" > "$TEST_DIR/boxes.txt"
+"./$TOOL" --atlas 5 4 "$TEST_DIR/boxes.txt" ATLAS "$TEST_DIR/actual.lua" \
+   < "$TEST_DIR/input.png" \
+   > "$TEST_DIR/actual.png" \
+   2> "$TEST_DIR/error.txt" && die "$LINENO: unexpected success"
+if ! ( grep -qF "expected 25 boxes" "$TEST_DIR/error.txt" ); then
+   die "$LINENO: missing error message"
+fi
+
 # Cleanup.
 rm -rf "$TEST_DIR"
 exit 0
@@ -427,6 +427,11 @@ EOT
 "./$TOOL" "$INPUT_IMAGE" "$ACTUAL_OUTPUT"
 check_output "$LINENO: rgb"
 
+# ................................................................
+# Test vector kernels against scalar reference.
+
+"./$TOOL" --self-test || die "$LINENO: self-test"
+
 # ................................................................
 # Cleanup.
 rm -f "$INPUT_PIXELS" "$INPUT_ALPHA" "$INPUT_IMAGE"
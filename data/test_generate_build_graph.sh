@@ -91,6 +91,55 @@ if ( grep -qF 'target1' "$OUTPUT" ); then
 fi
 
 
+# Generate profile log.  target2 depends on variable expansions that
+# are not built, and target1 runs in parallel with target2.
+PROFILE=$(mktemp)
+printf '%s\t%s\t%s\t%s\t%s\t%s\t%s\n' \
+   value1 100.0 101.0 0.9 0.1 1000 "./generate.exe > value1" \
+   target1 100.5 104.5 1.0 0.0 2000 "\$(MAKE) -C subdir" \
+   target2 101.0 102.0 0.5 0.0 3000 "./cache_tool.sh 'perl tool.pl' x" \
+   all 104.5 105.0 0.0 0.0 500 "echo all" > "$PROFILE"
+printf 'bad line\n' >> "$PROFILE"
+
+"./$TOOL" "--profile=$PROFILE" "$INPUT" > "$OUTPUT" 2> "$PROFILE.txt" \
+   || die "$LINENO: $TOOL failed: $?"
+
+# Check trace output.
+if ! ( perl -MJSON::PP -e 'decode_json(join "", <STDIN>)' < "$OUTPUT" ); then
+   die "$LINENO: invalid trace JSON"
+fi
+if [[ "$(grep -oF '"ph":"X"' "$OUTPUT" | wc -l)" -ne 4 ]]; then
+   die "$LINENO: wrong number of trace events"
+fi
+if ! ( grep -qF '"name":"target1","ph":"X","pid":1,"tid":1' "$OUTPUT" ); then
+   die "$LINENO: parallel recipes were not assigned separate lanes"
+fi
+
+# Check critical path goes through target1 (4s) instead of target2
+# (2s including value1).
+if ! ( grep -qF 'Critical path: 4.500s' "$PROFILE.txt" ); then
+   cat "$PROFILE.txt"
+   die "$LINENO: wrong critical path length"
+fi
+if ( grep -qE '^ .*target2' "$PROFILE.txt" ); then
+   die "$LINENO: unexpected target in critical path"
+fi
+
+# Check per-tool aggregates.
+if ! ( grep -qE '^tool\.pl +1 +1\.000s +0\.500s +3000kB' "$PROFILE.txt" ); then
+   die "$LINENO: cached command was not attributed to underlying tool"
+fi
+if ! ( grep -qE '^generate\.exe +1 ' "$PROFILE.txt" ); then
+   die "$LINENO: missing tool"
+fi
+
+# Check parallelism: 6.5s of recipes in 5s.
+if ! ( grep -qF 'Parallelism: 1.30 (peak 2)' "$PROFILE.txt" ); then
+   die "$LINENO: wrong parallelism"
+fi
+rm -f "$PROFILE" "$PROFILE.txt"
+
+
 # Cleanup.
 rm -f "$INPUT" "$OUTPUT"
 exit 0
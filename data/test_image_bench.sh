@@ -0,0 +1,55 @@
+#!/bin/bash
+# Run image_bench on the smallest image size, and check that every kernel
+# produced a result with nonzero throughput.
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {image_bench.exe}"
+   exit 1
+fi
+TOOL=$1
+OUTPUT=$(mktemp)
+
+set -euo pipefail
+
+function die
+{
+   echo "$1"
+   rm -f "$OUTPUT"
+   exit 1
+}
+
+"./$TOOL" 512 > "$OUTPUT" || die "$LINENO: benchmark failed"
+
+HEADER=$(printf '%s\t' kernel width height density iterations \
+                      ns_per_iteration mpix_per_second)
+if [[ "$(head -n 1 "$OUTPUT")" != "${HEADER%$'\t'}" ]]; then
+   die "$LINENO: missing header"
+fi
+
+# Smallest image size is 512x192, run with 3 densities.
+for kernel in \
+   OrderedDither \
+   FloydSteinbergDither \
+   CropTilesInPlace \
+   CropTiles \
+   StackPixels \
+   StackBitplanes \
+   EraseOddBitplaneRows \
+   ShrinkTiles \
+   PlaceStars; do
+   count=$(awk -F '\t' -v k="$kernel" \
+           '$1 == k && $2 == 512 && $3 == 192 && $5 > 0 && $7 > 0' \
+           "$OUTPUT" | wc -l)
+   if [[ "$count" -ne 3 ]]; then
+      die "$LINENO: $kernel: expected 3 results, got $count"
+   fi
+done
+
+# Check that there are no unexpected rows.
+if [[ "$(wc -l < "$OUTPUT")" -ne 28 ]]; then
+   die "$LINENO: unexpected number of lines"
+fi
+
+# Cleanup.
+rm -f "$OUTPUT"
+exit 0
@@ -0,0 +1,427 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {image_pipeline.exe}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+TEST_DIR=$(mktemp -d)
+INPUT_PIXELS="$TEST_DIR/input_pixels.ppm"
+INPUT_ALPHA="$TEST_DIR/input_alpha.ppm"
+INPUT_IMAGE="$TEST_DIR/input.png"
+ADD_INPUT_PIXELS="$TEST_DIR/add_input_pixels.ppm"
+ADD_INPUT_ALPHA="$TEST_DIR/add_input_alpha.ppm"
+ADD_INPUT_IMAGE="$TEST_DIR/add_input.png"
+EXPECTED_PIXELS="$TEST_DIR/expected_pixels.ppm"
+EXPECTED_ALPHA="$TEST_DIR/expected_alpha.ppm"
+ACTUAL_OUTPUT="$TEST_DIR/actual.png"
+
+
+function die
+{
+   echo "$1"
+   rm -rf "$TEST_DIR"
+   exit 1
+}
+
+function check_output
+{
+   local test_id=$1
+   local expected=$(ppmtoppm < "$EXPECTED_PIXELS" | ppmtopgm -plain)
+   local actual=$(pngtopnm "$ACTUAL_OUTPUT" | ppmtopgm -plain)
+   if [[ "$expected" != "$actual" ]]; then
+      echo "Expected pixels:"
+      echo "$expected"
+      echo "Actual pixels:"
+      echo "$actual"
+      die "FAIL: $test_id"
+   fi
+   expected=$(ppmtoppm < "$EXPECTED_ALPHA" | ppmtopgm -plain)
+   actual=$(pngtopnm -alpha "$ACTUAL_OUTPUT" | ppmtopgm -plain)
+   if [[ "$expected" != "$actual" ]]; then
+      echo "Expected alpha:"
+      echo "$expected"
+      echo "Actual alpha:"
+      echo "$actual"
+      die "FAIL: $test_id"
+   fi
+}
+
+
+# ................................................................
+# Test basic input/output.
+
+cat <<EOT > "$INPUT_PIXELS"
+P2
+6 4
+255
+255 0   0   0   255 0
+0   255 0   255 0   0
+0   0   255 0   0   255
+255 255 0   0   255 255
+EOT
+cat <<EOT > "$INPUT_ALPHA"
+P2
+6 4
+255
+255 0   255 255 0   255
+255 255 0   255 255 255
+255 255 255 0   255 255
+0   255 255 255 255 0
+EOT
+pnmtopng -alpha="$INPUT_ALPHA" "$INPUT_PIXELS" > "$INPUT_IMAGE"
+cp "$INPUT_PIXELS" "$EXPECTED_PIXELS"
+cp "$INPUT_ALPHA" "$EXPECTED_ALPHA"
+
+"./$TOOL" "load $INPUT_IMAGE | save $ACTUAL_OUTPUT"
+check_output "$LINENO: load and save"
+
+"./$TOOL" load "$INPUT_IMAGE" "|" save - > "$ACTUAL_OUTPUT"
+check_output "$LINENO: separate arguments"
+
+"./$TOOL" "load - | save -" < "$INPUT_IMAGE" > "$ACTUAL_OUTPUT"
+check_output "$LINENO: stdin"
+
+
+# ................................................................
+# Region.
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+3 2
+255
+255 0   255
+0   255 0
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+3 2
+255
+255 0   255
+255 255 0
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | region 3 2 1 1 | save $ACTUAL_OUTPUT"
+check_output "$LINENO: region"
+
+"./$TOOL" "load $INPUT_IMAGE | region 7 1 0 0 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: region width check"
+"./$TOOL" "load $INPUT_IMAGE | region 1 1 0 4 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: region height check"
+
+
+# ................................................................
+# Tile crop.
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+4 2
+255
+0   0   255 0
+0   255 0   255
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+4 2
+255
+0   255 0   255
+255 255 255 255
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | crop 3 2 2 1 1 0 | save $ACTUAL_OUTPUT"
+check_output "$LINENO: crop"
+
+"./$TOOL" "load $INPUT_IMAGE | crop 4 2 2 1 1 0 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: crop size check"
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+2 1
+255
+255 0
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+2 1
+255
+0   255
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | region 6 2 0 0 | crop 3 2 2 1 1 0 | region 2 1 2 0 | save $ACTUAL_OUTPUT"
+check_output "$LINENO: multiple crops"
+
+
+# ................................................................
+# Stack and append.
+
+cat <<EOT > "$ADD_INPUT_PIXELS"
+P2
+6 4
+255
+0   255 0   0   0   0
+0   0   0   0   0   0
+255 255 255 255 255 255
+0   0   0   0   0   0
+EOT
+cat <<EOT > "$ADD_INPUT_ALPHA"
+P2
+6 4
+255
+0   255 0   0   0   0
+0   0   0   0   0   0
+255 255 255 255 255 255
+0   0   0   0   0   0
+EOT
+pnmtopng -alpha="$ADD_INPUT_ALPHA" "$ADD_INPUT_PIXELS" > "$ADD_INPUT_IMAGE"
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+6 4
+255
+255 255 0   0   255 0
+0   255 0   255 0   0
+255 255 255 255 255 255
+255 255 0   0   255 255
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+6 4
+255
+255 255 255 255 0   255
+255 255 0   255 255 255
+255 255 255 255 255 255
+0   255 255 255 255 0
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | stack $ADD_INPUT_IMAGE | save $ACTUAL_OUTPUT"
+check_output "$LINENO: stack"
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+6 4
+255
+255 255 0   0   255 0
+0   0   0   0   0   0
+255 255 255 255 255 255
+0   0   0   0   0   0
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+6 4
+255
+255 255 255 255 0   255
+0   0   0   0   0   0
+255 255 255 255 255 255
+0   0   0   0   0   0
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | stack $ADD_INPUT_IMAGE | stripes | save $ACTUAL_OUTPUT"
+check_output "$LINENO: stack + stripes"
+
+cat <<EOT > "$EXPECTED_PIXELS"
+P2
+3 4
+255
+255 0   0
+0   255 0
+0   255 0
+0   0   0
+EOT
+cat <<EOT > "$EXPECTED_ALPHA"
+P2
+3 4
+255
+255 0   255
+255 255 0
+0   255 0
+0   0   0
+EOT
+
+"./$TOOL" "load $INPUT_IMAGE | region 3 2 0 0 | save $TEST_DIR/top.png"
+"./$TOOL" "load $ADD_INPUT_IMAGE | region 3 2 0 0 | save $TEST_DIR/bottom.png"
+"./$TOOL" "load $TEST_DIR/top.png | append $TEST_DIR/bottom.png | save $ACTUAL_OUTPUT"
+check_output "$LINENO: append"
+
+"./$TOOL" "load $TEST_DIR/top.png | stack $ADD_INPUT_IMAGE | save -" \
+   > /dev/null 2>&1 && die "$LINENO: stack size check"
+"./$TOOL" "load $TEST_DIR/top.png | append $ADD_INPUT_IMAGE | save -" \
+   > /dev/null 2>&1 && die "$LINENO: append size check"
+
+
+# ................................................................
+# Dither.
+
+ppmmake rgb:ff/ff/ff 8 8 | pnmtopng > "$INPUT_IMAGE"
+ppmmake rgb:ff/ff/ff 8 8 > "$EXPECTED_PIXELS"
+ppmmake rgb:ff/ff/ff 8 8 > "$EXPECTED_ALPHA"
+
+"./$TOOL" "load $INPUT_IMAGE | dither | save $ACTUAL_OUTPUT"
+check_output "$LINENO: dither"
+
+"./$TOOL" "load $INPUT_IMAGE | fs_dither | save $ACTUAL_OUTPUT"
+check_output "$LINENO: fs_dither"
+
+
+# ................................................................
+# Presets.
+
+# Final preset tries different color types and bit depths, so check a few
+# inputs that exercise each of those, including translucent pixels with
+# different colors.
+function check_presets
+{
+   local test_id=$1
+   pnmtopng -alpha="$INPUT_ALPHA" "$INPUT_PIXELS" > "$INPUT_IMAGE"
+   cp "$INPUT_PIXELS" "$EXPECTED_PIXELS"
+   cp "$INPUT_ALPHA" "$EXPECTED_ALPHA"
+
+   "./$TOOL" --preset=final "load $INPUT_IMAGE | save $ACTUAL_OUTPUT"
+   check_output "$test_id: final"
+   "./$TOOL" "load $INPUT_IMAGE | save $ACTUAL_OUTPUT" --preset final
+   check_output "$test_id: final, separate argument"
+   "./$TOOL" --preset=intermediate "load $INPUT_IMAGE | save $ACTUAL_OUTPUT"
+   check_output "$test_id: intermediate"
+}
+
+# Palette with transparency.
+cat <<EOT > "$INPUT_PIXELS"
+P2
+5 2
+255
+0   17  34  100 255
+255 100 34  17  0
+EOT
+cat <<EOT > "$INPUT_ALPHA"
+P2
+5 2
+255
+0   0   128 255 255
+255 255 128 0   0
+EOT
+check_presets "$LINENO: palette"
+
+# 1bit gray.
+cat <<EOT > "$INPUT_PIXELS"
+P2
+3 2
+255
+0   255 0
+255 0   255
+EOT
+ppmmake rgb:ff/ff/ff 3 2 | ppmtopgm > "$INPUT_ALPHA"
+check_presets "$LINENO: 1bit gray"
+
+# 2bit gray.
+cat <<EOT > "$INPUT_PIXELS"
+P2
+4 1
+255
+0   85  170 255
+EOT
+ppmmake rgb:ff/ff/ff 4 1 | ppmtopgm > "$INPUT_ALPHA"
+check_presets "$LINENO: 2bit gray"
+
+# More than 256 distinct pixel values.
+perl -e 'print "P2\n20 20\n255\n";
+         for $y (0..19) { print join(" ", map {($_ * 13 + $y * 7) % 256} 0..19), "\n"; }' \
+   > "$INPUT_PIXELS"
+perl -e 'print "P2\n20 20\n255\n";
+         for $y (0..19) { print join(" ", map {($_ * 29 + $y * 3) % 256} 0..19), "\n"; }' \
+   > "$INPUT_ALPHA"
+check_presets "$LINENO: gray alpha"
+
+# Color input that is loaded and saved without other stages should keep
+# its colors, which is how the itch.io cover is written.
+function check_color_presets
+{
+   local test_id=$1
+   local preset expected actual
+   pnmtopng -alpha="$INPUT_ALPHA" "$INPUT_PIXELS" > "$INPUT_IMAGE"
+   for preset in final intermediate; do
+      "./$TOOL" --preset=$preset "load $INPUT_IMAGE | save $ACTUAL_OUTPUT"
+      expected=$(ppmtoppm -plain < "$INPUT_PIXELS")
+      actual=$(pngtopnm "$ACTUAL_OUTPUT" | ppmtoppm -plain)
+      if [[ "$expected" != "$actual" ]]; then
+         echo "Expected pixels:"
+         echo "$expected"
+         echo "Actual pixels:"
+         echo "$actual"
+         die "FAIL: $test_id: $preset"
+      fi
+      expected=$(ppmtoppm < "$INPUT_ALPHA" | ppmtopgm -plain)
+      actual=$(pngtopnm -alpha "$ACTUAL_OUTPUT" | ppmtopgm -plain)
+      if [[ "$expected" != "$actual" ]]; then
+         echo "Expected alpha:"
+         echo "$expected"
+         echo "Actual alpha:"
+         echo "$actual"
+         die "FAIL: $test_id: $preset"
+      fi
+   done
+}
+
+# Color palette with transparency.
+cat <<EOT > "$INPUT_PIXELS"
+P3
+3 2
+255
+255 0   0     0   255 0     0   0   255
+10  20  30    200 200 200   1   2   3
+EOT
+cat <<EOT > "$INPUT_ALPHA"
+P2
+3 2
+255
+255 128 0
+255 255 4
+EOT
+check_color_presets "$LINENO: color palette"
+
+# Opaque color with more than 256 distinct pixel values.
+perl -e 'print "P3\n20 20\n255\n";
+         for $y (0..19) { print join(" ", map {(($_ * 13 + $y * 7) % 256) . " " .
+                                               (($_ * 5 + $y * 11) % 256) . " " .
+                                               (($_ * 3 + $y * 17) % 256)} 0..19), "\n"; }' \
+   > "$INPUT_PIXELS"
+ppmmake rgb:ff/ff/ff 20 20 | ppmtopgm > "$INPUT_ALPHA"
+check_color_presets "$LINENO: opaque color"
+
+# Color is dropped once any other stage runs.
+"./$TOOL" "load $INPUT_IMAGE | region 20 20 0 0 | save $ACTUAL_OUTPUT"
+[[ $(pngtopnm "$ACTUAL_OUTPUT" | head -c 2) == "P5" ]] \
+   || die "$LINENO: color converted to gray"
+
+"./$TOOL" --preset=unknown "load $INPUT_IMAGE | save -" \
+   > /dev/null 2>&1 && die "$LINENO: unknown preset"
+
+
+# ................................................................
+# Syntax errors.
+
+"./$TOOL" "load $INPUT_IMAGE | unknown | save -" \
+   > /dev/null 2>&1 && die "$LINENO: unknown stage"
+"./$TOOL" "load $INPUT_IMAGE | region 1 1 0 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: missing argument"
+"./$TOOL" "load $INPUT_IMAGE | region 1 1 0 0 0 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: extra argument"
+"./$TOOL" "load $INPUT_IMAGE | region 1 x 0 0 | save -" \
+   > /dev/null 2>&1 && die "$LINENO: invalid argument"
+"./$TOOL" "load | save -" \
+   > /dev/null 2>&1 && die "$LINENO: missing filename"
+
+# Loading a missing file after a color image should fail cleanly, as
+# opposed to crashing while freeing the previous image.
+status=0
+"./$TOOL" "load $INPUT_IMAGE | load $TEST_DIR/missing.png | save -" \
+   > /dev/null 2>&1 || status=$?
+[[ $status -eq 1 ]] || die "$LINENO: missing file status $status"
+"./$TOOL" "dither | save -" \
+   > /dev/null 2>&1 && die "$LINENO: missing input"
+
+
+# ................................................................
+# Cleanup.
+rm -rf "$TEST_DIR"
+exit 0
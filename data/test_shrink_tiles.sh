@@ -69,6 +69,22 @@ run_test $LINENO  16 8  13 5 1 1
 run_test $LINENO  8 8   6 5 1 1
 run_test $LINENO  4 4   2 2 1 1
 
+# Per-cell bounding boxes.
+cat <<EOT > "$EXPECTED"
+2 2 1 1
+2 1 1 2
+1 2 1 1
+1 2 1 1
+2 1 1 1
+0 0 0 0
+1 1 2 1
+1 1 1 1
+EOT
+"./$TOOL" --cells 4 4 "$INPUT" > "$ACTUAL"
+if ! ( diff "$EXPECTED" "$ACTUAL" ); then
+   die "Failed at line $LINENO"
+fi
+
 # Try another input to exercise different offsets.
 # 0 0 0 0 0  0 0 0 0 0  0 0 0 0 0
 # 0 0 0 1 1  0 0 0 0 0  0 0 0 0 0
@@ -89,6 +105,26 @@ run_test $LINENO  15 6  11 5 3 1
 run_test $LINENO  15 3  11 2 3 1
 run_test $LINENO  5 3   2 2 3 1
 
+# Content that is exactly 1 pixel wide or tall.  These used to be
+# reported as blank.
+convert "$TEST_DIR/blank.png" \
+   -fill "xc:#010101" -draw "rectangle 5,2 5,6" \
+   "$TEST_DIR/input.png"
+run_test $LINENO  4 4   1 4 1 0
+run_test $LINENO  16 8  1 5 5 2
+
+convert "$TEST_DIR/blank.png" \
+   -fill "xc:#010101" -draw "rectangle 2,3 12,3" \
+   "$TEST_DIR/input.png"
+run_test $LINENO  4 4   4 1 0 3
+run_test $LINENO  16 8  11 1 2 3
+
+convert "$TEST_DIR/blank.png" \
+   -fill "xc:#010101" -draw "rectangle 9,3 9,3" \
+   "$TEST_DIR/input.png"
+run_test $LINENO  4 4   1 1 1 3
+run_test $LINENO  16 8  1 1 9 3
+
 # Try a few no-crop cases.
 pgmmake 1 30 30 | pnmtopng > "$TEST_DIR/input.png"
 
@@ -0,0 +1,140 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {split_layers.pl}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+TOOL_DIR=$(dirname "$TOOL")
+TEST_DIR=$(mktemp -d)
+
+function die
+{
+   echo "$1"
+   rm -rf "$TEST_DIR"
+   exit 1
+}
+
+cat <<EOT > "$TEST_DIR/input.svg"
+<?xml version="1.0" encoding="UTF-8" standalone="no"?>
+<svg
+   xmlns:inkscape="http://www.inkscape.org/namespaces/inkscape"
+   xmlns:sodipodi="http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd"
+   xmlns:xlink="http://www.w3.org/1999/xlink"
+   xmlns="http://www.w3.org/2000/svg"
+   xmlns:svg="http://www.w3.org/2000/svg">
+   <sodipodi:namedview id="view" />
+   <g
+      inkscape:groupmode="layer"
+      inkscape:label="ignored"
+      style="display:none">
+      <rect x="0" y="0" width="1" height="1" id="ignored_rect" />
+   </g>
+   <g
+      inkscape:groupmode="layer"
+      inkscape:label="selected">
+      <rect x="0" y="0" width="1" height="1" id="selected_rect"
+            inkscape:label="obj1" />
+      <rect x="0" y="0" width="1" height="1" id="other_rect"
+            inkscape:label="obj2" />
+   </g>
+</svg>
+EOT
+
+
+# Outputs should be identical to the equivalent select_layers.pl and
+# select_obj.pl commands.  Specs are listed such that each layer is
+# removed by one spec and needed by a later spec, to verify that removed
+# nodes are restored.
+perl "$TOOL" "$TEST_DIR/input.svg" \
+   "$TEST_DIR/actual1.svg:^selected:output1.png" \
+   "$TEST_DIR/actual2.svg:^ignored:output2.png" \
+   "$TEST_DIR/actual3.svg:^selected:output3.png:selected:obj2" \
+   "$TEST_DIR/actual4.svg:.*:output4.png"
+
+perl "$TOOL_DIR/select_layers.pl" "^selected" output1.png \
+   "$TEST_DIR/input.svg" > "$TEST_DIR/expected1.svg"
+perl "$TOOL_DIR/select_layers.pl" "^ignored" output2.png \
+   "$TEST_DIR/input.svg" > "$TEST_DIR/expected2.svg"
+perl "$TOOL_DIR/select_layers.pl" "^selected" output3.png \
+   "$TEST_DIR/input.svg" \
+   | perl "$TOOL_DIR/select_obj.pl" "selected" "obj2" \
+   > "$TEST_DIR/expected3.svg"
+perl "$TOOL_DIR/select_layers.pl" ".*" output4.png \
+   "$TEST_DIR/input.svg" > "$TEST_DIR/expected4.svg"
+
+for i in 1 2 3 4; do
+   if ! ( diff -q "$TEST_DIR/expected$i.svg" "$TEST_DIR/actual$i.svg" \
+          > /dev/null ); then
+      diff -u "$TEST_DIR/expected$i.svg" "$TEST_DIR/actual$i.svg" || true
+      die "$LINENO: output $i mismatched"
+   fi
+done
+
+if ! ( grep -q -F "other_rect" "$TEST_DIR/actual3.svg" ); then
+   die "$LINENO: missing selected object"
+fi
+if ( grep -q -F "selected_rect" "$TEST_DIR/actual3.svg" ); then
+   die "$LINENO: found unexpected object"
+fi
+
+
+# Outputs for world.svg should be identical to the per-file rules that
+# t_world_layers.stamp replaced.  Specs here are the same as Makefile.
+WORLD="$TOOL_DIR/world.svg"
+FILTER="perl $TOOL_DIR/remove_unused_defs.pl"
+specs=("$TEST_DIR/world_copyright.svg:^title copyright:t_copyright.png")
+for c in 0 1 2 3 4 5 6 7 8 9 a b c d e f; do
+   specs+=("$TEST_DIR/world_char_$c.svg:^title text:t_title.png:title text:char_$c")
+done
+specs+=("$TEST_DIR/world_itch_cover.svg:^itch cover:t_itch_cover.png")
+perl "$TOOL" "--filter=$FILTER" "$WORLD" "${specs[@]}"
+
+perl "$TOOL_DIR/select_layers.pl" '^title copyright' t_copyright.png \
+   "$WORLD" | $FILTER > "$TEST_DIR/expected_copyright.svg"
+for c in 0 1 2 3 4 5 6 7 8 9 a b c d e f; do
+   perl "$TOOL_DIR/select_layers.pl" '^title text' t_title.png "$WORLD" \
+      | perl "$TOOL_DIR/select_obj.pl" 'title text' "char_$c" \
+      | $FILTER > "$TEST_DIR/expected_char_$c.svg"
+done
+perl "$TOOL_DIR/select_layers.pl" '^itch cover' t_itch_cover.png \
+   "$WORLD" | $FILTER > "$TEST_DIR/expected_itch_cover.svg"
+
+for i in copyright char_{0,1,2,3,4,5,6,7,8,9,a,b,c,d,e,f} itch_cover; do
+   if ! ( cmp -s "$TEST_DIR/expected_$i.svg" "$TEST_DIR/world_$i.svg" ); then
+      diff -u "$TEST_DIR/expected_$i.svg" "$TEST_DIR/world_$i.svg" || true
+      die "$LINENO: world.svg output $i mismatched"
+   fi
+done
+
+
+# Unchanged outputs are not touched.
+touch -d '2000-01-01' "$TEST_DIR/actual1.svg"
+perl "$TOOL" "$TEST_DIR/input.svg" "$TEST_DIR/actual1.svg:^selected:output1.png"
+if [[ "$(stat -c %Y "$TEST_DIR/actual1.svg")" -ne \
+      "$(date -d '2000-01-01' +%s)" ]]; then
+   die "$LINENO: unchanged output was touched"
+fi
+
+
+# Filter is applied to each output.
+perl "$TOOL" "--filter=sed -e s/selected_rect/filtered_rect/" \
+   "$TEST_DIR/input.svg" \
+   "$TEST_DIR/filtered.svg:^selected:output1.png"
+if ! ( grep -q -F "filtered_rect" "$TEST_DIR/filtered.svg" ); then
+   die "$LINENO: filter was not applied"
+fi
+
+
+# Bad specs are rejected.
+if ( perl "$TOOL" "$TEST_DIR/input.svg" "$TEST_DIR/bad.svg:^selected" \
+     > /dev/null 2>&1 ); then
+   die "$LINENO: bad spec was accepted"
+fi
+
+
+# Cleanup.
+rm -rf "$TEST_DIR"
+exit 0
@@ -263,6 +263,54 @@ EOT
 check_output "$LINENO: stack 3"
 
 
+# ................................................................
+# Leave-one-out composites, compared against stacking the same images
+# individually.
+
+"./$TOOL" --leave-one-out "$INPUT_IMAGE" "$TEST_DIR/loo_%d.png" \
+   "$ADD_INPUT_IMAGE" "$ADD2_INPUT_IMAGE" "$INPUT_IMAGE"
+[[ -e "$TEST_DIR/loo_3.png" ]] && die "$LINENO: unexpected output"
+
+"./$TOOL" "$INPUT_IMAGE" "$ADD2_INPUT_IMAGE" "$INPUT_IMAGE" \
+   > "$ACTUAL_OUTPUT"
+pngtopnm "$ACTUAL_OUTPUT" > "$EXPECTED_PIXELS"
+pngtopnm -alpha "$ACTUAL_OUTPUT" > "$EXPECTED_ALPHA"
+cp "$TEST_DIR/loo_0.png" "$ACTUAL_OUTPUT"
+check_output "$LINENO: leave out 0"
+
+"./$TOOL" "$INPUT_IMAGE" "$ADD_INPUT_IMAGE" "$INPUT_IMAGE" \
+   > "$ACTUAL_OUTPUT"
+pngtopnm "$ACTUAL_OUTPUT" > "$EXPECTED_PIXELS"
+pngtopnm -alpha "$ACTUAL_OUTPUT" > "$EXPECTED_ALPHA"
+cp "$TEST_DIR/loo_1.png" "$ACTUAL_OUTPUT"
+check_output "$LINENO: leave out 1"
+
+"./$TOOL" "$INPUT_IMAGE" "$ADD_INPUT_IMAGE" "$ADD2_INPUT_IMAGE" \
+   > "$ACTUAL_OUTPUT"
+pngtopnm "$ACTUAL_OUTPUT" > "$EXPECTED_PIXELS"
+pngtopnm -alpha "$ACTUAL_OUTPUT" > "$EXPECTED_ALPHA"
+cp "$TEST_DIR/loo_2.png" "$ACTUAL_OUTPUT"
+check_output "$LINENO: leave out 2"
+
+"./$TOOL" --leave-one-out "$INPUT_IMAGE" "$TEST_DIR/loo.png" \
+   "$ADD_INPUT_IMAGE" "$ADD2_INPUT_IMAGE" > /dev/null 2>&1 \
+   && die "$LINENO: output pattern check"
+
+
+# ................................................................
+# Check that non-black-and-white input is rejected.
+
+ppmmake rgb:80/80/80 3 3 | pnmtopng > "$INPUT_IMAGE"
+"./$TOOL" "$INPUT_IMAGE" > /dev/null 2>&1 \
+   && die "$LINENO: gray pixels"
+
+ppmmake rgb:ff/ff/ff 3 3 > "$INPUT_PIXELS"
+pgmmake 0.5 3 3 > "$INPUT_ALPHA"
+pnmtopng -alpha="$INPUT_ALPHA" "$INPUT_PIXELS" > "$INPUT_IMAGE"
+"./$TOOL" "$INPUT_IMAGE" > /dev/null 2>&1 \
+   && die "$LINENO: translucent pixels"
+
+
 # ................................................................
 # Cleanup.
 rm -rf "$TEST_DIR"
@@ -66,6 +66,19 @@ f()
 local function unused_recursive_function()
    unused_recursive_function()
 end
+local discard_table <const> = {}
+function discard_table.f()
+   print("discard")
+end
+function discard_table:g()
+   print("discard")
+end
+assert(discard_table.f())
+local keep_table <const> = {}
+function keep_table.f()
+   print("keep")
+end
+keep_table.f()
 EOT
 cat <<EOT > "$EXPECTED_OUTPUT"
 print(1)
@@ -113,6 +126,19 @@ f()
 
 
 
+
+
+
+
+
+
+
+
+local keep_table <const> = {}
+function keep_table.f()
+   print("keep")
+end
+keep_table.f()
 EOT
 
 "./$TOOL" "$INPUT" > "$ACTUAL_OUTPUT"
@@ -0,0 +1,240 @@
+#!/bin/bash
+# Test svg_to_png.sh with a fake Inkscape, both with and without servers.
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {svg_to_png.sh}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+TEST_DIR=$(mktemp -d)
+
+# Kill a process and all its descendants, without giving them a chance
+# to clean up.
+function kill_tree
+{
+   local child
+   if [[ -z "$1" ]]; then
+      return 0
+   fi
+   for child in $(pgrep -P "$1"); do
+      kill_tree "$child"
+   done
+   kill -9 "$1" 2> /dev/null || true
+}
+
+# Kill all servers started by this test.
+function kill_servers
+{
+   local ready
+   for ready in t_inkscape_server_*.ready; do
+      if [[ -e "$ready" ]]; then
+         kill_tree "$(cat "$ready")"
+      fi
+   done
+}
+
+function die
+{
+   echo "$1"
+   kill_servers
+   cd /
+   rm -rf "$TEST_DIR"
+   exit 1
+}
+
+# Run tests from inside the temporary directory, so that cache entries
+# and server pipes don't end up in the current directory.
+cp "$TOOL" "$TEST_DIR/svg_to_png.sh"
+cd "$TEST_DIR"
+
+# Fake Inkscape.  Each output is a text file that says how it was made,
+# followed by a copy of the input, and each export is also appended to
+# log.txt.
+#
+# Shell mode mimics what Inkscape 1.4 does: print a banner, print a prompt
+# without a newline before reading each line, and run the semicolon
+# separated actions on each line.  Exports of "hang" inputs never finish.
+cat <<'EOT' > inkscape.sh
+#!/bin/bash
+if [[ "${1:-}" == "--shell" ]]; then
+   echo "Inkscape interactive shell mode.  Type 'quit' to quit."
+   printf "> "
+   while read -r line; do
+      IFS=';' read -ra actions <<< "$line"
+      for action in "${actions[@]}"; do
+         action=$(echo $action)
+         case "$action" in
+            inkscape-version)
+               echo "Inkscape 1.4 (86a8ad7, 2024-10-11)"
+               ;;
+            file-open:*)
+               input=${action#file-open:}
+               ;;
+            export-filename:*)
+               output=${action#export-filename:}
+               ;;
+            export-do)
+               if [[ "$(cat "$input")" == "hang" ]]; then
+                  sleep 60
+               fi
+               { echo shell; cat "$input"; } > "$output"
+               echo "shell $input" >> log.txt
+               ;;
+            quit)
+               exit 0
+               ;;
+         esac
+      done
+      printf "> "
+   done
+   exit 0
+fi
+
+for arg in "$@"; do
+   case "$arg" in
+      --export-filename=*)
+         output=${arg#--export-filename=}
+         ;;
+   esac
+done
+input=${@: -1}
+{ echo direct; cat "$input"; } > "$output"
+echo "direct $input" >> log.txt
+EOT
+chmod +x inkscape.sh
+export INKSCAPE=./inkscape.sh
+
+# Write a new input with unique contents, so that it's never cached.
+function new_input
+{
+   echo "$1" > "$1.svg"
+}
+
+# Convert a single input with a time limit, and check how it was made.
+function check_convert
+{
+   local line_number=$1
+   local name=$2
+   local expected=$3
+
+   new_input "$name"
+   timeout 20 ./svg_to_png.sh "$name.svg" "$name.png" \
+      || die "$line_number: conversion failed or timed out"
+   if [[ "$(head -n 1 "$name.png")" != "$expected" ]]; then
+      die "$line_number: expected $expected output"
+   fi
+}
+
+# ................................................................
+# No servers.
+
+check_convert $LINENO direct0 direct
+
+# ................................................................
+# All servers alive.
+
+timeout 20 ./svg_to_png.sh --start-servers 2 \
+   || die "$LINENO: failed to start servers"
+for i in 0 1; do
+   [[ -p "t_inkscape_server_$i.fifo" ]] || die "$LINENO: missing fifo $i"
+   [[ -s "t_inkscape_server_$i.ready" ]] || die "$LINENO: missing pid $i"
+done
+
+# Run a few conversions in parallel, more than the number of servers.
+for i in 0 1 2 3; do
+   new_input "parallel$i"
+   timeout 20 ./svg_to_png.sh "parallel$i.svg" "parallel$i.png" &
+done
+for i in 0 1 2 3; do
+   wait -n || die "$LINENO: parallel conversion failed"
+done
+for i in 0 1 2 3; do
+   if [[ "$(head -n 1 "parallel$i.png")" != "shell" ]]; then
+      die "$LINENO: parallel$i was not converted by a server"
+   fi
+done
+
+timeout 20 ./svg_to_png.sh --stop-servers || die "$LINENO: stop timed out"
+for (( t = 0; t < 100; t++ )); do
+   if ! ls t_inkscape_server_* > /dev/null 2>&1; then
+      break
+   fi
+   sleep 0.1
+done
+if ls t_inkscape_server_* > /dev/null 2>&1; then
+   die "$LINENO: servers did not clean up"
+fi
+
+# ................................................................
+# Dead server in the middle.
+
+timeout 20 ./svg_to_png.sh --start-servers 3 \
+   || die "$LINENO: failed to start servers"
+kill_tree "$(cat t_inkscape_server_1.ready)"
+for i in 0 1 2 3 4 5; do
+   check_convert $LINENO dead$i shell
+done
+if [[ -e t_inkscape_server_1.fifo && ! -p t_inkscape_server_1.fifo ]]; then
+   die "$LINENO: dead server fifo became a regular file"
+fi
+
+# Stopping servers should not hang on the dead server, and should clean
+# up after it.
+timeout 20 ./svg_to_png.sh --stop-servers || die "$LINENO: stop timed out"
+if [[ -e t_inkscape_server_1.fifo || -e t_inkscape_server_1.ready ]]; then
+   die "$LINENO: dead server was not cleaned up"
+fi
+for (( t = 0; t < 100; t++ )); do
+   if ! ls t_inkscape_server_* > /dev/null 2>&1; then
+      break
+   fi
+   sleep 0.1
+done
+
+# ................................................................
+# All servers dead, clients should fall back to running Inkscape.
+
+timeout 20 ./svg_to_png.sh --start-servers 2 \
+   || die "$LINENO: failed to start servers"
+kill_servers
+check_convert $LINENO fallback0 direct
+timeout 20 ./svg_to_png.sh --stop-servers || die "$LINENO: stop timed out"
+if ls t_inkscape_server_* > /dev/null 2>&1; then
+   die "$LINENO: dead servers were not cleaned up"
+fi
+
+# ................................................................
+# Server dies while a request is pending.
+
+timeout 20 ./svg_to_png.sh --start-servers 1 \
+   || die "$LINENO: failed to start servers"
+echo hang > hang.svg
+timeout 20 ./svg_to_png.sh hang.svg hang.png > hang.txt &
+CLIENT=$!
+for (( t = 0; t < 100; t++ )); do
+   if ls t_inkscape_server_reply.* > /dev/null 2>&1; then
+      break
+   fi
+   sleep 0.1
+done
+kill_servers
+STATUS=0
+wait "$CLIENT" || STATUS=$?
+if [[ $STATUS -eq 0 ]]; then
+   die "$LINENO: unexpected success"
+fi
+if [[ $STATUS -eq 124 ]]; then
+   die "$LINENO: client did not notice that server died"
+fi
+if ! ( grep -qF "Inkscape server failed" hang.txt ); then
+   die "$LINENO: missing error message"
+fi
+[[ -e hang.png ]] && die "$LINENO: unexpected output"
+timeout 20 ./svg_to_png.sh --stop-servers || die "$LINENO: stop timed out"
+
+# Cleanup.
+cd /
+rm -rf "$TEST_DIR"
+exit 0
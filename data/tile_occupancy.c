@@ -0,0 +1,114 @@
+/* Bounding boxes of nonempty pixels in tile tables.
+
+   See tile_occupancy.h for descriptions.
+*/
+
+#include"tile_occupancy.h"
+#include<stdlib.h>
+
+/* Check if any bit in the range [start, start + width) is set. */
+static int HasBits(const uint64_t *bits, int start, int width)
+{
+   uint64_t mask;
+   int x, end = start + width;
+
+   /* Check one word at a time, masking off bits outside of range in the
+      first and last words.                                               */
+   for(x = start; x < end; x += BITPLANE_WORD_BITS - x % BITPLANE_WORD_BITS)
+   {
+      mask = ~(uint64_t)0 << (x % BITPLANE_WORD_BITS);
+      if( end / BITPLANE_WORD_BITS == x / BITPLANE_WORD_BITS )
+         mask &= ((uint64_t)1 << (end % BITPLANE_WORD_BITS)) - 1;
+      if( (bits[x / BITPLANE_WORD_BITS] & mask) != 0 )
+         return 1;
+   }
+   return 0;
+}
+
+/* Check if a single bit is set. */
+static int HasBit(const uint64_t *bits, int x)
+{
+   return (int)((bits[x / BITPLANE_WORD_BITS] >> (x % BITPLANE_WORD_BITS)) & 1);
+}
+
+int InitOccupancy(const Bitplane *image, int tile_width, int tile_height,
+                  Occupancy *occupancy)
+{
+   const uint64_t *p = image->alpha;
+   uint64_t *columns;
+   int x, y, tile_x;
+
+   occupancy->tile_width = tile_width;
+   occupancy->tile_height = tile_height;
+   occupancy->tiles_x = image->width / tile_width;
+   occupancy->tiles_y = image->height / tile_height;
+   occupancy->stride = image->stride;
+   occupancy->columns = (uint64_t*)calloc(occupancy->tiles_y * image->stride,
+                                          sizeof(uint64_t));
+   occupancy->rows = (unsigned char*)malloc(image->height * occupancy->tiles_x);
+   if( occupancy->columns == NULL || occupancy->rows == NULL )
+   {
+      free(occupancy->columns);
+      free(occupancy->rows);
+      return 1;
+   }
+
+   for(y = 0; y < image->height; y++, p += image->stride)
+   {
+      columns = occupancy->columns + (y / tile_height) * image->stride;
+      for(x = 0; x < image->stride; x++)
+         columns[x] |= p[x];
+      for(tile_x = 0; tile_x < occupancy->tiles_x; tile_x++)
+      {
+         occupancy->rows[y * occupancy->tiles_x + tile_x] =
+            (unsigned char)HasBits(p, tile_x * tile_width, tile_width);
+      }
+   }
+   return 0;
+}
+
+void FreeOccupancy(Occupancy *occupancy)
+{
+   free(occupancy->columns);
+   free(occupancy->rows);
+}
+
+void GetCellBox(const Occupancy *occupancy, int tile_x, int tile_y,
+                Box *box)
+{
+   const int w = occupancy->tile_width;
+   const int h = occupancy->tile_height;
+   const uint64_t *columns = occupancy->columns + tile_y * occupancy->stride;
+   const unsigned char *rows =
+      occupancy->rows + tile_y * h * occupancy->tiles_x + tile_x;
+   int i;
+
+   box->x0 = box->y0 = 0;
+   box->x1 = box->y1 = -1;
+   if( !HasBits(columns, tile_x * w, w) )
+      return;
+
+   for(i = 0; !HasBit(columns, tile_x * w + i); i++);
+   box->x0 = i;
+   for(i = w - 1; !HasBit(columns, tile_x * w + i); i--);
+   box->x1 = i;
+   for(i = 0; !rows[i * occupancy->tiles_x]; i++);
+   box->y0 = i;
+   for(i = h - 1; !rows[i * occupancy->tiles_x]; i--);
+   box->y1 = i;
+}
+
+void AddBox(const Box *cell, Box *box)
+{
+   if( cell->x1 < cell->x0 )
+      return;
+   if( box->x1 < box->x0 )
+   {
+      *box = *cell;
+      return;
+   }
+   if( box->x0 > cell->x0 ) box->x0 = cell->x0;
+   if( box->y0 > cell->y0 ) box->y0 = cell->y0;
+   if( box->x1 < cell->x1 ) box->x1 = cell->x1;
+   if( box->y1 < cell->y1 ) box->y1 = cell->y1;
+}
@@ -0,0 +1,53 @@
+/* Bounding boxes of nonempty pixels in tile tables.
+
+   This is the inner loop of shrink_tiles.  It's kept in a separate object
+   file so that image_bench can measure it on the same synthetic inputs as
+   the other image kernels.
+*/
+
+#ifndef TILE_OCCUPANCY_H_
+#define TILE_OCCUPANCY_H_
+
+#include"bitplane.h"
+
+/* Bounding box of nonempty pixels, relative to the top left corner of a
+   cell.  Empty boxes have x1 < x0.                                     */
+typedef struct
+{
+   int x0, y0, x1, y1;
+} Box;
+
+/* Summary of which rows and columns contain nonempty pixels, built in a
+   single row-major pass over the alpha plane.  All edges are derived
+   from this summary, so that we never walk the image column by column. */
+typedef struct
+{
+   int tile_width, tile_height;
+   int tiles_x, tiles_y;
+   int stride;
+
+   /* OR of all alpha rows within each row of tiles, one bitmask of
+      (tiles_y * stride) words.                                         */
+   uint64_t *columns;
+
+   /* Nonzero for each (row, cell column) that contains at least one
+      nonempty pixel, (height * tiles_x) entries.                       */
+   unsigned char *rows;
+} Occupancy;
+
+/* Build occupancy summary.  Image dimensions must be multiples of tile
+   size.  Returns 0 on success, nonzero if we ran out of memory.        */
+int InitOccupancy(const Bitplane *image, int tile_width, int tile_height,
+                  Occupancy *occupancy);
+
+/* Release occupancy summary. */
+void FreeOccupancy(Occupancy *occupancy);
+
+/* Compute bounding box for a single cell. */
+void GetCellBox(const Occupancy *occupancy, int tile_x, int tile_y,
+                Box *box);
+
+/* Expand box to include another box. */
+void AddBox(const Box *cell, Box *box);
+
+#endif
@@ -13,45 +13,291 @@
 
    Instead of the intuition above, we can also just brute force through all
    (2**4)**6 possible neighbor values to see if we can pick a valid center,
-   which is what this code does, and it only takes about one second to run.
-   This code also collects some statistics, so that we know how lucky we
-   need to be to pick a random center that would work.
+   which is what this code does.  This code also collects some statistics,
+   so that we know how lucky we need to be to pick a random center that
+   would work.
+
+   init_chains() in main.lua doesn't pick arbitrary centers, it XORs an
+   existing center with consecutive values in the lower 4 bits.  To verify
+   that this also works for 8bit modes, or if we were to adjust a different
+   number of bits, run:
+
+      ./xor_center_neighbor_experiment {neighbors} {width} {adjusted_bits}
+
+   Defaults are 6 neighbors, 4 bit values, and 4 adjusted bits.
+
+   Rather than enumerating neighbor values directly, we note that each
+   neighbor only matters through the set of adjustments that it rules out,
+   which only depends on (neighbor ^ center).  The center value itself
+   rules out adjustments in exactly the same way, so the center and its
+   neighbors are just (neighbors + 1) independent values.  We collect the
+   distinct sets of ruled out adjustments as bitmasks, and enumerate all
+   multisets of those masks, weighing each by the number of value
+   combinations it represents.  The number of valid adjustments is then
+   just an AND of the masks, followed by a popcount.
+
+   Build with "gcc -O3 -march=native -pthread".
 */
 
+#include<pthread.h>
+#include<stdint.h>
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
 
-#define NEIGHBOR_COUNT 6
+#define MAX_WIDTH          8
+#define MAX_NEIGHBOR_COUNT 16
+#define MAX_THREADS        64
 
-int main(int argc, char **argv)
+/* Number of words needed to hold 2**MAX_WIDTH bits. */
+#define MASK_WORDS         ((1 << MAX_WIDTH) / 64)
+
+/* Set of valid adjustments, bit i is set if XORing center with i is
+   acceptable with respect to a single neighbor or to the center itself.
+   Only the first mask_words words are used.                             */
+typedef struct
+{
+   uint64_t bits[MASK_WORDS];
+} Mask;
+
+/* Distinct mask, along with how many values produce that mask. */
+typedef struct
+{
+   Mask mask;
+   double count;
+
+   /* Some value that produces this mask. */
+   int value;
+} MaskClass;
+
+/* Experiment parameters and distinct masks, shared by all threads. */
+typedef struct
+{
+   int neighbor_count;
+   int width;
+   int adjusted_bits;
+   int mask_words;
+
+   /* Distinct masks for center value, or for (neighbor ^ center). */
+   MaskClass classes[1 << MAX_WIDTH];
+   int class_count;
+
+   int thread_count;
+} Experiment;
+
+/* Per-thread results. */
+typedef struct
+{
+   const Experiment *experiment;
+   int thread_index;
+
+   double all_choices;
+   int min_choices;
+   int min_center;
+   int min_neighbors[MAX_NEIGHBOR_COUNT];
+
+   /* Current mask indices for center followed by neighbors, in
+      nondecreasing order.                                              */
+   int indices[MAX_NEIGHBOR_COUNT + 1];
+} ThreadState;
+
+/* Add a mask to list of distinct masks, or increment the count of an
+   existing entry.                                                       */
+static void AddMaskClass(const Mask *mask, int value,
+                         MaskClass *classes, int *class_count)
 {
-   unsigned int center, neighbors, n;
-   int i, choices, all_choices = 0, min_choices = 16;
+   int i;
 
-   for(neighbors = 0; neighbors < (1 << (NEIGHBOR_COUNT * 4)); neighbors++)
+   for(i = 0; i < *class_count; i++)
    {
-      choices = 0;
-      for(center = 1; center < 15; center++)
+      if( memcmp(&classes[i].mask, mask, sizeof(Mask)) == 0 )
       {
-         for(i = 0; i < NEIGHBOR_COUNT; i++)
+         classes[i].count++;
+         return;
+      }
+   }
+   classes[i].mask = *mask;
+   classes[i].count = 1;
+   classes[i].value = value;
+   (*class_count)++;
+}
+
+/* Build mask with the first (1 << adjusted_bits) bits set, except for
+   up to two adjustments that are forbidden.  Adjustments that are out of
+   range are ignored.                                                    */
+static void BuildMask(int adjusted_bits, int forbid0, int forbid1,
+                      Mask *mask)
+{
+   const int size = 1 << adjusted_bits;
+   int i;
+
+   memset(mask, 0, sizeof(Mask));
+   for(i = 0; i < size; i++)
+   {
+      if( i != forbid0 && i != forbid1 )
+         mask->bits[i / 64] |= (uint64_t)1 << (i % 64);
+   }
+}
+
+/* Collect distinct masks. */
+static void InitMaskClasses(Experiment *e)
+{
+   const int all_ones = (1 << e->width) - 1;
+   Mask mask;
+   int v;
+
+   e->mask_words = ((1 << e->adjusted_bits) + 63) / 64;
+   e->class_count = 0;
+   for(v = 0; v <= all_ones; v++)
+   {
+      /* For a center value of v, adjustment i results in (v ^ i), so i
+         must not be v or (v ^ all_ones).
+
+         For a neighbor at (center ^ v), adjustment i results in
+         (center ^ i ^ neighbor) = (i ^ v), so i must not be v or
+         (v ^ all_ones) either.                                          */
+      BuildMask(e->adjusted_bits, v, v ^ all_ones, &mask);
+      AddMaskClass(&mask, v, e->classes, &e->class_count);
+   }
+}
+
+/* Count population of mask. */
+static int CountBits(const Mask *mask, int mask_words)
+{
+   int i, count = 0;
+
+   for(i = 0; i < mask_words; i++)
+      count += __builtin_popcountll(mask->bits[i]);
+   return count;
+}
+
+/* Enumerate remaining values, starting at index depth.
+
+   "weight" is the number of value combinations represented by the masks
+   chosen so far, and "run" is the number of times the previous mask index
+   has been repeated.                                                    */
+static void Enumerate(ThreadState *t, int depth, const Mask *current,
+                      double weight, int run)
+{
+   const Experiment *e = t->experiment;
+   const int first = depth == 0 ? t->thread_index : t->indices[depth - 1];
+   const int step = depth == 0 ? e->thread_count : 1;
+   Mask next;
+   int i, j, r, choices;
+
+   if( depth == e->neighbor_count + 1 )
+   {
+      choices = CountBits(current, e->mask_words);
+      t->all_choices += weight * choices;
+      if( t->min_choices > choices )
+      {
+         t->min_choices = choices;
+         t->min_center = e->classes[t->indices[0]].value;
+         for(j = 0; j < e->neighbor_count; j++)
          {
-            n = (neighbors >> (i * 4)) & 0xf;
-            if( (center ^ n) == 0x0 || (center ^ n) == 0xf )
-               break;
+            t->min_neighbors[j] =
+               e->classes[t->indices[j + 1]].value ^ t->min_center;
          }
-         if( i == NEIGHBOR_COUNT )
-            choices++;
       }
-      all_choices += choices;
+      return;
+   }
+
+   for(i = first; i < e->class_count; i += step)
+   {
+      t->indices[depth] = i;
+      r = depth > 0 && i == t->indices[depth - 1] ? run + 1 : 1;
+      for(j = 0; j < e->mask_words; j++)
+         next.bits[j] = current->bits[j] & e->classes[i].mask.bits[j];
+
+      /* Multiply by number of ways to pick this value, and number of
+         distinct orderings added by placing this value at this depth.  */
+      Enumerate(t, depth + 1, &next,
+                weight * e->classes[i].count * (depth + 1) / r, r);
+   }
+}
+
+static void *EnumerateThread(void *arg)
+{
+   ThreadState *t = (ThreadState*)arg;
+   Mask all;
 
-      if( min_choices > choices )
+   memset(&all, 0xff, sizeof(all));
+   t->all_choices = 0;
+   t->min_choices = 1 << MAX_WIDTH;
+   Enumerate(t, 0, &all, 1, 0);
+   return NULL;
+}
+
+int main(int argc, char **argv)
+{
+   static Experiment e;
+   static ThreadState threads[MAX_THREADS];
+   pthread_t thread_ids[MAX_THREADS];
+   double all_choices = 0, total;
+   int i, min_thread;
+
+   e.neighbor_count = argc > 1 ? atoi(argv[1]) : 6;
+   e.width = argc > 2 ? atoi(argv[2]) : 4;
+   e.adjusted_bits = argc > 3 ? atoi(argv[3]) : e.width;
+   if( argc > 4 ||
+       e.neighbor_count < 1 || e.neighbor_count > MAX_NEIGHBOR_COUNT ||
+       e.width < 2 || e.width > MAX_WIDTH ||
+       e.adjusted_bits < 1 || e.adjusted_bits > e.width )
+   {
+      printf("%s [{neighbors} [{width} [{adjusted_bits}]]]\n", *argv);
+      return 1;
+   }
+
+   InitMaskClasses(&e);
+   e.thread_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   if( e.thread_count < 1 )
+      e.thread_count = 1;
+   if( e.thread_count > MAX_THREADS )
+      e.thread_count = MAX_THREADS;
+   if( e.thread_count > e.class_count )
+      e.thread_count = e.class_count;
+
+   for(i = 0; i < e.thread_count; i++)
+   {
+      threads[i].experiment = &e;
+      threads[i].thread_index = i;
+      if( pthread_create(&thread_ids[i], NULL,
+                         EnumerateThread, &threads[i]) != 0 )
       {
-         min_choices = choices;
-         printf("%0*x: minimum = %d\n", NEIGHBOR_COUNT, neighbors, min_choices);
-         if( min_choices == 0 )
-            puts("Need more bits!");
+         fputs("Error creating thread\n", stderr);
+         return 1;
       }
    }
-   printf("Average = %.3f\n",
-          (double)all_choices / (1 << (NEIGHBOR_COUNT * 4)));
+
+   min_thread = 0;
+   for(i = 0; i < e.thread_count; i++)
+   {
+      pthread_join(thread_ids[i], NULL);
+      all_choices += threads[i].all_choices;
+      if( threads[min_thread].min_choices > threads[i].min_choices )
+         min_thread = i;
+   }
+
+   printf("%d neighbors, %d bit values, %d adjusted bits, %d mask classes\n",
+          e.neighbor_count, e.width, e.adjusted_bits,
+          e.class_count);
+   printf("Minimum = %d, center = %0*x, neighbors =",
+          threads[min_thread].min_choices,
+          (e.width + 3) / 4, threads[min_thread].min_center);
+   for(i = 0; i < e.neighbor_count; i++)
+   {
+      printf(" %0*x", (e.width + 3) / 4,
+             threads[min_thread].min_neighbors[i]);
+   }
+   putchar('\n');
+   if( threads[min_thread].min_choices == 0 )
+      puts("Need more bits!");
+
+   /* Average over all center values and all neighbor values. */
+   total = (double)(1 << e.width);
+   for(i = 0; i < e.neighbor_count; i++)
+      total *= (double)(1 << e.width);
+   printf("Average = %.3f\n", all_choices / total);
    return 0;
 }
@@ -0,0 +1,155 @@
+/* Playdate extension for Xor Constellation.
+
+   This exposes SolveMaze() to Lua as a "maze" table:
+
+      maze.reset(all_ones, seed)
+         Clear all cells.  seed must be nonzero.
+
+      maze.set(index, value, flags)
+         Set value and flags for a single cell.
+
+      value, flags = maze.get(index)
+         Get value and flags for a single cell after solving.
+
+      found = maze.solve()
+         Run search, returns true if both solution paths were found.
+
+      length = maze.path_length(which)
+      index = maze.path_cell(which, i)
+         Get solution path, "which" is 0 for solution_path_0 and 1 for
+         solution_path_f.  "i" is 1-based.
+
+   Cell indices are 0-based, see maze.h for how they map to target
+   coordinates.  main.lua falls back to its own implementation if this
+   extension is not loaded.
+*/
+
+#include"pd_api.h"
+#include"maze.h"
+
+static PlaydateAPI *pd = NULL;
+static Maze maze;
+
+/* Check if cell index is within range. */
+static int IsValidIndex(int index)
+{
+   return index >= 0 && index < MAZE_CELLS;
+}
+
+/* Get pointer to selected solution path and its length. */
+static const int *GetPath(int which, int *length)
+{
+   if( which == 0 )
+   {
+      *length = maze.path_0_length;
+      return maze.path_0;
+   }
+   *length = maze.path_f_length;
+   return maze.path_f;
+}
+
+static int LuaReset(lua_State *L)
+{
+   (void)L;
+   InitMaze(&maze, pd->lua->getArgInt(1), (uint32_t)pd->lua->getArgInt(2));
+   return 0;
+}
+
+static int LuaSet(lua_State *L)
+{
+   const int index = pd->lua->getArgInt(1);
+
+   (void)L;
+   if( IsValidIndex(index) )
+   {
+      maze.value[index] = (uint8_t)pd->lua->getArgInt(2);
+      maze.flags[index] = (uint8_t)pd->lua->getArgInt(3);
+   }
+   return 0;
+}
+
+static int LuaGet(lua_State *L)
+{
+   const int index = pd->lua->getArgInt(1);
+
+   (void)L;
+   if( !IsValidIndex(index) )
+   {
+      pd->lua->pushNil();
+      return 1;
+   }
+   pd->lua->pushInt(maze.value[index]);
+   pd->lua->pushInt(maze.flags[index]);
+   return 2;
+}
+
+static int LuaSolve(lua_State *L)
+{
+   (void)L;
+   pd->lua->pushBool(SolveMaze(&maze));
+   return 1;
+}
+
+static int LuaPathLength(lua_State *L)
+{
+   int length;
+
+   (void)L;
+   GetPath(pd->lua->getArgInt(1), &length);
+   pd->lua->pushInt(length);
+   return 1;
+}
+
+static int LuaPathCell(lua_State *L)
+{
+   const int *path;
+   int length, i;
+
+   (void)L;
+   path = GetPath(pd->lua->getArgInt(1), &length);
+   i = pd->lua->getArgInt(2);
+   if( i < 1 || i > length )
+   {
+      pd->lua->pushNil();
+      return 1;
+   }
+   pd->lua->pushInt(path[i - 1]);
+   return 1;
+}
+
+#ifdef _WINDLL
+__declspec(dllexport)
+#endif
+int eventHandler(PlaydateAPI *playdate, PDSystemEvent event, uint32_t arg)
+{
+   static const struct
+   {
+      lua_CFunction function;
+      const char *name;
+   } functions[] =
+   {
+      {LuaReset, "maze.reset"},
+      {LuaSet, "maze.set"},
+      {LuaGet, "maze.get"},
+      {LuaSolve, "maze.solve"},
+      {LuaPathLength, "maze.path_length"},
+      {LuaPathCell, "maze.path_cell"},
+   };
+   const char *error;
+   int i;
+
+   (void)arg;
+   if( event == kEventInitLua )
+   {
+      pd = playdate;
+      for(i = 0; i < (int)(sizeof(functions) / sizeof(functions[0])); i++)
+      {
+         if( !pd->lua->addFunction(functions[i].function,
+                                   functions[i].name, &error) )
+         {
+            pd->system->logToConsole("%s: %s", functions[i].name, error);
+         }
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,170 @@
+/* Native implementation of generate_solutions() from main.lua.
+
+   See maze.h for descriptions.  Comments in main.lua explain why the
+   search works the way it does, which are not repeated here.
+*/
+
+#include"maze.h"
+#include<stdlib.h>
+#include<string.h>
+
+/* Cell index offsets for each direction, in the same order as
+   TARGET_OFFSET in main.lua.                                           */
+static const int kDirection[6] =
+{
+   -2,
+   MAZE_ROWS - 1,
+   MAZE_ROWS + 1,
+   2,
+   -MAZE_ROWS + 1,
+   -MAZE_ROWS - 1
+};
+
+/* Get relative coordinates from cell index. */
+static int GetDX(int index)
+{
+   return index / MAZE_ROWS - MAZE_HALF_COLUMNS;
+}
+
+static int GetDY(int index)
+{
+   return index % MAZE_ROWS - MAZE_HALF_ROWS;
+}
+
+/* Xorshift random number generator. */
+static uint32_t NextRandom(Maze *maze)
+{
+   uint32_t x = maze->random_state;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   return maze->random_state = x;
+}
+
+/* Check if a cell is an immediate neighbor of cursor position. */
+static int IsImmediateNeighbor(int index)
+{
+   const int d = index - MazeIndex(0, 0);
+   int i;
+
+   for(i = 0; i < 6; i++)
+   {
+      if( d == kDirection[i] )
+         return 1;
+   }
+   return 0;
+}
+
+/* Check if a cell is outside of visible area. */
+static int IsOutsideVisibleArea(int index)
+{
+   return abs(GetDX(index)) * MAZE_TARGET_X_SPACING >=
+             MAZE_SCREEN_CENTER_X + MAZE_TARGET_X_SPACING / 2 ||
+          abs(GetDY(index)) * MAZE_TARGET_HALF_Y_SPACING >=
+             MAZE_SCREEN_CENTER_Y + MAZE_TARGET_HALF_Y_SPACING;
+}
+
+/* Modify cell at the end of current path to complete a path. */
+static void CompletePath(Maze *maze, int depth, int value, int index)
+{
+   maze->flags[index] |= MAZE_VISITED;
+
+   if( maze->path_0_length == 0 )
+   {
+      maze->value[index] = (uint8_t)value;
+      memcpy(maze->path_0, maze->path, depth * sizeof(int));
+      maze->path_0_length = depth;
+      return;
+   }
+
+   maze->value[index] = (uint8_t)(maze->all_ones ^ value);
+   memcpy(maze->path_f, maze->path, depth * sizeof(int));
+   maze->path_f_length = depth;
+}
+
+/* Recursively search for solution paths, same as generate_solutions().
+   Returns 1 if both solution paths have been found.                   */
+static int Search(Maze *maze, int depth, int value)
+{
+   const int index = maze->path[depth - 1];
+   int direction[6];
+   int i, j, t;
+
+   maze->node_count++;
+   if( (maze->flags[index] & MAZE_VISITED) != 0 )
+      return 0;
+
+   if( depth > 1 && !IsImmediateNeighbor(index) )
+   {
+      if( (maze->flags[index] & MAZE_NEW) != 0 ||
+          IsOutsideVisibleArea(index) )
+      {
+         CompletePath(maze, depth, value, index);
+         return maze->path_0_length > 0 && maze->path_f_length > 0;
+      }
+   }
+
+   maze->flags[index] |= MAZE_VISITED;
+
+   value ^= maze->value[index];
+   if( value == 0 )
+   {
+      if( maze->path_0_length == 0 )
+      {
+         memcpy(maze->path_0, maze->path, depth * sizeof(int));
+         maze->path_0_length = depth;
+      }
+      return maze->path_f_length > 0;
+   }
+   if( value == maze->all_ones )
+   {
+      if( maze->path_f_length == 0 )
+      {
+         memcpy(maze->path_f, maze->path, depth * sizeof(int));
+         maze->path_f_length = depth;
+      }
+      return maze->path_0_length > 0;
+   }
+
+   if( depth < MAZE_MAX_CHAIN_LENGTH )
+   {
+      /* Shuffle directions.  This is equivalent to picking a random entry
+         from PERMUTATIONS6.                                               */
+      for(i = 0; i < 6; i++)
+         direction[i] = kDirection[i];
+      for(i = 5; i > 0; i--)
+      {
+         j = (int)(NextRandom(maze) % (uint32_t)(i + 1));
+         t = direction[i];
+         direction[i] = direction[j];
+         direction[j] = t;
+      }
+
+      /* Cells that are expanded here are all within |dx| < 4 and
+         |dy| < 5, since anything outside of that would have completed a
+         path above.  Thus all neighbors are still inside the window.    */
+      for(i = 0; i < 6; i++)
+      {
+         maze->path[depth] = index + direction[i];
+         if( Search(maze, depth + 1, value) )
+            return 1;
+      }
+   }
+   return 0;
+}
+
+void InitMaze(Maze *maze, int all_ones, uint32_t seed)
+{
+   memset(maze->value, 0, sizeof(maze->value));
+   memset(maze->flags, 0, sizeof(maze->flags));
+   maze->all_ones = all_ones;
+   maze->random_state = seed;
+   maze->path_0_length = maze->path_f_length = 0;
+}
+
+int SolveMaze(Maze *maze)
+{
+   maze->path[0] = MazeIndex(0, 0);
+   maze->node_count = 0;
+   return Search(maze, 1, 0);
+}
@@ -0,0 +1,101 @@
+/* Native implementation of generate_solutions() from main.lua.
+
+   generate_solutions() stops expanding the moment it reaches outside of
+   the visible area, so all targets it could ever touch fit in a small
+   window around the cursor.  Lua copies the targets in that window into
+   a Maze, SolveMaze() runs the same randomized depth-first search over
+   flat arrays, and Lua copies the modified values and solution paths
+   back.
+
+   Cells are addressed in units of (TARGET_X_SPACING, TARGET_Y_SPACING/2)
+   relative to cursor position, so that the hexagonal grid maps to a
+   rectangular one where every other slot is unused:
+
+      dx = (x - cursor_x) / TARGET_X_SPACING        [-4, 4]
+      dy = (y - cursor_y) / (TARGET_Y_SPACING / 2)  [-6, 6]
+
+   Valid cells have (dx + dy) even.  Cell index is
+   (dx + MAZE_HALF_COLUMNS) * MAZE_ROWS + (dy + MAZE_HALF_ROWS).
+
+   This file does not depend on the Playdate API, so that it can also be
+   built for desktop.
+*/
+
+#ifndef MAZE_H_
+#define MAZE_H_
+
+#include<stdint.h>
+
+/* These must match constants in main.lua. */
+#define MAZE_TARGET_X_SPACING      70
+#define MAZE_TARGET_HALF_Y_SPACING 32
+#define MAZE_SCREEN_CENTER_X       200
+#define MAZE_SCREEN_CENTER_Y       120
+#define MAZE_MAX_CHAIN_LENGTH      24
+
+/* Window size.  Search stops at the first cell where
+   |x - cursor_x| >= SCREEN_CENTER_X + TARGET_X_SPACING / 2, which is
+   |dx| >= 4, or where |y - cursor_y| >= SCREEN_CENTER_Y +
+   TARGET_Y_SPACING / 2, which is |dy| >= 5.  Cells with |dy| == 4 can
+   still move vertically by 2 half rows, hence 6 half rows on each side. */
+#define MAZE_HALF_COLUMNS          4
+#define MAZE_HALF_ROWS             6
+#define MAZE_COLUMNS               (MAZE_HALF_COLUMNS * 2 + 1)
+#define MAZE_ROWS                  (MAZE_HALF_ROWS * 2 + 1)
+#define MAZE_CELLS                 (MAZE_COLUMNS * MAZE_ROWS)
+
+/* Cell flags. */
+
+/* Target was created in the current frame (birth_frame == global_frames),
+   so its value can be replaced to complete a chain.                      */
+#define MAZE_NEW                   1
+
+/* Target has been visited in the current frame
+   (maze_generation == global_frames).                                    */
+#define MAZE_VISITED               2
+
+typedef struct
+{
+   /* Target values and flags, indexed by cell index. */
+   uint8_t value[MAZE_CELLS];
+   uint8_t flags[MAZE_CELLS];
+
+   /* 0xf for 4bit modes, 0xff for 8bit modes. */
+   int all_ones;
+
+   /* Random number generator state. */
+   uint32_t random_state;
+
+   /* Solution paths as lists of cell indices, starting at cursor.  Lengths
+      are zero if the corresponding solution has not been found.          */
+   int path_0[MAZE_MAX_CHAIN_LENGTH];
+   int path_0_length;
+   int path_f[MAZE_MAX_CHAIN_LENGTH];
+   int path_f_length;
+
+   /* Current search path. */
+   int path[MAZE_MAX_CHAIN_LENGTH];
+
+   /* Number of cells visited by the last SolveMaze() call, including
+      cells that were rejected because they have already been visited.
+      This is only used for benchmarking.                               */
+   int node_count;
+} Maze;
+
+/* Clear all cells and solution paths.  Seed must be nonzero. */
+void InitMaze(Maze *maze, int all_ones, uint32_t seed);
+
+/* Convert relative coordinates to cell index. */
+static inline int MazeIndex(int dx, int dy)
+{
+   return (dx + MAZE_HALF_COLUMNS) * MAZE_ROWS + (dy + MAZE_HALF_ROWS);
+}
+
+/* Generate solution paths starting from cursor cell.  Returns 1 if both
+   solution paths have been found.
+
+   Values of cells at the end of manufactured paths are updated, and all
+   cells touched by the search are marked with MAZE_VISITED.              */
+int SolveMaze(Maze *maze);
+
+#endif
@@ -1,54 +1,3 @@
-RATE_MULTIPLIER =
-{
-	0.5,	-- C3
-	0.529731547179648,	-- C#3
-	0.561231024154687,	-- D3
-	0.594603557501361,	-- D#3
-	0.629960524947437,	-- E3
-	0.667419927085017,	-- F3
-	0.707106781186548,	-- F#3
-	0.749153538438341,	-- G3
-	0.7937005259841,	-- G#3
-	0.840896415253715,	-- A3
-	0.890898718140339,	-- A#3
-	0.943874312681694,	-- B3
-	1,	-- C4
-	1.0594630943593,	-- C#4
-	1.12246204830937,	-- D4
-	1.18920711500272,	-- D#4
-	1.25992104989487,	-- E4
-	1.33483985417003,	-- F4
-	1.4142135623731,	-- F#4
-	1.49830707687668,	-- G4
-	1.5874010519682,	-- G#4
-	1.68179283050743,	-- A4
-	1.78179743628068,	-- A#4
-	1.88774862536339,	-- B4
-	2,	-- C5
-	2.11892618871859,	-- C#5
-	2.24492409661875,	-- D5
-	2.37841423000544,	-- D#5
-	2.51984209978975,	-- E5
-	2.66967970834007,	-- F5
-	2.82842712474619,	-- F#5
-	2.99661415375336,	-- G5
-	3.1748021039364,	-- G#5
-	3.36358566101486,	-- A5
-	3.56359487256136,	-- A#5
-	3.77549725072677,	-- B5
-	4,	-- C6
-	4.23785237743718,	-- C#6
-	4.48984819323749,	-- D6
-	4.75682846001088,	-- D#6
-	5.03968419957949,	-- E6
-	5.33935941668014,	-- F6
-	5.65685424949238,	-- F#6
-	5.99322830750673,	-- G6
-	6.3496042078728,	-- G#6
-	6.72717132202972,	-- A6
-	7.12718974512272,	-- A#6
-	7.55099450145355,	-- B6
-}
 -- Notes from "Seiza ni Naretara", specified as number of semitones away
 -- from C3.  This was created by transcribing guitar chords from some
 -- random video.
@@ -3534,3 +3483,452 @@ BIT_TABLE_SIZE =
 	237,
 	277
 }
+SPRITE_ATLAS =
+{
+	[1] = {411, 0, 68, 52, 14, 6},
+	[2] = {70, 106, 64, 48, 16, 8},
+	[3] = {47, 314, 55, 31, 17, 17},
+	[4] = {415, 314, 51, 30, 25, 17},
+	[5] = {313, 280, 48, 33, 25, 15},
+	[6] = {361, 280, 48, 33, 25, 15},
+	[7] = {409, 280, 48, 33, 25, 15},
+	[8] = {457, 280, 48, 33, 25, 15},
+	[9] = {102, 314, 47, 31, 23, 17},
+	[10] = {149, 314, 47, 31, 23, 17},
+	[11] = {596, 242, 41, 35, 29, 17},
+	[12] = {597, 314, 47, 29, 23, 16},
+	[13] = {61, 242, 41, 37, 27, 12},
+	[14] = {511, 201, 44, 38, 27, 11},
+	[15] = {102, 242, 42, 37, 26, 14},
+	[16] = {637, 242, 26, 35, 38, 13},
+	[17] = {245, 201, 40, 39, 30, 13},
+	[18] = {270, 346, 55, 27, 20, 20},
+	[19] = {499, 346, 54, 25, 20, 21},
+	[20] = {644, 314, 38, 29, 28, 18},
+	[21] = {570, 346, 56, 24, 20, 20},
+	[22] = {531, 280, 41, 32, 28, 18},
+	[23] = {123, 346, 46, 28, 26, 20},
+	[24] = {144, 242, 41, 37, 27, 13},
+	[25] = {285, 201, 43, 39, 26, 12},
+	[26] = {663, 242, 32, 35, 32, 14},
+	[27] = {695, 242, 32, 35, 32, 14},
+	[28] = {196, 314, 32, 31, 29, 14},
+	[29] = {228, 314, 32, 31, 29, 14},
+	[30] = {555, 201, 37, 38, 33, 13},
+	[31] = {505, 280, 26, 33, 35, 13},
+	[32] = {294, 242, 26, 36, 35, 14},
+	[33] = {479, 0, 74, 52, 9, 3},
+	[34] = {228, 55, 71, 50, 11, 4},
+	[35] = {134, 106, 69, 48, 12, 5},
+	[36] = {140, 155, 65, 45, 14, 8},
+	[37] = {328, 201, 59, 39, 16, 13},
+	[38] = {466, 314, 54, 30, 20, 21},
+	[39] = {50, 375, 52, 19, 21, 27},
+	[40] = {102, 375, 50, 18, 22, 27},
+	[41] = {192, 375, 48, 17, 23, 28},
+	[42] = {277, 375, 47, 16, 23, 28},
+	[43] = {345, 375, 45, 14, 24, 29},
+	[44] = {437, 375, 42, 13, 26, 30},
+	[45] = {479, 375, 40, 11, 27, 31},
+	[46] = {519, 375, 37, 8, 29, 33},
+	[47] = {585, 375, 3, 3, 62, 38},
+	[48] = {619, 375, 1, 1, 63, 39},
+	[49] = {459, 55, 81, 49, 7, 9},
+	[50] = {431, 106, 78, 47, 9, 10},
+	[51] = {205, 155, 76, 45, 10, 11},
+	[52] = {349, 155, 73, 44, 11, 11},
+	[53] = {554, 155, 52, 42, 22, 12},
+	[54] = {70, 201, 44, 40, 29, 14},
+	[55] = {320, 242, 38, 36, 34, 15},
+	[56] = {520, 314, 25, 30, 47, 19},
+	[57] = {169, 346, 23, 28, 48, 20},
+	[58] = {325, 346, 20, 27, 50, 20},
+	[59] = {553, 346, 17, 25, 52, 22},
+	[60] = {588, 375, 6, 3, 61, 24},
+	[61] = {0, 0, 0, 0, 0, 0},
+	[62] = {0, 0, 0, 0, 0, 0},
+	[63] = {0, 0, 0, 0, 0, 0},
+	[64] = {0, 0, 0, 0, 0, 0},
+	[65] = {0, 0, 83, 55, 3, 3},
+	[66] = {252, 0, 80, 53, 5, 4},
+	[67] = {0, 55, 77, 51, 7, 5},
+	[68] = {203, 106, 74, 48, 8, 7},
+	[69] = {606, 155, 70, 41, 11, 14},
+	[70] = {387, 201, 62, 39, 18, 15},
+	[71] = {185, 242, 50, 37, 26, 16},
+	[72] = {0, 280, 49, 34, 26, 18},
+	[73] = {260, 314, 47, 31, 27, 20},
+	[74] = {639, 346, 42, 23, 29, 22},
+	[75] = {0, 375, 41, 21, 29, 23},
+	[76] = {240, 375, 37, 17, 32, 26},
+	[77] = {556, 375, 9, 7, 59, 36},
+	[78] = {573, 375, 7, 5, 60, 37},
+	[79] = {594, 375, 5, 3, 61, 38},
+	[80] = {620, 375, 3, 1, 62, 39},
+	[81] = {299, 55, 81, 50, 3, 11},
+	[82] = {277, 106, 78, 48, 4, 12},
+	[83] = {0, 155, 75, 46, 6, 13},
+	[84] = {281, 155, 68, 45, 12, 13},
+	[85] = {592, 201, 62, 38, 13, 14},
+	[86] = {358, 242, 58, 36, 16, 15},
+	[87] = {307, 314, 38, 31, 35, 15},
+	[88] = {682, 314, 36, 29, 36, 16},
+	[89] = {0, 346, 34, 29, 37, 16},
+	[90] = {345, 346, 33, 27, 37, 17},
+	[91] = {565, 375, 8, 6, 38, 17},
+	[92] = {599, 375, 5, 3, 40, 19},
+	[93] = {604, 375, 4, 3, 40, 19},
+	[94] = {0, 0, 0, 0, 0, 0},
+	[95] = {0, 0, 0, 0, 0, 0},
+	[96] = {0, 0, 0, 0, 0, 0},
+	[97] = {553, 0, 83, 52, 7, 9},
+	[98] = {380, 55, 79, 50, 9, 10},
+	[99] = {540, 55, 77, 49, 10, 10},
+	[100] = {509, 106, 74, 47, 11, 11},
+	[101] = {0, 201, 70, 41, 13, 12},
+	[102] = {114, 201, 68, 40, 14, 12},
+	[103] = {654, 201, 65, 38, 15, 13},
+	[104] = {416, 242, 61, 36, 17, 14},
+	[105] = {49, 280, 59, 34, 18, 14},
+	[106] = {572, 280, 56, 32, 19, 15},
+	[107] = {545, 314, 52, 30, 21, 16},
+	[108] = {192, 346, 50, 28, 22, 17},
+	[109] = {152, 375, 35, 18, 23, 18},
+	[110] = {390, 375, 32, 14, 25, 21},
+	[111] = {580, 375, 5, 4, 26, 30},
+	[112] = {616, 375, 3, 2, 27, 31},
+	[113] = {332, 0, 79, 53, 10, 4},
+	[114] = {77, 55, 77, 51, 11, 5},
+	[115] = {617, 55, 73, 49, 13, 6},
+	[116] = {583, 106, 71, 47, 14, 7},
+	[117] = {486, 155, 68, 43, 15, 11},
+	[118] = {477, 242, 63, 36, 16, 13},
+	[119] = {108, 280, 60, 34, 17, 14},
+	[120] = {628, 280, 58, 32, 18, 15},
+	[121] = {34, 346, 55, 29, 20, 17},
+	[122] = {378, 346, 51, 27, 22, 18},
+	[123] = {429, 346, 48, 26, 24, 19},
+	[124] = {626, 346, 13, 24, 57, 20},
+	[125] = {709, 346, 11, 22, 58, 21},
+	[126] = {41, 375, 9, 20, 59, 22},
+	[127] = {187, 375, 5, 18, 61, 23},
+	[128] = {324, 375, 3, 16, 62, 24},
+	[129] = {154, 55, 74, 51, 13, 6},
+	[130] = {0, 106, 70, 49, 15, 7},
+	[131] = {654, 106, 68, 47, 16, 8},
+	[132] = {75, 155, 65, 46, 18, 8},
+	[133] = {182, 201, 63, 40, 19, 13},
+	[134] = {449, 201, 62, 39, 19, 14},
+	[135] = {235, 242, 59, 37, 20, 15},
+	[136] = {540, 242, 56, 36, 22, 15},
+	[137] = {168, 280, 53, 34, 24, 16},
+	[138] = {221, 280, 42, 34, 34, 16},
+	[139] = {686, 280, 39, 32, 35, 17},
+	[140] = {345, 314, 36, 31, 37, 17},
+	[141] = {89, 346, 34, 29, 38, 18},
+	[142] = {242, 346, 28, 28, 43, 18},
+	[143] = {327, 375, 18, 15, 52, 19},
+	[144] = {422, 375, 15, 14, 53, 19},
+	[145] = {83, 0, 86, 55, 7, 4},
+	[146] = {169, 0, 83, 54, 8, 5},
+	[147] = {636, 0, 79, 52, 10, 6},
+	[148] = {355, 106, 76, 48, 12, 9},
+	[149] = {422, 155, 64, 44, 13, 12},
+	[150] = {0, 242, 61, 38, 15, 17},
+	[151] = {263, 280, 50, 34, 16, 20},
+	[152] = {0, 314, 47, 32, 18, 21},
+	[153] = {381, 314, 34, 31, 20, 21},
+	[154] = {477, 346, 22, 26, 22, 21},
+	[155] = {681, 346, 18, 23, 24, 22},
+	[156] = {699, 346, 10, 23, 29, 22},
+	[157] = {608, 375, 5, 3, 30, 23},
+	[158] = {613, 375, 3, 3, 31, 23},
+	[159] = {623, 375, 3, 1, 31, 24},
+	[160] = {626, 375, 1, 1, 32, 24},
+}
+STAR_CELLS =
+{
+	{
+		0, 3814, 2217, 2989, 2111, 1002, 3331, 3690, 103, 2460, 648, 463, 143, 2654, 1886, 3726,
+		206, 3322, 1997, 2741, 547, 1359, 775, 746, 359, 1879, 2378, 56, 3799, 3906, 1783, 1851,
+		412, 657, 850, 1741, 1039, 4066, 3299, 3791, 1214, 2702, 2100, 3035, 2133, 4057, 390, 897,
+		719, 1321, 962, 3484, 3480, 1109, 3336, 2719, 3511, 1617, 2593, 1996, 3562, 2804, 3703, 3303,
+		2714, 1124, 1645, 1791, 3254, 1334, 1182, 1140, 3148, 3719, 3505, 372, 3492, 1886, 2049, 2838,
+		2761, 532, 1488, 993, 901, 601, 2735, 848, 2109, 2551, 298, 2596, 409, 332, 3340, 2434,
+		3021, 1001, 575, 637, 2852, 3765, 889, 1350, 3679, 2889, 548, 2648, 2673, 1069, 1357, 1461,
+		3132, 1098, 1561, 347, 1583, 2010, 1423, 2975, 3497, 1504, 340, 113, 1182, 793, 3485, 3631,
+		2440, 1688, 2241, 287, 3875, 211, 3328, 3733, 3537, 124, 2669, 1716, 3272, 1640, 137, 2072,
+		3813, 1003, 3351, 3783, 619, 1035, 494, 152, 852, 2270, 3773, 1888, 2313, 2458, 2514, 2948,
+		262, 3551, 1057, 521, 1210, 492, 2632, 2059, 2175, 1308, 1203, 3394, 1700, 3445, 1217, 3195,
+		1263, 919, 487, 1501, 1615, 283, 1479, 20, 1598, 4068, 665, 3514, 1898, 329, 3185, 3977,
+		2462, 3703, 659, 295, 3443, 3263, 1527, 3451, 2543, 1151, 3822, 3300, 2680, 583, 3389, 880,
+		2254, 1559, 1782, 3842, 3596, 1863, 543, 952, 1646, 2175, 1341, 3460, 3028, 2047, 385, 2861,
+		1635, 1499, 902, 2222, 1350, 2990, 151, 3963, 3347, 165, 3202, 99, 4073, 2507, 2618, 41,
+		2279, 1028, 3104, 3216, 2891, 2831, 1163, 1046, 3664, 170, 641, 2175, 214, 3410, 2612, 2160,
+		1164, 1231, 569, 3028, 3008, 2825, 528, 166, 1571, 2554, 724, 1014, 3596, 610, 2794, 1951,
+		3000, 3417, 1658, 1205, 597, 19, 3218, 111, 2997, 300, 1161, 3055, 593, 1511, 2787, 2750,
+		2162, 1603, 3940, 1197, 2316, 3064, 870, 170, 1779, 2745, 3814, 3709, 766, 1037, 2777, 3464,
+		900, 3582, 3683, 981, 431, 1600, 1568, 800, 764, 251, 75, 231, 2508, 1856, 3136, 1075,
+		31, 855, 12, 3493, 2248, 3557, 2766, 1103, 170, 3755, 2063, 3334, 1236, 2116, 1503, 3252,
+		1869, 2952, 1279, 10, 4045, 3477, 2678, 3860, 354, 486, 3682, 2300, 1930, 546, 1078, 1969,
+		3099, 537, 2875, 137, 3790, 2745, 3644, 2653, 983, 3724, 2210, 2177, 2625, 2373, 3557, 3085,
+		860, 3590, 1496, 932, 3742, 2768, 1963, 1033, 4032, 2084, 3085, 301, 2176, 1343, 1272, 1793,
+		1363, 684, 987, 2831, 1339, 640, 1865, 3139, 1844, 2188, 2728, 2270, 3498, 490, 540, 3405,
+		3627, 1449, 1585, 257, 3222, 113, 2560, 1524, 3261, 2013, 1871, 751, 2777, 2689, 219, 1456,
+		945, 2658, 1581, 1543, 4088, 2978, 1423, 3885, 2357, 1198, 3052, 2950, 2745, 693, 265, 812,
+		1956, 1478, 4070, 3732, 1117, 1763, 1515, 1649, 2945, 1941, 63, 3593, 3696, 3977, 782, 460,
+		569, 942, 541, 2987, 202, 1502, 787, 3220, 338, 44, 1883, 3398, 1499, 566, 643, 1383,
+		1054, 905, 82, 3788, 736, 2617, 770, 3093, 2065, 3227, 266, 1986, 903, 691, 3618, 912,
+		3011, 3334, 1288, 2949, 1610, 1691, 1352, 1608, 3573, 2726, 355, 3397, 1227, 611, 3610, 2369,
+		3834, 1994, 846, 3247, 2929, 3675, 3162, 3137, 3560, 1121, 3808, 810, 3445, 3086, 2058, 2773,
+		2336, 118, 1155, 1162, 1250, 774, 1461, 2397, 1921, 718, 3545, 1794, 550, 1165, 2498, 1947,
+		3150, 2240, 3098, 254, 1838, 2965, 1561, 261, 3097, 844, 81, 2169, 3741, 1064, 2144, 2440,
+		1896, 1579, 648, 14, 3690, 3376, 2908, 1226, 1195, 1504, 3475, 4078, 3763, 4087, 1604, 381,
+		1938, 1097, 1740, 777, 1766, 1258, 504, 2251, 1187, 1026, 1620, 1332, 1016, 118, 2428, 1522,
+		4003, 1320, 680, 95, 3414, 2953, 623, 2686, 2898, 3223, 1086, 1024, 476, 1207, 4001, 2697,
+		3027, 4062, 3875, 2000, 2080, 519, 821, 396, 1881, 417, 4016, 434, 2920, 3882, 680, 2603,
+		2545, 2949, 2610, 2051, 1370, 3460, 2745, 2901, 2025, 1170, 963, 1555, 2730, 107, 892, 1689,
+		1239, 740, 2163, 1042, 326, 1296, 3059, 1106, 3701, 3969, 2629, 1402, 2654, 2889, 2711, 3775,
+		1195, 2699, 1718, 2285, 1032, 591, 2087, 788, 516, 229, 3019, 832, 3506, 2140, 3694, 140,
+		2595, 329, 3422, 143, 3812, 3177, 1281, 800, 3300, 4090, 137, 3612, 2485, 1498, 530, 509,
+		2073, 476, 1832, 141, 485, 1381, 3323, 3614, 2830, 356, 2859, 57, 941, 4046, 1125, 2257,
+		3929, 1909, 3540, 2448, 3100, 2709, 61, 3472, 1841, 2354, 1092, 1786, 3816, 3939, 972, 704,
+		2074, 2396, 1431, 786, 2875, 1684, 1772, 1016, 2861, 2666, 452, 3560, 2337, 1402, 2602, 2145,
+		712, 2613, 3221, 2552, 3678, 2441, 1994, 1293, 1968, 301, 2635, 3139, 3008, 3526, 1844, 2696,
+		2432, 248, 474, 1866, 2590, 2999, 2195, 650, 2741, 1708, 3407, 2631, 8, 531, 10, 1595,
+		159, 1803, 3644, 2231, 2762, 1382, 1737, 3859, 717, 3412, 504, 1901, 3437, 2318, 2708, 3869,
+		3019, 243, 1855, 809, 1620, 2030, 770, 2933, 2752, 960, 495, 2712, 3963, 1911, 1423, 1835,
+		3752, 1480, 3138, 3322, 3312, 1454, 3937, 1897, 2327, 578, 1850, 3653, 3896, 1444, 2014, 3309,
+		872, 1741, 3348, 2102, 342, 2472, 3338, 3385, 2046, 1957, 1755, 917, 2008, 399, 3738, 50,
+		2553, 3504, 1955, 1589, 3656, 2371, 2231, 1544, 429, 385, 261, 2949, 3823, 3299, 2485, 1800,
+		1176, 1350, 3170, 1968, 3578, 683, 1564, 433, 872, 3367, 2921, 405, 1353, 689, 3996, 3876,
+		2457, 2571, 1245, 339, 2435, 527, 3557, 2718, 819, 2054, 1274, 2895, 3645, 2652, 226, 1279,
+		1409, 3179, 2504, 3256, 7, 3903, 1043, 792, 1876, 2770, 3875, 748, 3924, 3658, 1935, 1159,
+		3077, 1693, 1275, 2981, 3636, 1378, 2160, 1673, 3315, 1257, 1178, 888, 448, 444, 2844, 1080,
+		2870, 2825, 2922, 678, 1220, 689, 993, 3433, 2913, 2753, 1589, 2070, 68, 3881, 238, 1870,
+		1846, 1659, 3966, 161, 2084, 3499, 1251, 1341, 3555, 145, 2740, 3785, 3821, 3767, 2983, 1409,
+		4020, 706, 3047, 1902, 864, 259, 3837, 3343, 3329, 1461, 4045, 2274, 686, 3541, 1012, 1550,
+		1416, 3833, 3562, 4042, 288, 4071, 3949, 1845, 1977, 757, 1965, 302, 4088, 1787, 2704, 3365,
+		727, 2567, 849, 2129, 3693, 3964, 946, 1704, 3874, 773, 1768, 3519, 1914, 1788, 2846, 411,
+		2849, 571, 2047, 3832, 3486, 487, 675, 3927, 1113, 1825, 4086, 1999, 3843, 2621, 3016, 238,
+		1213, 2291, 647, 1885, 750, 1754, 2704, 643, 2602, 557, 3525, 857, 478, 2941, 1529, 443,
+		3577, 2339, 3466, 1232, 3715, 3809, 1714, 3151, 2773, 2458, 941, 2686, 2710, 2158, 3603, 204,
+	},
+	{
+		913, 123, 3839, 2616, 1853, 3391, 666, 158, 3162, 3100, 2799, 1820, 988, 1173, 2054, 2892,
+		2940, 295, 2640, 3159, 1971, 1147, 425, 3622, 3623, 3578, 2578, 4015, 413, 1873, 3130, 3040,
+		1829, 2206, 2806, 661, 1978, 774, 79, 3528, 1398, 3809, 648, 2291, 2166, 1213, 2287, 2489,
+		2779, 2835, 144, 236, 3724, 94, 2524, 1457, 553, 2227, 2959, 2283, 2834, 3175, 1421, 3520,
+		1501, 1044, 3318, 1669, 1123, 2231, 3898, 95, 1825, 2761, 769, 2084, 1702, 3136, 45, 188,
+		530, 2822, 118, 633, 1317, 1186, 199, 3982, 1378, 2567, 4040, 1211, 2610, 626, 3906, 2097,
+		1466, 2509, 425, 291, 3855, 3355, 1660, 741, 1038, 2937, 3097, 670, 2078, 277, 2199, 820,
+		746, 2814, 1437, 404, 88, 2386, 3619, 319, 3151, 974, 2538, 430, 974, 1218, 516, 3632,
+		1126, 3538, 3338, 3213, 4022, 3621, 1232, 2946, 2000, 2033, 3507, 34, 2029, 2219, 2686, 342,
+		323, 2457, 747, 4091, 3900, 3160, 677, 2479, 2187, 988, 376, 373, 339, 3002, 1658, 1532,
+		870, 2538, 1287, 1564, 3492, 1179, 3832, 480, 1537, 3940, 2749, 1385, 121, 2920, 3415, 1581,
+		1126, 1846, 2357, 2094, 880, 1401, 3993, 2720, 2914, 2361, 1466, 516, 2064, 1229, 2121, 616,
+		454, 1798, 3020, 3207, 448, 2612, 3527, 3419, 3721, 2497, 662, 3059, 3499, 1549, 3498, 3859,
+		754, 3219, 1166, 3064, 3134, 1978, 1246, 81, 1838, 3061, 2031, 3115, 1629, 399, 1291, 319,
+		1520, 2134, 3833, 227, 2410, 650, 3563, 1661, 2414, 2206, 2315, 2250, 852, 2995, 1009, 3818,
+		3527, 782, 1287, 664, 1135, 530, 1742, 1119, 4088, 2889, 1215, 2226, 676, 3624, 1920, 1969,
+		3288, 3953, 767, 196, 2539, 1362, 1557, 2804, 175, 3798, 2289, 3335, 1578, 4011, 608, 798,
+		2153, 2283, 1288, 2667, 3617, 3076, 679, 3026, 2117, 1971, 3551, 656, 3554, 1161, 1072, 2420,
+		1758, 20, 1386, 2735, 3608, 3, 2914, 1210, 1090, 1330, 2156, 2463, 3158, 2901, 1221, 2794,
+		435, 1704, 2002, 2883, 3275, 3963, 154, 1891, 2450, 11, 2443, 1509, 159, 2521, 1794, 1962,
+		3095, 3346, 3000, 4085, 1168, 3316, 3159, 1605, 1602, 761, 3175, 1412, 3329, 298, 669, 3506,
+		1838, 1771, 934, 2342, 3630, 559, 722, 3502, 380, 3112, 949, 3913, 2958, 4018, 1675, 3581,
+		2108, 2341, 996, 1022, 797, 904, 9, 3424, 3263, 1861, 846, 403, 3231, 2705, 440, 3045,
+		2649, 1235, 3471, 2984, 2737, 3531, 3329, 3662, 40, 3966, 3174, 2136, 1713, 3886, 2684, 2024,
+		2678, 3549, 2091, 964, 1759, 3733, 2441, 2716, 1310, 1825, 2647, 850, 2014, 3944, 1170, 2916,
+		3321, 4055, 3721, 426, 516, 257, 1979, 1801, 2406, 2958, 3495, 3869, 1635, 2380, 2820, 1993,
+		3150, 1650, 2056, 3978, 428, 1784, 1075, 1091, 2313, 56, 733, 1160, 3866, 502, 1846, 71,
+		3535, 1685, 1561, 3012, 2049, 3536, 2133, 2555, 1028, 1118, 1982, 2133, 361, 3417, 2189, 2828,
+		1518, 2313, 3716, 425, 3997, 2257, 1973, 3535, 617, 822, 1359, 2346, 1061, 2699, 2024, 2772,
+		3842, 2492, 917, 3875, 3545, 4028, 2326, 1172, 1454, 2507, 4015, 1177, 3872, 3979, 731, 2439,
+		985, 512, 2411, 263, 277, 3026, 1501, 966, 2561, 1288, 134, 3065, 3004, 1285, 127, 494,
+		2767, 1500, 3289, 3857, 2543, 7, 2012, 1278, 2314, 1584, 78, 2661, 2435, 3061, 2039, 1829,
+		963, 3622, 2523, 1285, 1171, 836, 1435, 1999, 3072, 4045, 766, 695, 2827, 250, 970, 4023,
+		4079, 2464, 2715, 1194, 3101, 12, 3172, 1231, 3910, 3430, 2784, 647, 1841, 32, 3197, 3850,
+		2354, 3366, 1716, 3249, 1856, 3383, 3067, 2570, 182, 2463, 1385, 222, 2360, 1797, 1028, 4070,
+		2169, 2853, 2322, 2759, 125, 3929, 1565, 1958, 3061, 3184, 941, 1994, 2830, 2638, 3158, 1654,
+		956, 682, 633, 1567, 1376, 1897, 2420, 2644, 1393, 2952, 137, 3621, 1227, 3605, 3775, 980,
+		3412, 1844, 3397, 2171, 3085, 2676, 205, 3627, 664, 708, 3033, 3785, 3310, 4024, 2996, 2956,
+		762, 4094, 1362, 3304, 513, 2483, 2687, 3665, 2341, 711, 2442, 989, 1893, 2702, 598, 165,
+		4084, 909, 2287, 558, 2642, 3551, 3762, 1177, 2940, 1123, 3454, 4001, 3746, 2891, 2135, 3164,
+		507, 3944, 3708, 748, 550, 611, 1926, 1226, 2958, 976, 1452, 572, 609, 3210, 1962, 1944,
+		3759, 1681, 827, 355, 4095, 484, 1504, 695, 960, 3517, 592, 3184, 132, 3489, 970, 2071,
+		3540, 200, 3008, 2320, 2502, 3530, 1236, 2756, 2764, 4015, 2039, 20, 2487, 839, 3318, 3259,
+		3209, 3184, 921, 975, 89, 236, 3200, 2266, 2615, 2245, 1694, 1752, 1766, 3510, 28, 775,
+		3325, 1923, 25, 795, 670, 3141, 3314, 2251, 654, 43, 2720, 1031, 3819, 2730, 3125, 1365,
+		1223, 350, 2285, 540, 961, 1402, 769, 3451, 3527, 1186, 584, 2429, 1363, 3790, 652, 142,
+		3223, 149, 108, 2588, 3827, 3725, 711, 2616, 2976, 718, 2622, 1722, 2656, 809, 437, 2011,
+		2631, 2329, 1594, 3556, 3805, 2001, 810, 3541, 3421, 2798, 1638, 2744, 747, 3848, 144, 3381,
+		1490, 3859, 484, 709, 3477, 2715, 3819, 2832, 1713, 401, 4067, 419, 2295, 849, 3363, 2000,
+		299, 2508, 2170, 1386, 2336, 2604, 1207, 141, 2515, 3774, 3843, 1477, 2184, 67, 1444, 1629,
+		3119, 1777, 2601, 2392, 3152, 3662, 1876, 791, 3559, 1565, 3942, 3598, 499, 3831, 2546, 1720,
+		3504, 181, 2255, 3310, 2250, 3381, 1541, 3026, 3098, 616, 340, 1151, 3674, 717, 3272, 3794,
+		3559, 1365, 539, 1042, 1175, 84, 3998, 1637, 198, 1862, 1042, 2629, 3597, 1955, 2854, 548,
+		203, 3965, 1846, 3556, 3229, 105, 2467, 3670, 2762, 2680, 372, 2906, 27, 457, 114, 268,
+		3241, 1683, 1713, 365, 2160, 704, 1907, 1403, 492, 3909, 1905, 4036, 4092, 2746, 3564, 2048,
+		4055, 1839, 2786, 241, 271, 879, 3702, 1767, 1299, 2828, 3889, 2323, 2120, 761, 1323, 4020,
+		1317, 260, 1581, 2469, 2360, 140, 2418, 1489, 104, 1084, 174, 2621, 2248, 1362, 3207, 1245,
+		2062, 3164, 2933, 1607, 1268, 2706, 762, 2604, 4002, 76, 2135, 3684, 61, 3373, 2974, 2196,
+		2381, 2554, 1624, 2724, 2323, 3836, 895, 257, 2039, 3497, 2023, 3205, 1464, 1804, 1958, 3070,
+		933, 3991, 668, 3580, 3730, 590, 3763, 3000, 2938, 3542, 1042, 3527, 1418, 1053, 1516, 1989,
+		1709, 1438, 1870, 1478, 741, 657, 1015, 1917, 3478, 950, 1156, 2387, 3899, 3199, 2738, 1825,
+		2392, 1185, 3372, 423, 1037, 1727, 2983, 3838, 742, 1941, 2419, 707, 3206, 2670, 310, 3267,
+		3570, 3751, 1392, 3785, 3328, 2692, 3890, 2569, 787, 760, 1137, 1305, 964, 3547, 12, 1935,
+		159, 3585, 989, 916, 2318, 1823, 3201, 2067, 1491, 1433, 1601, 542, 988, 2562, 3577, 2526,
+	},
+	{
+		4066, 1465, 2008, 683, 3259, 3043, 1031, 328, 1853, 3220, 1449, 648, 2631, 2467, 413, 3100,
+		2149, 3126, 1540, 395, 3721, 2343, 2940, 2189, 1335, 1655, 1666, 2128, 1719, 551, 237, 1959,
+		1588, 2595, 646, 3925, 3822, 3283, 1337, 1958, 2025, 625, 1763, 1877, 3951, 707, 1106, 1002,
+		2849, 2881, 666, 2121, 833, 193, 2497, 4028, 1038, 1952, 3129, 2773, 1857, 1761, 1285, 3565,
+		1478, 686, 340, 1972, 1325, 2392, 3802, 1236, 1517, 243, 2724, 1317, 2326, 3225, 2064, 3870,
+		2660, 1873, 744, 828, 3663, 3594, 193, 4020, 410, 3540, 739, 1161, 2409, 1833, 1690, 172,
+		1772, 2366, 1024, 2129, 1754, 2771, 1308, 2979, 2190, 1129, 906, 2824, 3217, 2067, 191, 2234,
+		4084, 1043, 2589, 1560, 3232, 644, 2966, 2915, 854, 3603, 172, 3433, 430, 3364, 18, 1396,
+		1538, 1122, 4074, 3884, 2024, 1226, 475, 638, 1744, 2871, 3307, 2497, 1811, 193, 3903, 461,
+		1850, 2304, 3366, 3083, 2766, 3570, 3613, 530, 623, 2842, 1601, 2695, 65, 1120, 1547, 2045,
+		2587, 3157, 2188, 1298, 3608, 3270, 3293, 2869, 2994, 644, 2501, 1777, 795, 3568, 2603, 2763,
+		815, 3043, 3224, 2442, 3435, 2905, 1768, 4047, 696, 274, 1310, 2617, 3562, 1169, 3580, 2979,
+		318, 1667, 838, 3430, 1718, 3412, 3178, 1170, 665, 3270, 1861, 1344, 1136, 1813, 3132, 1943,
+		2817, 1873, 2575, 1144, 2190, 485, 1688, 1902, 1741, 1871, 812, 1241, 2570, 683, 2489, 4093,
+		1180, 431, 2827, 1762, 3309, 507, 2486, 78, 1239, 3709, 946, 2580, 2409, 2857, 3631, 2586,
+		2957, 875, 1370, 2411, 3582, 1211, 1013, 808, 1367, 2780, 1444, 3426, 3429, 2208, 1689, 689,
+		951, 3491, 2564, 2744, 213, 3831, 1431, 1126, 3654, 1434, 105, 3379, 3782, 2474, 983, 3943,
+		962, 3403, 1012, 2924, 3592, 1523, 2115, 1921, 636, 3753, 1483, 1385, 1714, 1401, 1858, 3150,
+		331, 2373, 3398, 3657, 186, 4009, 3053, 3127, 3814, 2461, 3763, 1070, 205, 3683, 653, 2997,
+		3752, 2201, 228, 1598, 3339, 1680, 2459, 1446, 2032, 330, 821, 2121, 2793, 2529, 3069, 2122,
+		3283, 2741, 2020, 3014, 1949, 216, 506, 422, 2945, 3850, 1121, 2553, 3280, 2629, 2786, 3503,
+		2996, 3030, 1068, 3229, 184, 3610, 2245, 3981, 2586, 3368, 683, 810, 1182, 565, 334, 2914,
+		3192, 966, 3330, 3562, 1797, 2141, 2334, 947, 3972, 2109, 2793, 100, 3390, 1323, 635, 3870,
+		433, 1612, 1339, 3107, 3292, 212, 3945, 971, 1373, 1935, 1805, 889, 1227, 3133, 1146, 1277,
+		1027, 2982, 2677, 2442, 362, 1395, 1098, 1980, 2149, 1104, 2780, 2752, 3964, 2239, 1866, 2995,
+		3581, 4051, 515, 3913, 945, 1578, 3360, 577, 1269, 384, 3736, 168, 3102, 2026, 989, 3788,
+		1112, 64, 3234, 390, 4091, 2406, 909, 451, 1030, 928, 4057, 1422, 2493, 3119, 2135, 2589,
+		2674, 278, 2764, 223, 3557, 3926, 1337, 1977, 248, 2303, 2737, 3137, 3175, 725, 2711, 3810,
+		125, 2749, 3280, 718, 3791, 2515, 2507, 2325, 2925, 1058, 1082, 2340, 3340, 1334, 2527, 3598,
+		1700, 2791, 198, 3389, 1933, 2410, 2283, 511, 152, 2492, 2320, 1953, 3467, 1012, 1547, 3626,
+		2770, 1836, 827, 2367, 1388, 3881, 3931, 1525, 4022, 383, 1908, 3527, 2477, 3592, 3221, 864,
+		1243, 3829, 522, 3464, 2455, 3493, 2320, 1714, 1062, 3530, 624, 3871, 1952, 425, 2448, 1839,
+		1379, 1008, 918, 466, 3438, 2893, 2863, 768, 2146, 1312, 286, 895, 4044, 2539, 805, 80,
+		2585, 34, 1116, 3564, 69, 2290, 926, 2763, 1575, 1075, 3568, 3181, 2841, 2955, 3441, 3346,
+		2116, 2469, 3672, 274, 802, 1583, 2064, 2320, 255, 1237, 2992, 334, 688, 2770, 2191, 3366,
+		1730, 690, 3636, 1787, 1163, 1109, 733, 3583, 1063, 2542, 3994, 689, 3692, 3450, 239, 369,
+		3076, 534, 2607, 2611, 2195, 1309, 1813, 816, 3945, 3407, 1977, 1742, 3352, 3078, 873, 1615,
+		633, 1171, 2001, 167, 3020, 3634, 2849, 905, 1103, 2455, 1232, 2324, 2403, 3982, 2107, 2374,
+		1585, 1811, 2931, 3146, 1413, 166, 1521, 390, 1994, 749, 3971, 1130, 350, 2314, 2125, 3818,
+		3913, 2089, 2909, 13, 2273, 3196, 1535, 1850, 4067, 2470, 3755, 1085, 1611, 3623, 668, 4083,
+		3240, 3593, 3799, 41, 2082, 824, 544, 2639, 218, 3505, 1740, 811, 3701, 2719, 693, 1527,
+		904, 2574, 3207, 2076, 3423, 1365, 3135, 2810, 2593, 2505, 293, 1952, 2162, 855, 638, 4086,
+		3143, 3423, 3943, 2373, 3459, 1705, 2816, 753, 1696, 2172, 2963, 1208, 1908, 3005, 429, 861,
+		1092, 3693, 3744, 1713, 2523, 3778, 392, 2037, 3044, 157, 2912, 3810, 4006, 579, 2835, 2729,
+		699, 1599, 3768, 2381, 65, 3843, 2473, 2323, 3313, 2881, 2474, 2621, 3536, 1207, 1286, 2041,
+		1175, 2365, 3690, 3062, 2168, 2433, 2991, 3611, 1055, 929, 3214, 2316, 2357, 2661, 1768, 1393,
+		1762, 1728, 2772, 499, 3012, 557, 2405, 4070, 1531, 1484, 3052, 1467, 2161, 2161, 402, 234,
+		2982, 2560, 1402, 2343, 2024, 225, 3377, 3666, 3384, 2934, 3773, 1368, 2109, 3565, 963, 657,
+		64, 3450, 311, 1928, 133, 290, 61, 1678, 4043, 4086, 888, 2105, 905, 2237, 593, 2302,
+		3948, 2109, 667, 409, 788, 989, 2976, 1064, 2298, 2539, 2456, 3983, 735, 708, 1389, 1986,
+		3663, 2073, 587, 238, 2836, 3384, 3944, 3849, 1823, 2679, 2845, 606, 430, 2046, 14, 2668,
+		2623, 3062, 414, 3085, 939, 2754, 3792, 501, 2219, 3296, 3467, 2863, 428, 3873, 1852, 1836,
+		3752, 451, 65, 3371, 3630, 1199, 1374, 3006, 586, 0, 2933, 4030, 1019, 3828, 844, 3093,
+		3626, 1273, 499, 1406, 1213, 842, 1427, 2420, 3201, 2457, 69, 3740, 177, 3985, 3622, 3014,
+		2888, 2097, 1930, 2953, 2846, 1408, 3603, 70, 2973, 2103, 1064, 3862, 2427, 2880, 276, 1971,
+		2032, 2119, 3010, 1168, 2560, 3211, 4090, 664, 2782, 2208, 2166, 4071, 3247, 1116, 809, 510,
+		139, 1867, 3216, 259, 2873, 485, 1838, 3210, 3668, 2933, 2792, 2883, 1715, 2394, 2997, 2789,
+		1733, 325, 1078, 3456, 813, 2434, 2701, 1104, 2478, 2363, 3909, 265, 779, 2657, 1007, 919,
+		510, 802, 434, 3570, 4092, 2428, 1909, 3659, 1060, 1740, 2274, 138, 3377, 1107, 3305, 2048,
+		713, 3012, 3262, 2813, 2698, 320, 2245, 4006, 799, 1720, 184, 2715, 2659, 3874, 3835, 1348,
+		3786, 2017, 1949, 3447, 626, 255, 1647, 961, 148, 1161, 2256, 1327, 2352, 1737, 3786, 3879,
+		1087, 2371, 534, 1864, 3164, 1933, 2956, 3725, 1992, 1181, 2061, 1255, 3155, 3028, 2944, 1653,
+		2944, 1664, 94, 3173, 3368, 3680, 808, 1209, 3128, 748, 2929, 2219, 2305, 3756, 1451, 3619,
+		970, 3103, 511, 1953, 938, 1298, 2642, 2929, 1971, 2206, 4083, 2515, 40, 866, 265, 3145,
+	},
+	{
+		1273, 586, 826, 3072, 1436, 328, 1620, 1551, 3675, 2539, 1971, 834, 1362, 845, 41, 2008,
+		3426, 1798, 999, 2186, 832, 1067, 2353, 64, 1263, 3692, 3251, 3665, 3139, 2634, 561, 1489,
+		1370, 2248, 2374, 2013, 78, 1435, 3594, 39, 3998, 3593, 3389, 1585, 3119, 3133, 1184, 3547,
+		2059, 2110, 1241, 18, 2617, 760, 2813, 487, 2569, 2485, 3076, 153, 828, 902, 3726, 1947,
+		1546, 170, 373, 2270, 778, 1430, 2270, 1808, 2611, 2340, 3085, 1939, 725, 902, 3594, 3836,
+		3313, 1943, 3843, 197, 245, 3475, 3223, 2138, 2003, 3140, 966, 1218, 2754, 72, 3460, 3816,
+		1473, 3211, 2975, 948, 1997, 3925, 3707, 1442, 2428, 3168, 3977, 3855, 2806, 1619, 3916, 38,
+		4084, 2347, 2268, 1236, 118, 2341, 204, 1403, 663, 3336, 3527, 578, 2247, 3191, 1060, 286,
+		1434, 3910, 3999, 3041, 1558, 2005, 3087, 2193, 392, 2671, 1736, 2214, 756, 2401, 1542, 3457,
+		648, 3410, 283, 3871, 1873, 2614, 252, 3784, 583, 3997, 2729, 3156, 3225, 1956, 3460, 2594,
+		633, 732, 1252, 3344, 4076, 2230, 1007, 616, 713, 2425, 848, 2129, 887, 1747, 3012, 339,
+		1407, 3727, 861, 3279, 3218, 2766, 3547, 3077, 3637, 3218, 662, 1384, 3909, 2303, 2427, 1764,
+		963, 2278, 3715, 1815, 760, 1207, 923, 754, 1216, 1810, 516, 528, 2587, 1608, 3493, 3957,
+		364, 2222, 23, 629, 3986, 1324, 1760, 3610, 1006, 568, 665, 2182, 3913, 3432, 2325, 3363,
+		1211, 2318, 2245, 2170, 3451, 2804, 2583, 1908, 377, 3884, 3323, 2774, 2483, 2833, 3433, 1778,
+		3884, 642, 1106, 1161, 2485, 317, 1468, 2079, 850, 887, 2034, 1666, 2803, 2421, 1114, 923,
+		671, 1716, 2958, 1802, 1757, 2442, 542, 2117, 873, 325, 675, 1909, 1953, 989, 2378, 1611,
+		824, 309, 4047, 258, 2186, 2818, 1158, 771, 2665, 378, 1526, 3589, 1418, 3805, 2266, 2524,
+		1245, 1219, 3584, 4041, 798, 974, 779, 3232, 367, 4040, 3006, 2101, 3913, 3002, 1662, 3503,
+		2003, 3379, 700, 2104, 2296, 3231, 1391, 805, 3393, 1819, 3780, 1180, 3341, 546, 970, 829,
+		1298, 3095, 2402, 330, 3264, 2245, 2327, 3623, 2327, 544, 343, 2989, 1198, 3069, 3073, 3308,
+		1541, 1159, 827, 1134, 155, 1121, 641, 2136, 836, 3332, 3654, 839, 82, 2757, 3792, 2497,
+		3494, 1292, 805, 328, 922, 4008, 1062, 2549, 300, 977, 475, 1287, 1026, 1050, 2243, 3317,
+		600, 3926, 3570, 479, 635, 3868, 996, 1186, 581, 2234, 3615, 3295, 1261, 3176, 2576, 2608,
+		2445, 4078, 290, 1956, 2792, 1297, 1931, 795, 3757, 642, 598, 2398, 2903, 3324, 212, 2108,
+		671, 3776, 917, 4007, 1260, 2739, 861, 2932, 3502, 3373, 1272, 2658, 3636, 1272, 1065, 324,
+		606, 3408, 3466, 3291, 3701, 2136, 3339, 2365, 1327, 2996, 1358, 2343, 1613, 3154, 649, 4091,
+		3935, 156, 2789, 3218, 2903, 3319, 1231, 124, 1318, 2186, 56, 3230, 2463, 1573, 1283, 2342,
+		1445, 1438, 3149, 3086, 3620, 2361, 2374, 3157, 3277, 1317, 3002, 4059, 1754, 2219, 1229, 3946,
+		4054, 2000, 2202, 522, 155, 3251, 3188, 1919, 849, 2217, 3571, 965, 1246, 549, 2816, 2898,
+		2400, 3315, 2440, 1161, 3913, 573, 3949, 1669, 3912, 2391, 909, 1380, 2988, 412, 978, 866,
+		3916, 97, 3275, 1727, 1605, 2385, 2851, 1453, 1262, 2779, 1183, 3944, 2271, 890, 2933, 4005,
+		1945, 3018, 2386, 3691, 2379, 3563, 219, 3131, 3846, 3639, 2145, 2895, 3666, 2583, 3052, 3546,
+		2607, 563, 3843, 1158, 1949, 2626, 1179, 1386, 960, 1673, 1296, 3431, 2509, 2173, 2883, 3411,
+		3438, 47, 3221, 1189, 459, 489, 2759, 2203, 3866, 35, 1348, 1894, 3611, 731, 1825, 1488,
+		1049, 2400, 3853, 2350, 3360, 3254, 2615, 634, 2431, 2051, 236, 3468, 1265, 3938, 3899, 2885,
+		1932, 462, 1489, 2567, 3679, 2204, 2998, 3036, 193, 571, 1204, 3246, 1626, 2137, 2849, 3263,
+		766, 2534, 1009, 1919, 570, 2936, 60, 1892, 649, 2868, 283, 1512, 1999, 1594, 473, 521,
+		3241, 1737, 3153, 3200, 2126, 3933, 2169, 1118, 997, 3978, 1119, 425, 1027, 1191, 1664, 666,
+		446, 2530, 110, 1032, 377, 3432, 2704, 2455, 1202, 58, 3081, 215, 3152, 2463, 2684, 3196,
+		1396, 3688, 551, 3994, 3093, 309, 2757, 1765, 3887, 3461, 3139, 2700, 2949, 494, 6, 2684,
+		1704, 4001, 1059, 1233, 2999, 3896, 880, 923, 3821, 3077, 1768, 1738, 2187, 1187, 699, 3985,
+		1289, 125, 3411, 1334, 3252, 1037, 1677, 246, 2013, 3912, 1178, 3729, 4021, 3624, 3435, 1504,
+		94, 1184, 3320, 1196, 2602, 2697, 2146, 1867, 4021, 1576, 2096, 765, 736, 3636, 1149, 3300,
+		1538, 3027, 2562, 4007, 85, 2704, 3602, 602, 2391, 2057, 1720, 3478, 3407, 2725, 186, 4008,
+		3990, 2057, 3452, 2631, 1716, 3610, 3513, 3687, 1607, 1552, 2538, 215, 3439, 224, 1344, 25,
+		3235, 747, 2135, 2567, 1297, 821, 2747, 296, 1721, 1942, 3597, 509, 2132, 2064, 2861, 2899,
+		93, 3738, 3179, 3964, 2654, 1790, 3436, 2182, 2939, 496, 2969, 626, 1144, 3478, 774, 2227,
+		2084, 1643, 1543, 2912, 1229, 3215, 944, 3148, 2408, 2115, 2864, 1427, 1099, 3735, 1009, 284,
+		1509, 3476, 1352, 487, 1004, 3595, 2458, 1701, 1875, 1941, 517, 1343, 3956, 1729, 2746, 2730,
+		783, 258, 2414, 358, 3518, 2714, 2714, 2454, 398, 2576, 277, 223, 1769, 200, 347, 1905,
+		1733, 2905, 1831, 957, 1609, 2755, 3416, 3429, 1056, 508, 3707, 2269, 3292, 3068, 813, 52,
+		2561, 2077, 2524, 3481, 1238, 567, 4089, 3982, 4045, 2565, 1287, 2774, 873, 4056, 1611, 2636,
+		3414, 3755, 1738, 1188, 1362, 751, 3123, 1881, 537, 3471, 3182, 4003, 100, 3318, 1309, 1909,
+		3919, 538, 1597, 2908, 779, 2349, 3785, 2013, 2424, 2602, 3619, 1101, 1036, 3569, 1496, 3585,
+		804, 3055, 3355, 3977, 1818, 3072, 2014, 3188, 1836, 1866, 1112, 3649, 2670, 1930, 2706, 1562,
+		2749, 918, 2556, 3263, 1361, 1788, 122, 3088, 910, 3479, 3229, 2690, 1548, 407, 2461, 3118,
+		3284, 1585, 1907, 2125, 3123, 3342, 1451, 2214, 2668, 2851, 3734, 328, 3654, 639, 1385, 2105,
+		2765, 2878, 282, 448, 885, 2918, 1317, 2756, 3889, 3708, 3779, 2677, 2139, 4058, 559, 4,
+		2836, 3645, 2722, 3151, 3886, 1840, 691, 3461, 3363, 1544, 3772, 853, 2780, 2344, 563, 1951,
+		2307, 3562, 2198, 131, 3869, 3585, 3587, 641, 3274, 3383, 2759, 1393, 596, 2284, 3541, 1062,
+		1852, 1970, 3452, 1855, 1725, 238, 164, 3633, 445, 3334, 3947, 3765, 3080, 2213, 2128, 175,
+		1975, 2767, 3759, 43, 798, 492, 4068, 1412, 2834, 518, 1870, 3581, 2398, 158, 3810, 3484,
+		3634, 114, 3550, 3366, 3363, 683, 3160, 2391, 2052, 113, 2693, 1141, 3790, 196, 1906, 39,
+	},
+}
+STAR_LAYER_INDEX =
+{
+	{1, 5, 9, 13},
+	{1, 5, 10, 13},
+	{1, 6, 10, 13},
+	{1, 6, 10, 14},
+	{2, 6, 10, 14},
+	{2, 6, 11, 14},
+	{2, 7, 11, 14},
+	{2, 7, 11, 15},
+	{3, 7, 11, 15},
+	{3, 7, 12, 15},
+	{3, 8, 12, 15},
+	{3, 8, 12, 16},
+	{4, 8, 12, 16},
+	{4, 8, 9, 16},
+	{4, 5, 9, 16},
+	{4, 5, 9, 13},
+}
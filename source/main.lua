@@ -31,30 +31,36 @@ local function debug_frame_rate()
 	return true
 end
 
+-- Debug counters and timers.  These are all in one table to keep the
+-- number of locals in the main chunk under Lua's limit of 200.  Like the
+-- other debug helpers, the functions here are called inside assert(), so
+-- release builds strip the whole table.
+local debug_stats <const> = {}
+
 -- Increment debug counter.
-local function debug_count(v)
-	if not debug_counters then
-		debug_counters = {}
+function debug_stats.count(v)
+	if not debug_stats.counters then
+		debug_stats.counters = {}
 	end
-	if debug_counters[v] then
-		debug_counters[v] += 1
+	if debug_stats.counters[v] then
+		debug_stats.counters[v] += 1
 	else
-		debug_counters[v] = 1
+		debug_stats.counters[v] = 1
 	end
 	return true
 end
 
 -- Reset debug counters.
-local function debug_reset_counts()
-	debug_counters = nil
+function debug_stats.reset_counts()
+	debug_stats.counters = nil
 	return true
 end
 
 -- Log debug counters.
-local function debug_log_counts()
-	if debug_counters then
+function debug_stats.log_counts()
+	if debug_stats.counters then
 		local t = {}
-		for k, v in pairs(debug_counters) do
+		for k, v in pairs(debug_stats.counters) do
 			table.insert(t, k .. "=" .. v)
 		end
 		table.sort(t)
@@ -67,17 +73,58 @@ local function debug_log_counts()
 	return true
 end
 
--- Log debug counters periodically.
-local function debug_periodic_log()
-	if debug_last_log_age then
-		debug_last_log_age += 1
-		if debug_last_log_age == 150 then
-			debug_log_counts()
-			debug_last_log_age = 0
+-- Start or stop a named timer.  Each timer keeps the most recent 256
+-- samples in ring buffers, with each sample being elapsed time in
+-- microseconds and change in Lua memory usage in bytes between start and
+-- stop.  A negative memory delta means garbage collector ran inside the
+-- timed section.
+--
+-- Use dump_timers() in simulator console to print all timers as CSV,
+-- see debug_export().
+function debug_stats.timer(name, start)
+	assert(type(name) == "string")
+	assert(type(start) == "boolean")
+	if not debug_stats.timers then
+		debug_stats.timers = {}
+	end
+	local t = debug_stats.timers[name]
+	if not t then
+		t =
+		{
+			elapsed = table.create(256, 0),
+			memory = table.create(256, 0),
+			next = 1,
+		}
+		debug_stats.timers[name] = t
+	end
+
+	if start then
+		t.start_time = playdate.getElapsedTime()
+		t.start_memory = collectgarbage("count")
+	elseif t.start_time then
+		t.elapsed[t.next] = math.floor((playdate.getElapsedTime() - t.start_time) * 1000000)
+		t.memory[t.next] = math.floor((collectgarbage("count") - t.start_memory) * 1024)
+		t.next = t.next % 256 + 1
+		t.start_time = nil
+	end
+	return true
+end
+
+-- Log debug counters periodically.  This is called once per frame, so we
+-- also collect per-frame timing here.
+function debug_stats.periodic_log()
+	debug_stats.timer("frame", false)
+	debug_stats.timer("frame", true)
+
+	if debug_stats.last_log_age then
+		debug_stats.last_log_age += 1
+		if debug_stats.last_log_age == 150 then
+			debug_stats.log_counts()
+			debug_stats.last_log_age = 0
 		end
 	else
-		debug_log_counts()
-		debug_last_log_age = 0
+		debug_stats.log_counts()
+		debug_stats.last_log_age = 0
 	end
 	return true
 end
@@ -157,6 +204,14 @@ assert(DRAW_EVEN_HALF_HEIGHT >= SCREEN_CENTER_Y + TARGET_Y_SPACING // 2)
 assert((DRAW_ODD_HALF_HEIGHT * 2) % TARGET_Y_SPACING == 0)
 assert(DRAW_ODD_HALF_HEIGHT >= SCREEN_CENTER_Y + TARGET_Y_SPACING // 2)
 
+-- Number of target slots in each dimension, see comments near "target".
+-- Grid needs to be large enough to hold the longest chain plus all visible
+-- targets around it without any two live targets landing in the same slot.
+local TARGET_GRID_COLUMNS <const> = 64
+local TARGET_GRID_ROWS <const> = 64
+assert(TARGET_GRID_COLUMNS > MAX_CHAIN_LENGTH + 2 * DRAW_HALF_WIDTH // TARGET_X_SPACING + 2)
+assert(TARGET_GRID_ROWS > MAX_CHAIN_LENGTH + 2 * DRAW_ODD_HALF_HEIGHT // TARGET_Y_SPACING + 2)
+
 -- Hint display modes, used by "hint_mode".
 local HINTS_DELAYED <const> = 1
 local HINTS_VISIBLE <const> = 2
@@ -206,7 +261,6 @@ local TITLE_TEXT_X <const> = 103
 local TITLE_TEXT_Y <const> = 50
 local large_digit <const> = gfx.imagetable.new("images/large-digit")
 local small_digit <const> = gfx.imagetable.new("images/small-digit")
-local sprite <const> = gfx.imagetable.new("images/sprite")
 local dots <const> = gfx.imagetable.new("images/dots")
 local stars <const> = gfx.imagetable.new("images/stars")
 local mode_popups <const> = gfx.imagetable.new("images/modes")
@@ -214,7 +268,6 @@ local title_background <const> = gfx.image.new("images/title-background")
 local title_char <const> = gfx.imagetable.new("images/title-char")
 assert(large_digit)
 assert(small_digit)
-assert(sprite)
 assert(dots)
 assert(stars)
 assert(mode_popups)
@@ -229,8 +282,6 @@ assert(({large_digit[1]:getSize()})[1] == LARGE_DIGIT_WIDTH)
 assert(({large_digit[1]:getSize()})[2] == LARGE_DIGIT_HEIGHT)
 assert(({small_digit[1]:getSize()})[1] == SMALL_DIGIT_WIDTH)
 assert(({small_digit[1]:getSize()})[2] == SMALL_DIGIT_HEIGHT)
-assert(({sprite[1]:getSize()})[1] == SPRITE_WIDTH)
-assert(({sprite[1]:getSize()})[2] == SPRITE_HEIGHT)
 assert(({dots[1]:getSize()})[1] == DOTS_WIDTH)
 assert(({dots[1]:getSize()})[2] == DOTS_HEIGHT)
 assert(({stars:getSize()})[1] == STAR_VARIATION_COUNT * 2)
@@ -245,6 +296,45 @@ assert(({title_background:getSize()})[1] == 400)
 assert(({title_background:getSize()})[2] == 240)
 assert(STAR_SIZE % STAR_TILE_SIZE == 0)
 
+-- Draw a single sprite centered at (x,y).
+--
+-- Sprites are packed into a single atlas image, with each cell cropped
+-- to its own bounding box (see crop_table.c).  This takes about a third
+-- of the image memory of a table of uniformly sized cells, most of which
+-- would be empty.  SPRITE_ATLAS holds the position of each cropped cell
+-- within the atlas, and where it was within the original uncropped cell.
+local draw_sprite <const> = (function()
+	local atlas <const> = gfx.image.new("images/sprite-atlas")
+	assert(atlas)
+
+	-- Convert atlas entries to source rectangles and draw offsets, so that
+	-- nothing is allocated while drawing.  Blank cells are set to false.
+	local cells <const> = table.create(#SPRITE_ATLAS, 0)
+	for i = 1, #SPRITE_ATLAS do
+		local c <const> = SPRITE_ATLAS[i]
+		assert(c[5] + c[3] <= SPRITE_WIDTH)
+		assert(c[6] + c[4] <= SPRITE_HEIGHT)
+		if c[3] > 0 then
+			cells[i] =
+			{
+				playdate.geometry.rect.new(c[1], c[2], c[3], c[4]),
+				c[5] - SPRITE_HALF_WIDTH,
+				c[6] - SPRITE_HALF_HEIGHT,
+			}
+		else
+			cells[i] = false
+		end
+	end
+
+	return function(i, x, y)
+		local c <const> = cells[i]
+		assert(c ~= nil)
+		if c then
+			atlas:draw(x + c[2], y + c[3], gfx.kImageUnflipped, c[1])
+		end
+	end
+end)()
+
 -- When game is in autoplay mode, perform an action at this period.
 -- 1 means perform an action on every frame, 30 means perform one action
 -- every second.  Reducing this value allows the human to sort of watch
@@ -279,17 +369,45 @@ local AUTOPLAY_ENABLED <const> = 9
 local AUTOPLAY_RANDOM <const> = 1
 local AUTOPLAY_RANDOM_AVOID_OBSTACLE <const> = 2
 local AUTOPLAY_FOLLOW_HINT_ANY <const> = 3
-local AUTOPLAY_FOLLOW_HINT_LONG <const> = 4
+local AUTOPLAY_SOLVE <const> = 4
 local AUTOPLAY_FOLLOW_HINT_ZERO <const> = 5
 local AUTOPLAY_FOLLOW_HINT_ONE <const> = 6
 
+-- Time budget per frame for AUTOPLAY_SOLVE, in milliseconds.  Frame budget
+-- is ~33ms at 30fps, and drawing takes up most of that on device.
+local SOLVER_FRAME_BUDGET <const> = 6
+
+-- Maximum number of frames to wait for the solver before following the
+-- best chain found so far.
+local SOLVER_MAX_FRAMES <const> = 10
+
+-- Maximum number of states a single AUTOPLAY_SOLVE search will record for
+-- deduplication.  States beyond this limit are still searched, just not
+-- deduplicated, and the search as a whole is still bounded by the frame
+-- budget above.
+local SOLVER_MAX_SEEN <const> = 8192
+
 -- Sounds.
+--
+-- Each note used by NOTE_GROUPS is a separate sample that was already
+-- pitch-shifted at build time (see render_notes.pl), so all notes can be
+-- played at their original rate.  Notes are played by swapping samples
+-- on a fixed set of players, one per channel.
 assert(MAX_NOTE_CHANNELS > 1)
+local note_sample <const> = {}
+for i = 1, #NOTE_GROUPS do
+	for j = 1, #NOTE_GROUPS[i] do
+		local note <const> = NOTE_GROUPS[i][j]
+		if not note_sample[note] then
+			note_sample[note] = playdate.sound.sample.new(string.format("sounds/note-%02d", note))
+			assert(note_sample[note])
+		end
+	end
+end
 local celesta = table.create(MAX_NOTE_CHANNELS, 0)
-celesta[1] = playdate.sound.sampleplayer.new("sounds/celesta")
-assert(celesta[1])
-for i = 2, MAX_NOTE_CHANNELS do
-	celesta[i] = celesta[1]:copy()
+for i = 1, MAX_NOTE_CHANNELS do
+	celesta[i] = playdate.sound.sampleplayer.new(note_sample[NOTE_GROUPS[1][1]])
+	assert(celesta[i])
 end
 
 -- Channels.
@@ -407,8 +525,10 @@ local current_chain = nil
 local solution_path_0 = nil
 local solution_path_f = nil
 
--- Target data, a 2D table indexed by [x][y], with these values:
+-- Target data, a flat table of TARGET_GRID_COLUMNS * TARGET_GRID_ROWS slots
+-- indexed by target_index(x, y), with each slot containing these values:
 -- {
+--    x, y = target coordinate, nil if slot is empty.
 --    value = operand value [0x00..0xff].
 --    motion = oscillating motion type [1..DRIFT_OFFSET_COUNT].
 --    motion_phase = motion phase shift [1..DRIFT_FRAME_COUNT].
@@ -420,29 +540,69 @@ local solution_path_f = nil
 --    maze_generation = see generate_solutions().
 -- }
 --
--- Table is lazily initialized as we expand the camera view.  Overflow
--- in the table indices doesn't happen because player can't travel that far:
+-- Slots wrap around, so the grid is a torus of fixed size that follows the
+-- cursor around, and targets that are too far away to be visible or be part
+-- of the current chain are silently replaced when some other target maps to
+-- the same slot.  If the player goes back to a previously visited region,
+-- they will see a different set of targets, but there is no way to tell
+-- since it would take many screens worth of travel to get there.
 --
---   2**31 / (96 pixels per frame * 30 frames per second) = ~8 days
+-- Because the grid has a fixed size, memory usage stays constant no matter
+-- how far the player travels, even in long autoplay sessions.  Slot tables
+-- are reused across targets and across games, so init_target stops producing
+-- garbage once all slots have been touched.
 --
--- Each game ends in a few minutes, and we will probably run out of memory
--- first anyway.
+-- Overflow in the coordinates doesn't happen because player can't travel
+-- that far:
 --
--- Now, if the player wants to exhaust all available memory, they can enable
--- autoplay mode and wait, but it will take quite a while since autoplay
--- tend to not drift very far away from origin.  This is because we generated
--- the grid by branching out in all directions at random, so on average the
--- solutions will be near the origin.  Of course the player can expand in
--- one direction manually, but it takes quite a while to do that too and it's
--- just not a particularly fun thing to do.  So rather than implementing a
--- a garbage collector to clean up distant targets, my bet is that player
--- will run out of patience before we run out of memory.
+--   2**31 / (96 pixels per frame * 30 frames per second) = ~8 days
 local target = nil
 
 -- Coordinate of current cursor position.
 local cursor_x = nil
 local cursor_y = nil
 
+-- Get slot index for a target coordinate.  Each column of targets share
+-- the same x, and even and odd columns are offset by half a row, so
+-- integer division gives a unique (column, row) pair for each target.
+local function target_index(x, y)
+	return (x // TARGET_X_SPACING) % TARGET_GRID_COLUMNS * TARGET_GRID_ROWS + (y // TARGET_Y_SPACING) % TARGET_GRID_ROWS + 1
+end
+
+-- Get target at a particular coordinate, or nil if it hasn't been
+-- initialized yet.
+local function get_target(x, y)
+	local t <const> = target[target_index(x, y)]
+	if t and t.x == x and t.y == y then
+		return t
+	end
+	return nil
+end
+
+-- Remove target at a particular coordinate.  Slot table is kept around so
+-- that it can be reused by init_target.
+local function remove_target(x, y)
+	local t <const> = get_target(x, y)
+	if t then
+		t.x = nil
+		t.y = nil
+	end
+end
+
+-- Mark all target slots as empty.
+local function reset_targets()
+	if target then
+		for i = 1, TARGET_GRID_COLUMNS * TARGET_GRID_ROWS do
+			if target[i] then
+				target[i].x = nil
+				target[i].y = nil
+			end
+		end
+	else
+		target = table.create(TARGET_GRID_COLUMNS * TARGET_GRID_ROWS, 0)
+	end
+end
+
 -- Coordinate of viewport center.
 local camera_x = nil
 local camera_y = nil
@@ -509,7 +669,7 @@ local function reset(return_to_title)
 		set_next_game_state(game_title)
 	end
 
-	target = {}
+	reset_targets()
 	global_frames = 0
 
 	last_action_timestamp = 0
@@ -547,7 +707,7 @@ local function reset(return_to_title)
 
 	autoplay_level = 0
 
-	assert(debug_reset_counts())
+	assert(debug_stats.reset_counts())
 end
 
 -- Initialize starfield layers.
@@ -556,23 +716,21 @@ local function init_starfield()
 	local width <const> = STAR_SIZE // STAR_TILE_SIZE
 	local cell_count <const> = width * width
 
-	local base_cells = table.create(cell_count, 0)
 	local cells = table.create(cell_count, 0)
 
 	starfield = table.create(16, 0)
 	for layer = 1, 16, 4 do
-		-- Initialize base set of cells for each layer.  This assigns star
+		-- Get base set of cells for each layer.  This assigns star
 		-- variations for each cell, and also animation variations for
-		-- each frame.  To reduce number of calls to rand(), the cell values
-		-- are encoded as follows:
+		-- each frame.  Cell values are precomputed by generate_starfield.pl,
+		-- and are encoded as follows:
 		-- bits 0..1 = variation for frame 0
 		-- bits 2..3 = variation for frame 1
 		-- bits 4..5 = variation for frame 2
 		-- bits 6..7 = variation for frame 3
-		-- bits 8..12 = star variation.
-		for i = 1, cell_count do
-			base_cells[i] = rand(0, 0xfff)
-		end
+		-- bits 8..11 = star variation.
+		local base_cells <const> = STAR_CELLS[(layer + 3) // 4]
+		assert(#base_cells == cell_count)
 
 		for frame = 0, 3 do
 			starfield[layer + frame] = gfx.tilemap.new()
@@ -586,14 +744,14 @@ local function init_starfield()
 					-- Cell is either permanently empty space (6/16 chance),
 					-- or it's empty for current frame (1/4 chance).
 					cells[i] = -1
-					assert(debug_count("star_empty"))
+					assert(debug_stats.count("star_empty"))
 				else
 					-- Cell contains a visible star.  Either use the small dot
 					-- variant (2/4 chance) or the cross variant (1/4 chance).
 					cells[i] = base_variation * 2 + 1 + (frame_variation >> 1)
 					assert(cells[i] >= 1)
 					assert(cells[i] <= ({stars:getSize()})[1])
-					assert(debug_count((frame_variation >> 1) == 1 and "star_cross" or "star_dot"))
+					assert(debug_stats.count((frame_variation >> 1) == 1 and "star_cross" or "star_dot"))
 				end
 			end
 			starfield[layer + frame]:setTiles(cells, width)
@@ -603,7 +761,7 @@ local function init_starfield()
 	inverted_starfield = gfx.image.new(400, 240)
 	inverted_starfield:setInverted(true)
 	assert(debug_log("init_starfield done"))
-	assert(debug_log_counts())
+	assert(debug_stats.log_counts())
 end
 
 -- Draw a single set of starfield tiles at a particular offset.
@@ -620,20 +778,20 @@ local function draw_star_layer(star_tiles, x, y)
 			star_tiles:draw(x - STAR_SIZE, y)
 			star_tiles:draw(x, y - STAR_SIZE)
 			star_tiles:draw(x, y)
-			assert(debug_count("star_split4"))
+			assert(debug_stats.count("star_split4"))
 		else
 			star_tiles:draw(x - STAR_SIZE, y - STAR_SIZE)
 			star_tiles:draw(x, y - STAR_SIZE)
-			assert(debug_count("star_split2h"))
+			assert(debug_stats.count("star_split2h"))
 		end
 	else
 		if y < 240 then
 			star_tiles:draw(x - STAR_SIZE, y - STAR_SIZE)
 			star_tiles:draw(x - STAR_SIZE, y)
-			assert(debug_count("star_split2v"))
+			assert(debug_stats.count("star_split2v"))
 		else
 			star_tiles:draw(x - STAR_SIZE, y - STAR_SIZE)
-			assert(debug_count("star_split0"))
+			assert(debug_stats.count("star_split0"))
 		end
 	end
 end
@@ -648,14 +806,11 @@ local function draw_starfield()
 	-- layer_index[2]    5  5  6  6  6  6  7  7  7  7  8  8  8  8  5  5
 	-- layer_index[3]    9 10 10 10 10 11 11 11 11 12 12 12 12  9  9  9
 	-- layer_index[4]   13 13 13 14 14 14 14 15 15 15 15 16 16 16 16 13
-	local base_frame <const> = (global_frames // 2) & 15
-	local layer_index <const> =
-	{
-		(base_frame >> 2) + 1,
-		(((base_frame + 2) >> 2) & 3) + 5,
-		(((base_frame + 3) >> 2) & 3) + 9,
-		(((base_frame + 1) >> 2) & 3) + 13,
-	}
+	--
+	-- These are precomputed in STAR_LAYER_INDEX, so that we don't need to
+	-- allocate a new table on every frame.
+	local layer_index <const> = STAR_LAYER_INDEX[((global_frames // 2) & 15) + 1]
+	assert(#layer_index == 4)
 
 	-- Draw layers from bottom to top, moving from slower speeds to higher
 	-- speeds.  The offset calculation has a few notable components:
@@ -708,26 +863,29 @@ local function init_target(x, y)
 	assert(y == floor(y))
 	assert((x % (TARGET_X_SPACING * 2) == 0 and y % TARGET_Y_SPACING == 0) or (x % (TARGET_X_SPACING * 2) == TARGET_X_SPACING and y % TARGET_Y_SPACING == TARGET_Y_SPACING // 2))
 	assert(target)
-	if not target[x] then
-		assert(debug_count("add_column"))
-		target[x] = {}
+	local index <const> = target_index(x, y)
+	local t = target[index]
+	if not t then
+		assert(debug_stats.count("add_slot"))
+		t = {}
+		target[index] = t
 	end
-	local column = target[x]
 
-	if not column[y] then
-		assert(debug_count("add_cell"))
+	if t.x ~= x or t.y ~= y then
+		assert(debug_stats.count("add_cell"))
 		assert(BIT_TABLE[game_mode])
-		column[y] =
-		{
-			-- See generate_bit_table.pl on value generation.
-			value = BIT_TABLE[game_mode][rand(BIT_TABLE_SIZE[game_mode])],
-			variation = rand(3, 32),
-			motion = rand(1, DRIFT_OFFSET_COUNT),
-			motion_phase = rand(1, DRIFT_FRAME_COUNT),
-			selected = TARGET_UNSELECTED,
-			birth_frame = global_frames,
-			birth_variation = rand(0, 7)
-		}
+		t.x = x
+		t.y = y
+
+		-- See generate_bit_table.pl on value generation.
+		t.value = BIT_TABLE[game_mode][rand(BIT_TABLE_SIZE[game_mode])]
+		t.variation = rand(3, 32)
+		t.motion = rand(1, DRIFT_OFFSET_COUNT)
+		t.motion_phase = rand(1, DRIFT_FRAME_COUNT)
+		t.selected = TARGET_UNSELECTED
+		t.birth_frame = global_frames
+		t.birth_variation = rand(0, 7)
+		t.maze_generation = nil
 	end
 
 	-- Compute screen coordinates.  We do this instead of using setDrawOffset
@@ -737,7 +895,6 @@ local function init_target(x, y)
 	-- Also, we do this inside init_target instead of draw_target so that
 	-- we can compute coordinate values without drawing.  This is needed
 	-- to get the correct drawing order with connecting lines and targets.
-	local t = column[y]
 	local drift <const> = DRIFT_OFFSET[t.motion][(global_frames - t.birth_frame + t.motion_phase) % DRIFT_FRAME_COUNT + 1]
 	t.sx = x - camera_x + SCREEN_CENTER_X + drift[1]
 	t.sy = y - camera_y + SCREEN_CENTER_Y + drift[2]
@@ -754,12 +911,12 @@ local function draw_target(x, y)
 
 	-- Draw selection cursor.
 	if t.selected == TARGET_COMMITTED then
-		sprite:drawImage(2, t.sx - SPRITE_HALF_WIDTH, t.sy - SPRITE_HALF_HEIGHT)
+		draw_sprite(2, t.sx, t.sy)
 	end
 
 	if t.value == 0 then
 		-- Draw special sprite.
-		sprite:drawImage(t.variation, t.sx - SPRITE_HALF_WIDTH, t.sy - SPRITE_HALF_HEIGHT)
+		draw_sprite(t.variation, t.sx, t.sy)
 	else
 		-- Draw value.
 		local d0y <const> = t.sy - LARGE_DIGIT_HALF_HEIGHT
@@ -786,16 +943,15 @@ local function draw_birthmark(x, y)
 
 	-- Avoid calling init_target again.  Target is guaranteed to be initialized
 	-- since draw_target would have been called for this target earlier.
-	assert(target[x])
-	assert(target[x][y])
-	local t <const> = target[x][y]
+	local t <const> = get_target(x, y)
+	assert(t)
 	assert(t.sx)
 	assert(t.sy)
 
 	local age <const> = global_frames - t.birth_frame
 	if age < 16 then
 		local i <const> = t.birth_variation * 16 + age + 33
-		sprite:drawImage(i, t.sx - SPRITE_HALF_WIDTH, t.sy - SPRITE_HALF_HEIGHT)
+		draw_sprite(i, t.sx, t.sy)
 	end
 end
 
@@ -883,8 +1039,10 @@ local function draw_next_target()
 	assert(next_target_direction < 360)
 	local p <const> = CURSOR_POLY[next_target_direction]
 	assert(p)
-	local cx <const> = target[cursor_x][cursor_y].sx
-	local cy <const> = target[cursor_x][cursor_y].sy
+	local cursor <const> = get_target(cursor_x, cursor_y)
+	assert(cursor)
+	local cx <const> = cursor.sx
+	local cy <const> = cursor.sy
 	local x0 <const> = cx + p[1]
 	local y0 <const> = cy + p[2]
 	local x1 <const> = cx + p[3]
@@ -918,7 +1076,7 @@ local function draw_next_target()
 		gfx.fillTriangle(x0, y0, x1, y1, x2, y2)
 
 		-- Also highlight next target.
-		sprite:drawImage(1, target[tx][ty].sx - SPRITE_HALF_WIDTH, target[tx][ty].sy - SPRITE_HALF_HEIGHT)
+		draw_sprite(1, t.sx, t.sy)
 	end
 end
 
@@ -1151,6 +1309,14 @@ local function complete_path(path, depth, value, goal_target)
 	populate_solution_path_f(path, depth)
 end
 
+-- Scratch buffer for generate_solutions().  All MAX_CHAIN_LENGTH positions
+-- are allocated up front and reused across calls, so that the search itself
+-- does not produce any garbage.
+local solution_search_path <const> = table.create(MAX_CHAIN_LENGTH, 0)
+for i = 1, MAX_CHAIN_LENGTH do
+	solution_search_path[i] = {0, 0}
+end
+
 -- Recursively initialize two solution paths.  Returns true if both solution
 -- paths have been found.
 --
@@ -1173,8 +1339,15 @@ end
 -- a chain of length 2 available at the beginning of the game, unless the
 -- starting position happens to be surrounded by targets with zero values.
 --
+-- Note that there is nothing to be reused from the previous solutions when
+-- we get here after a completed chain: the cursor has moved to the end of
+-- that chain, so the new paths start from a different target, and the value
+-- at that target is about to be adjusted by init_chains() anyways.  Thus
+-- every search starts from scratch, and what we can do to keep frame times
+-- down is to make each search cheap.
+--
 -- Arguments:
---  path = current path, possibly with trailing elements.
+--  path = current path, with preallocated trailing elements.
 --  depth = true length of current path.
 --  value = XOR of all values before the final target.
 local function generate_solutions(path, depth, value)
@@ -1268,8 +1441,8 @@ local function generate_solutions(path, depth, value)
 		local direction <const> = PERMUTATIONS6[rand(PERMUTATIONS6_COUNT)]
 		assert(direction)
 		assert(#direction == 6)
-		local next_position = table.create(2, 0)
-		path[depth + 1] = next_position
+		local next_position <const> = path[depth + 1]
+		assert(next_position)
 		for i = 1, 6 do
 			next_position[1] = x + TARGET_OFFSET[direction[i]][1]
 			next_position[2] = y + TARGET_OFFSET[direction[i]][2]
@@ -1281,12 +1454,107 @@ local function generate_solutions(path, depth, value)
 	return false
 end
 
+-- Native implementation of generate_solutions(), or nil if the extension
+-- is not loaded.  See native/maze.h for how targets map to cell indices.
+local native_maze <const> = maze
+local MAZE_HALF_COLUMNS <const> = 4
+local MAZE_HALF_ROWS <const> = 6
+local MAZE_ROWS <const> = MAZE_HALF_ROWS * 2 + 1
+local MAZE_CELLS <const> = (MAZE_HALF_COLUMNS * 2 + 1) * MAZE_ROWS
+local MAZE_NEW <const> = 1
+local MAZE_VISITED <const> = 2
+
+-- Set to true to have init_chains use native_maze by default.  This is
+-- off until the extension has been built and tested with the Playdate SDK
+-- for both simulator and device, since so far native/*.c have only been
+-- compiled against a stub header.  debug_fuzz_init_chains still exercises
+-- native_maze in the simulator whenever it's loaded.
+local ENABLE_NATIVE_MAZE <const> = false
+
+-- If true, init_chains will use native_maze instead of generate_solutions().
+local use_native_maze = ENABLE_NATIVE_MAZE and native_maze ~= nil
+
+-- Targets passed to native_maze, indexed by cell index + 1.  Entries are
+-- reset to false after each call, so that we don't hold on to removed
+-- targets.
+local native_maze_cells = table.create(MAZE_CELLS, 0)
+for i = 1, MAZE_CELLS do
+	native_maze_cells[i] = false
+end
+
+-- Convert a native solution path to a list of target coordinates, returns
+-- nil if path was not found.
+local function get_native_solution_path(which)
+	assert(type(which) == "number")
+
+	local length <const> = native_maze.path_length(which)
+	if length == 0 then
+		return nil
+	end
+	local path = table.create(length, 0)
+	for i = 1, length do
+		local index <const> = native_maze.path_cell(which, i)
+		path[i] =
+		{
+			cursor_x + (index // MAZE_ROWS - MAZE_HALF_COLUMNS) * TARGET_X_SPACING,
+			cursor_y + (index % MAZE_ROWS - MAZE_HALF_ROWS) * (TARGET_Y_SPACING // 2)
+		}
+	end
+	return path
+end
+
+-- Initialize two solution paths using native_maze.
+--
+-- This does the same randomized depth-first search as generate_solutions(),
+-- except all targets that the search could possibly reach are initialized
+-- up front, since the native code can't call init_target.  This is a small
+-- window around the cursor, and most of those targets were already
+-- populated for display anyways.
+local function generate_solutions_native()
+	local cells <const> = native_maze_cells
+	native_maze.reset(all_ones, rand(0x7fffffff))
+	for dx = -MAZE_HALF_COLUMNS, MAZE_HALF_COLUMNS do
+		local x <const> = cursor_x + dx * TARGET_X_SPACING
+		for dy = -MAZE_HALF_ROWS, MAZE_HALF_ROWS do
+			if (dx + dy) % 2 == 0 then
+				local t <const> = init_target(x, cursor_y + dy * (TARGET_Y_SPACING // 2))
+				local flags = 0
+				if t.birth_frame == global_frames then
+					flags = MAZE_NEW
+				end
+				if t.maze_generation == global_frames then
+					flags = flags | MAZE_VISITED
+				end
+				local index <const> = (dx + MAZE_HALF_COLUMNS) * MAZE_ROWS + dy + MAZE_HALF_ROWS
+				native_maze.set(index, t.value, flags)
+				cells[index + 1] = t
+			end
+		end
+	end
+
+	native_maze.solve()
+
+	-- Copy updated values and visited markers back to targets.
+	for i = 1, MAZE_CELLS do
+		local t <const> = cells[i]
+		if t then
+			local value <const>, flags <const> = native_maze.get(i - 1)
+			t.value = value
+			if flags & MAZE_VISITED ~= 0 then
+				t.maze_generation = global_frames
+			end
+			cells[i] = false
+		end
+	end
+	solution_path_0 = get_native_solution_path(0)
+	solution_path_f = get_native_solution_path(1)
+end
+
 -- Confirm that there are no solutions of length 1 or 2.
 local function no_trivial_solutions()
 	-- Check for solutions of length 1 (center cell is 0x0 or 0xf).
-	assert(target[cursor_x])
-	assert(target[cursor_x][cursor_y])
-	local center <const> = target[cursor_x][cursor_y]
+	local center <const> = get_target(cursor_x, cursor_y)
+	assert(center)
 	if center.value == 0 or center.value == all_ones then
 		debug_log(string.format("Bad center (%d,%d):%x", cursor_x, cursor_y, center.value))
 		return false
@@ -1298,9 +1566,8 @@ local function no_trivial_solutions()
 		assert(d)
 		local nx <const> = cursor_x + d[1]
 		local ny <const> = cursor_y + d[2]
-		assert(target[nx])
-		assert(target[nx][ny])
-		local neighbor <const> = target[nx][ny]
+		local neighbor <const> = get_target(nx, ny)
+		assert(neighbor)
 		if center.value == neighbor.value or
 		   (center.value ~ neighbor.value == all_ones) then
 			debug_log(string.format("Bad neighbor (%d,%d):%x -> (%d,%d):%x", cursor_x, cursor_y, center.value, nx, ny, neighbor.value))
@@ -1358,9 +1625,13 @@ local function init_chains()
 	-- Generate solutions from center.
 	solution_path_0 = nil
 	solution_path_f = nil
-	local path = table.create(MAX_CHAIN_LENGTH, 0)
-	path[1] = {cursor_x, cursor_y}
-	generate_solutions(path, 1, 0)
+	if use_native_maze then
+		generate_solutions_native()
+	else
+		solution_search_path[1][1] = cursor_x
+		solution_search_path[1][2] = cursor_y
+		generate_solutions(solution_search_path, 1, 0)
+	end
 	assert(solution_path_0)
 	assert(solution_path_f)
 	assert(no_trivial_solutions())
@@ -1377,7 +1648,8 @@ local function prepare_test_state()
 	cursor_y = 0
 	camera_x = 0
 	camera_y = 0
-	target = {}
+	target = nil
+	reset_targets()
 end
 
 -- Cleanup state after tests.
@@ -1394,7 +1666,51 @@ local function cleanup_test_state()
 	all_ones = nil
 end
 
+-- Check that a solution path starts at cursor, only moves between immediate
+-- neighbors without revisiting any target, and XORs to the expected value.
+-- Returns true if so.
+local function debug_check_solution(path, expected)
+	assert(type(path) == "table")
+	assert(type(expected) == "number")
+	assert(#path >= 1 and #path <= MAX_CHAIN_LENGTH)
+	assert(path[1][1] == cursor_x and path[1][2] == cursor_y)
+
+	local value = 0
+	local visited = {}
+	for i = 1, #path do
+		local x <const> = path[i][1]
+		local y <const> = path[i][2]
+		local key <const> = x .. "," .. y
+		assert(not visited[key])
+		visited[key] = true
+
+		if i > 1 then
+			local adjacent = false
+			for j = 0, 5 do
+				local d <const> = TARGET_OFFSET[j]
+				if path[i - 1][1] + d[1] == x and path[i - 1][2] + d[2] == y then
+					adjacent = true
+					break
+				end
+			end
+			assert(adjacent)
+		end
+
+		assert(get_target(x, y))
+		value = value ~ get_target(x, y).value
+	end
+	if value ~= expected then
+		debug_log(string.format("Bad solution: expected %x, got %x", expected, value))
+		return false
+	end
+	return true
+end
+
 -- Run init_chains repeatedly for testing.
+--
+-- If native extension is available, this alternates between native and
+-- Lua implementations of generate_solutions(), and checks that both produce
+-- valid solutions.
 local function debug_fuzz_init_chains()
 	if not playdate.isSimulator then
 		return true
@@ -1413,7 +1729,10 @@ local function debug_fuzz_init_chains()
 		end
 		for i = 1, 1000 do
 			-- Initialize grid.
+			use_native_maze = native_maze ~= nil and i % 2 == 0
 			init_chains()
+			assert(debug_check_solution(solution_path_0, 0))
+			assert(debug_check_solution(solution_path_f, all_ones))
 
 			-- Remove random targets from grid before next cycle.
 			for x = cursor_x - DRAW_HALF_WIDTH,
@@ -1423,23 +1742,21 @@ local function debug_fuzz_init_chains()
 					for y = cursor_y - DRAW_EVEN_HALF_HEIGHT,
 							  cursor_y + DRAW_EVEN_HALF_HEIGHT,
 							  TARGET_Y_SPACING do
-						if target[x] and target[x][y] and rand(4) == 1 then
-							target[x][y] = nil
+						if get_target(x, y) and rand(4) == 1 then
+							remove_target(x, y)
 						end
 					end
 				else
 					for y = cursor_y - DRAW_ODD_HALF_HEIGHT,
 							  cursor_y + DRAW_ODD_HALF_HEIGHT,
 							  TARGET_Y_SPACING do
-						if target[x] and target[x][y] and rand(4) == 1 then
-							target[x][y] = nil
+						if get_target(x, y) and rand(4) == 1 then
+							remove_target(x, y)
 						end
 					end
 				end
 			end
-			if target[cursor_x] then
-				target[cursor_x][cursor_y] = nil
-			end
+			remove_target(cursor_x, cursor_y)
 
 			-- Update global clock.  We can't run two generation cycles in the
 			-- same frame because we use the clock to mark which targets have
@@ -1448,6 +1765,7 @@ local function debug_fuzz_init_chains()
 		end
 	end
 
+	use_native_maze = ENABLE_NATIVE_MAZE and native_maze ~= nil
 	debug_log("debug_fuzz_init_chains done")
 	cleanup_test_state()
 	return true
@@ -1465,8 +1783,9 @@ local function update_xor_preview(length)
 	local last_position = nil
 	for i = 1, length do
 		last_position = current_chain[i]
-		assert(target[last_position[1]][last_position[2]])
-		last_value = target[last_position[1]][last_position[2]].value
+		local t <const> = get_target(last_position[1], last_position[2])
+		assert(t)
+		last_value = t.value
 		value = value ~ last_value
 	end
 
@@ -1538,7 +1857,9 @@ local function common_updates_for_game_loop()
 
 	-- Initialize grid.
 	if not solution_path_0 then
+		assert(debug_stats.timer("init_chains", true))
 		init_chains()
+		assert(debug_stats.timer("init_chains", false))
 		update_xor_preview(1)
 
 		-- First 6 rows contain:
@@ -1563,23 +1884,41 @@ local function common_updates_for_game_loop()
 
 	-- Draw hints with flashing lines.
 	if hint_mode == HINTS_VISIBLE or (hint_mode == HINTS_DELAYED and global_frames - last_action_timestamp > 90) then
+		assert(debug_stats.timer("draw_solution_path", true))
 		local f <const> = global_frames % 3
 		if f == 0 then
 			draw_solution_path(solution_path_0)
 		elseif f == 1 then
 			draw_solution_path(solution_path_f)
 		end
+		assert(debug_stats.timer("draw_solution_path", false))
 	end
 
 	-- Draw everything.
+	assert(debug_stats.timer("draw_starfield", true))
 	draw_starfield()
+	assert(debug_stats.timer("draw_starfield", false))
+	assert(debug_stats.timer("draw_lines_connecting_selection", true))
 	draw_lines_connecting_selection()
+	assert(debug_stats.timer("draw_lines_connecting_selection", false))
+	assert(debug_stats.timer("draw_target", true))
 	draw_visible_targets(draw_target)
+	assert(debug_stats.timer("draw_target", false))
+	assert(debug_stats.timer("draw_birthmark", true))
 	draw_visible_targets(draw_birthmark)
+	assert(debug_stats.timer("draw_birthmark", false))
+	assert(debug_stats.timer("draw_next_target", true))
 	draw_next_target()
+	assert(debug_stats.timer("draw_next_target", false))
+	assert(debug_stats.timer("draw_xor_result", true))
 	draw_xor_result()
+	assert(debug_stats.timer("draw_xor_result", false))
+	assert(debug_stats.timer("draw_score", true))
 	draw_score()
+	assert(debug_stats.timer("draw_score", false))
+	assert(debug_stats.timer("draw_time_remaining", true))
 	draw_time_remaining()
+	assert(debug_stats.timer("draw_time_remaining", false))
 end
 
 -- Draw title text characters.
@@ -1726,7 +2065,7 @@ local function common_updates_for_game_over(high_score)
 	-- handling inputs for a bit.
 	if global_frames < 15 then
 		assert(debug_frame_rate())
-		assert(debug_periodic_log())
+		assert(debug_stats.periodic_log())
 		return
 	end
 
@@ -1739,7 +2078,7 @@ local function common_updates_for_game_over(high_score)
 	end
 
 	assert(debug_frame_rate())
-	assert(debug_periodic_log())
+	assert(debug_stats.periodic_log())
 end
 
 -- Syntactic sugar to adjust volume on all channels.
@@ -1780,7 +2119,10 @@ local function play_note()
 	-- This is so that different notes will be played on different channels,
 	-- while same notes will stop earlier playing notes.
 	assert(n <= #celesta)
-	celesta[n]:play(1, RATE_MULTIPLIER[NOTE_GROUPS[note_group_index][n] + 1])
+	assert(debug_stats.timer("play_note", true))
+	celesta[n]:setSample(note_sample[NOTE_GROUPS[note_group_index][n]])
+	celesta[n]:play(1)
+	assert(debug_stats.timer("play_note", false))
 	last_note_index = n
 end
 
@@ -1800,7 +2142,8 @@ local function check_completed_chain(length)
 	local group_size <const> = #NOTE_GROUPS[note_group_index]
 	assert(group_size <= #celesta)
 	for n = 1, group_size do
-		celesta[n]:play(1, RATE_MULTIPLIER[NOTE_GROUPS[note_group_index][n] + 1])
+		celesta[n]:setSample(note_sample[NOTE_GROUPS[note_group_index][n]])
+		celesta[n]:play(1)
 	end
 
 	-- Advance group index.
@@ -1841,24 +2184,24 @@ local function check_completed_chain(length)
 	for i = 1, length do
 		local x <const> = current_chain[i][1]
 		local y <const> = current_chain[i][2]
-		assert(target[x])
-		assert(target[x][y])
-		if target[x][y].value == 0 and target[x][y].variation <= 4 then
-			assert(target[x][y].variation == 3 or target[x][y].variation == 4)
-			if target[x][y].variation == 3 then
+		local t <const> = get_target(x, y)
+		assert(t)
+		if t.value == 0 and t.variation <= 4 then
+			assert(t.variation == 3 or t.variation == 4)
+			if t.variation == 3 then
 				bocchi = 3
 			else
 				kita = 3
 			end
 		end
-		target[x][y] = nil
-		assert(debug_count("remove_cell"))
+		remove_target(x, y)
+		assert(debug_stats.count("remove_cell"))
 	end
 
 	-- Update chain counter.
 	completed_chain_count += 1
-	assert(debug_count("completed_chain"))
-	assert(debug_count(string.format("z%02d", length)))
+	assert(debug_stats.count("completed_chain"))
+	assert(debug_stats.count(string.format("z%02d", length)))
 
 	-- Maximum change in score in a single step:
 	--
@@ -1900,7 +2243,8 @@ end
 -- we can often complete chains out of pure luck.  In 8 bit modes we usually
 -- not so lucky, but it's still fun to watch as a screensaver.  The "follow
 -- hint" modes work equally well in 4 bit and 8 bit modes, and it's also used
--- to implement attract mode.
+-- to implement attract mode.  AUTOPLAY_SOLVE searches for high scoring
+-- chains instead of following hints, see autoplay_solve().
 local function handle_autoplay()
 	-- Check if any button was just pressed.  In steady state when no buttons
 	-- are pressed, we don't change autoplay_level.
@@ -1932,8 +2276,8 @@ local function handle_autoplay()
 			autoplay_mode = AUTOPLAY_FOLLOW_HINT_ZERO
 			assert(debug_log("autoplay enabled: AUTOPLAY_FOLLOW_HINT_ZERO"))
 		elseif playdate.buttonJustPressed(playdate.kButtonLeft) then
-			autoplay_mode = AUTOPLAY_FOLLOW_HINT_LONG
-			assert(debug_log("autoplay enabled: AUTOPLAY_FOLLOW_HINT_LONG"))
+			autoplay_mode = AUTOPLAY_SOLVE
+			assert(debug_log("autoplay enabled: AUTOPLAY_SOLVE"))
 		elseif playdate.buttonJustPressed(playdate.kButtonRight) then
 			autoplay_mode = AUTOPLAY_FOLLOW_HINT_ANY
 			assert(debug_log("autoplay enabled: AUTOPLAY_FOLLOW_HINT_ANY"))
@@ -2000,6 +2344,257 @@ local function autoplay_follow_hint(hint)
 	return nil
 end
 
+-- State for AUTOPLAY_SOLVE, see autoplay_solve().  This is kept in a single
+-- table since we are close to the limit of 200 local variables.
+--
+-- Search stack is stored as parallel arrays indexed by chain length, all
+-- preallocated so that search steps don't produce garbage:
+--    x, y = target coordinates.
+--    value = XOR of all values up to this target.
+--    bonus = bit 0 set if chain contains Bocchi, bit 1 set for Kita.
+--    direction = next direction to try from this target [0..6].
+--
+-- Other fields:
+--    depth = current search depth.
+--    limit = depth limit for current iteration.
+--    seen = maps state key to the generation when it was last visited.
+--       This table is allocated once and reused by all searches, so that
+--       starting a new search doesn't produce garbage.
+--    generation = incremented for each iteration of each search, so that
+--       entries from earlier iterations are treated as unvisited.
+--    seen_count = number of entries written to seen by current search,
+--       capped at SOLVER_MAX_SEEN.
+--    seen_size = number of keys in seen across all searches.  Table is
+--       emptied in place at the start of a search when this gets too big.
+--    done = true if search is complete.
+--    start_frame = global_frames when search started.
+--    best_path, best_score = best chain found so far and its score.
+--    origin = solution_path_0 at the time search was started.  A different
+--       value means init_chains has generated a new grid, and the search
+--       needs to start over.
+local solver <const> =
+{
+	x = table.create(MAX_CHAIN_LENGTH, 0),
+	y = table.create(MAX_CHAIN_LENGTH, 0),
+	value = table.create(MAX_CHAIN_LENGTH, 0),
+	bonus = table.create(MAX_CHAIN_LENGTH, 0),
+	direction = table.create(MAX_CHAIN_LENGTH, 0),
+	seen = {},
+	generation = 0,
+	seen_count = 0,
+	seen_size = 0,
+}
+assert(SOLVER_MAX_FRAMES < FAST_THINK_THRESHOLD)
+
+-- Compute score for completing a chain, same as check_completed_chain.
+local function solver_score(length, value, bonus)
+	assert(length >= 3)
+	assert(value == 0 or value == all_ones)
+
+	local multiplier = 1
+	if value == last_completed_xor_result then
+		multiplier = min(score_multiplier + 1, 4)
+	end
+	if bonus & 1 ~= 0 then
+		multiplier *= 3
+	end
+	if bonus & 2 ~= 0 then
+		multiplier *= 3
+	end
+	return (1 << (length - 3)) * multiplier
+end
+
+-- Start a new search from current cursor position.
+local function solver_start()
+	assert(#current_chain == 1)
+	assert(solution_path_0)
+	assert(solution_path_f)
+
+	solver.origin = solution_path_0
+	solver.start_frame = global_frames
+	solver.done = false
+	solver.generation += 1
+	solver.seen_count = 0
+	if solver.seen_size > SOLVER_MAX_SEEN * 4 then
+		local seen <const> = solver.seen
+		for key in pairs(seen) do
+			seen[key] = nil
+		end
+		solver.seen_size = 0
+	end
+
+	-- Seed best chain with whichever solution hint scores higher, so that
+	-- we always have something to follow even if search is cut short.
+	solver.best_path = nil
+	solver.best_score = 0
+	for i = 1, 2 do
+		local path <const> = i == 1 and solution_path_0 or solution_path_f
+		local value = 0
+		local bonus = 0
+		for j = 1, #path do
+			local t <const> = get_target(path[j][1], path[j][2])
+			assert(t)
+			value = value ~ t.value
+			if t.value == 0 and (t.variation == 3 or t.variation == 4) then
+				bonus = bonus | (t.variation - 2)
+			end
+		end
+		local score <const> = solver_score(#path, value, bonus)
+		if score > solver.best_score then
+			solver.best_path = path
+			solver.best_score = score
+		end
+	end
+
+	local t <const> = get_target(cursor_x, cursor_y)
+	assert(t)
+	solver.x[1] = cursor_x
+	solver.y[1] = cursor_y
+	solver.value[1] = t.value
+	solver.bonus[1] = 0
+	if t.value == 0 and (t.variation == 3 or t.variation == 4) then
+		solver.bonus[1] = t.variation - 2
+	end
+	solver.direction[1] = 0
+	solver.depth = 1
+	solver.limit = 3
+end
+
+-- Search for the highest scoring chain starting from cursor, spending at
+-- most SOLVER_FRAME_BUDGET milliseconds per call.  Search state persists
+-- across calls, so the search is spread across multiple frames.
+--
+-- This is an iterative deepening depth-first search over existing targets,
+-- with the depth limit starting at 3 and going up to MAX_CHAIN_LENGTH.
+-- Score grows exponentially with chain length, so each iteration tends to
+-- find better chains than the previous one, and we always have a usable
+-- answer when we run out of time.
+--
+-- Search doesn't expand beyond a target that completes a chain, since the
+-- chain would be completed the moment we visit that target.  Targets that
+-- have not been initialized are also not expanded, which bounds the search
+-- to the area around the visible screen.
+--
+-- Within one iteration, search states are deduplicated with a table keyed
+-- on (target, XOR, length, bonus).  This treats two paths reaching the
+-- same state as equivalent even though they might have used different
+-- targets along the way, so it's possible to miss some chains, but it
+-- cuts down the search space enough to finish in a reasonable number of
+-- frames.
+local function autoplay_solve()
+	if solver.origin ~= solution_path_0 then
+		if #current_chain ~= 1 then
+			return
+		end
+		solver_start()
+	end
+
+	-- Stop searching once we started following a chain, otherwise we might
+	-- find a better chain halfway and have to backtrack.
+	if solver.done or #current_chain > 1 then
+		return
+	end
+
+	-- Reading the clock is not free, so we only check it once every few
+	-- search steps.
+	local deadline <const> = playdate.getCurrentTimeMilliseconds() + SOLVER_FRAME_BUDGET
+	local steps = 0
+	while true do
+		steps += 1
+		if steps % 32 == 0 and playdate.getCurrentTimeMilliseconds() >= deadline then
+			return
+		end
+
+		local depth <const> = solver.depth
+		local direction <const> = solver.direction[depth]
+		if direction > 5 or depth >= solver.limit then
+			-- Done with current target.
+			if depth > 1 then
+				solver.depth = depth - 1
+			elseif solver.limit < MAX_CHAIN_LENGTH then
+				-- Start next iteration with a deeper limit.
+				solver.limit += 1
+				solver.generation += 1
+				solver.direction[1] = 0
+			else
+				assert(debug_log(string.format("solver: score=%d, length=%d, frames=%d", solver.best_score, #solver.best_path, global_frames - solver.start_frame)))
+				solver.done = true
+				return
+			end
+
+		else
+			solver.direction[depth] = direction + 1
+			local x <const> = solver.x[depth] + TARGET_OFFSET[direction][1]
+			local y <const> = solver.y[depth] + TARGET_OFFSET[direction][2]
+			local t <const> = get_target(x, y)
+			local available = t and t.selected == TARGET_UNSELECTED
+			if available then
+				for i = 2, depth do
+					if solver.x[i] == x and solver.y[i] == y then
+						available = false
+						break
+					end
+				end
+			end
+			if available then
+				local value <const> = solver.value[depth] ~ t.value
+				local bonus = solver.bonus[depth]
+				if t.value == 0 and (t.variation == 3 or t.variation == 4) then
+					bonus = bonus | (t.variation - 2)
+				end
+				local length <const> = depth + 1
+				if value == 0 or value == all_ones then
+					-- Found a complete chain.
+					if length >= 3 then
+						local score <const> = solver_score(length, value, bonus)
+						if score > solver.best_score then
+							local path = table.create(length, 0)
+							for i = 1, depth do
+								path[i] = {solver.x[i], solver.y[i]}
+							end
+							path[length] = {x, y}
+							solver.best_path = path
+							solver.best_score = score
+						end
+					end
+				else
+					local key <const> = ((target_index(x, y) * 256 + value) * 32 + length) * 4 + bonus
+					local seen <const> = solver.seen
+					if seen[key] ~= solver.generation then
+						if solver.seen_count < SOLVER_MAX_SEEN then
+							if not seen[key] then
+								solver.seen_size += 1
+							end
+							seen[key] = solver.generation
+							solver.seen_count += 1
+						end
+						solver.x[length] = x
+						solver.y[length] = y
+						solver.value[length] = value
+						solver.bonus[length] = bonus
+						solver.direction[length] = 0
+						solver.depth = length
+					end
+				end
+			end
+		end
+	end
+end
+
+-- Check if autoplay should follow solver.best_path, or keep waiting.
+local function autoplay_solver_ready()
+	if solver.origin ~= solution_path_0 then
+		-- Solver didn't start because autoplay was enabled in the middle
+		-- of a chain.  Follow the longer hint for this chain instead.
+		assert(#current_chain > 1)
+		solver.best_path = #solution_path_0 >= #solution_path_f and solution_path_0 or solution_path_f
+		return true
+	end
+	return solver.done or
+	       #current_chain > 1 or
+	       global_frames - solver.start_frame >= SOLVER_MAX_FRAMES
+end
+
 -- Decide which direction to turn.  Updates next_target_direction.
 local function autoplay_turn()
 	local preferred_direction = nil
@@ -2010,20 +2605,11 @@ local function autoplay_turn()
 	elseif autoplay_mode == AUTOPLAY_FOLLOW_HINT_ONE then
 		preferred_direction = autoplay_follow_hint(solution_path_f)
 
-	elseif autoplay_mode == AUTOPLAY_FOLLOW_HINT_LONG then
-		if #solution_path_0 > #solution_path_f then
-			preferred_direction = autoplay_follow_hint(solution_path_0)
-		elseif #solution_path_0 < #solution_path_f then
-			preferred_direction = autoplay_follow_hint(solution_path_f)
-		else
-			assert(#solution_path_0 == #solution_path_f)
-			-- Since both solution paths are of equal length, prefer the same
-			-- type that we followed last time to increase score_multiplier.
-			if last_completed_xor_result == 0 then
-				preferred_direction = autoplay_follow_hint(solution_path_0)
-			else
-				preferred_direction = autoplay_follow_hint(solution_path_f)
-			end
+	elseif autoplay_mode == AUTOPLAY_SOLVE then
+		-- Don't turn until solver is done, since we don't know which way
+		-- to go yet.
+		if autoplay_solver_ready() then
+			preferred_direction = autoplay_follow_hint(solver.best_path)
 		end
 
 	elseif autoplay_mode == AUTOPLAY_FOLLOW_HINT_ANY then
@@ -2077,27 +2663,14 @@ local function autoplay_move()
 			return true, false
 		end
 
-	elseif autoplay_mode == AUTOPLAY_FOLLOW_HINT_LONG then
-		-- Advance if we are currently along the preferred path, otherwise undo.
-		if #solution_path_0 > #solution_path_f then
-			if autoplay_follow_hint(solution_path_0) then
-				return true, false
-			end
-		elseif #solution_path_0 < #solution_path_f then
-			if autoplay_follow_hint(solution_path_f) then
-				return true, false
-			end
-		else
-			assert(#solution_path_0 == #solution_path_f)
-			if last_completed_xor_result == 0 then
-				if autoplay_follow_hint(solution_path_0) then
-					return true, false
-				end
-			else
-				if autoplay_follow_hint(solution_path_f) then
-					return true, false
-				end
-			end
+	elseif autoplay_mode == AUTOPLAY_SOLVE then
+		-- Wait for solver, then advance if we are currently along the best
+		-- path, otherwise undo.
+		if not autoplay_solver_ready() then
+			return false, false
+		end
+		if autoplay_follow_hint(solver.best_path) then
+			return true, false
 		end
 
 	elseif autoplay_mode == AUTOPLAY_FOLLOW_HINT_ANY then
@@ -2172,7 +2745,9 @@ local function commit_input(last_target_direction, advance_action, undo_action)
 			cursor_x = next_x
 			cursor_y = next_y
 
+			assert(debug_stats.timer("check_completed_chain", true))
 			check_completed_chain(chain_length + 1)
+			assert(debug_stats.timer("check_completed_chain", false))
 			last_action_timestamp = global_frames
 
 			-- Stop processing further input since we have already modified
@@ -2251,6 +2826,11 @@ local function handle_input()
 	if handle_autoplay() then
 		-- Game is under auto control.
 
+		-- Run solver on every frame, independent of action period.
+		if autoplay_mode == AUTOPLAY_SOLVE then
+			autoplay_solve()
+		end
+
 		-- Perform action once every few frames.
 		if (global_frames % AUTOPLAY_ACTION_PERIOD) ~= 0 then
 			return
@@ -2345,7 +2925,7 @@ local function demo_input()
 
 	-- Decide on which direction to turn.  We will deterministically choose
 	-- whichever path is shorter, breaking ties by choosing solution_path_0.
-	-- This is roughly the opposite of AUTOPLAY_FOLLOW_HINT_LONG.
+	-- This is roughly the opposite of AUTOPLAY_SOLVE.
 	local preferred_direction = nil
 	if #solution_path_0 <= #solution_path_f then
 		preferred_direction = autoplay_follow_hint(solution_path_0)
@@ -2493,7 +3073,8 @@ local function song_test()
 					song_test_last_note_detail = song_test_last_note_detail .. note
 				end
 			end
-			celesta[last_note_index]:play(1, RATE_MULTIPLIER[NOTE_GROUPS[note_group_index][last_note_index] + 1])
+			celesta[last_note_index]:setSample(note_sample[NOTE_GROUPS[note_group_index][last_note_index]])
+			celesta[last_note_index]:play(1)
 
 		elseif last_note_index == 1 then
 			-- Play chord.
@@ -2501,7 +3082,8 @@ local function song_test()
 			song_test_last_note_detail = "Chord = "
 			for n = 1, #NOTE_GROUPS[note_group_index] do
 				local note <const> = NOTE_GROUPS[note_group_index][n]
-				celesta[n]:play(1, RATE_MULTIPLIER[note + 1])
+				celesta[n]:setSample(note_sample[note])
+				celesta[n]:play(1)
 				if n > 1 then
 					song_test_last_note_detail = song_test_last_note_detail .. ", "
 				end
@@ -2612,6 +3194,34 @@ local function debug_export()
 		playdate.update = song_test
 	end
 
+	-- dump_timers: print debug_stats.timer() statistics as CSV.
+	dump_timers = function()
+		print("name,samples,p50_us,p99_us,max_us,min_bytes,mean_bytes,max_bytes")
+		local names = {}
+		for name in pairs(debug_stats.timers or {}) do
+			table.insert(names, name)
+		end
+		table.sort(names)
+		for i = 1, #names do
+			local t <const> = debug_stats.timers[names[i]]
+			local elapsed = {}
+			local memory_total = 0
+			local memory_min = nil
+			local memory_max = nil
+			for j = 1, #t.elapsed do
+				elapsed[j] = t.elapsed[j]
+				memory_total += t.memory[j]
+				memory_min = min(memory_min or t.memory[j], t.memory[j])
+				memory_max = max(memory_max or t.memory[j], t.memory[j])
+			end
+			local n <const> = #elapsed
+			if n > 0 then
+				table.sort(elapsed)
+				print(string.format("%s,%d,%d,%d,%d,%d,%d,%d", names[i], n, elapsed[n // 2 + 1], elapsed[(n * 99) // 100 + 1], elapsed[n], memory_min, memory_total // n, memory_max))
+			end
+		end
+	end
+
 	-- sprite_test: generate sprite variations.
 	sprite_test = function()
 		set_next_game_state(game_loop)
@@ -2697,7 +3307,7 @@ game_title = function()
 	end
 
 	assert(debug_frame_rate())
-	assert(debug_periodic_log())
+	assert(debug_stats.periodic_log())
 end
 
 -- Edit high scores.
@@ -2769,7 +3379,7 @@ game_edit_score = function()
 	end
 
 	assert(debug_frame_rate())
-	assert(debug_periodic_log())
+	assert(debug_stats.periodic_log())
 end
 
 -- Main game loop.
@@ -2777,7 +3387,9 @@ game_loop = function()
 	common_updates_for_game_loop()
 
 	-- Update clocks.
+	assert(debug_stats.timer("update_game_time", true))
 	update_game_time()
+	assert(debug_stats.timer("update_game_time", false))
 
 	-- Check for endgame.
 	if thinking_time >= ENDGAME_HARD_LIMIT then
@@ -2798,10 +3410,12 @@ game_loop = function()
 	-- Handle player input.  This is done at the end of the update cycle
 	-- since player input will modify state, which may cause some of the
 	-- earlier draw functions to access outdated data.
+	assert(debug_stats.timer("input", true))
 	handle_input()
+	assert(debug_stats.timer("input", false))
 
 	assert(debug_frame_rate())
-	assert(debug_periodic_log())
+	assert(debug_stats.periodic_log())
 end
 
 -- Attract mode.
@@ -2831,7 +3445,7 @@ game_demo = function()
 	demo_input()
 
 	assert(debug_frame_rate())
-	assert(debug_periodic_log())
+	assert(debug_stats.periodic_log())
 end
 
 -- Endgame.